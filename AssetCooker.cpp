@@ -0,0 +1,826 @@
+
+#include "AssetCooker.h"
+
+#include "AssetPackWriter.h"
+#include "HDRImage.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+#include "stb_image.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <sys/stat.h>
+#endif
+
+//==============================================================================
+
+const uint32_t AssetCooker::VERSION;
+
+//==============================================================================
+
+uint64_t AssetCooker::Hash(const void *data, size_t size, uint64_t hash) noexcept
+{
+	// 64 bit FNV-1a
+	const auto bytes = static_cast<const unsigned char *>(data);
+	for (size_t i = 0; i < size; i++)
+	{
+		hash = (hash ^ bytes[i]) * 1099511628211ull;
+	}
+
+	return hash;
+}
+
+//==============================================================================
+
+bool AssetCooker::ReadFile(const std::string &name, std::string &content) noexcept
+{
+	std::ifstream file(GetNativePath(name), std::ios::binary | std::ios::ate);
+	if (!file)
+	{
+		return false;
+	}
+
+	content.resize(static_cast<size_t>(file.tellg()));
+	file.seekg(0);
+	file.read(&content[0], content.size());
+
+	return !file.fail();
+}
+
+//==============================================================================
+
+std::string AssetCooker::GetNativePath(const std::string &name) noexcept
+{
+	// asset names use backslashes, as the runtime loads them
+#ifdef _WIN32
+	return name;
+#else
+	auto path = name;
+	std::replace(path.begin(), path.end(), '\\', '/');
+	return path;
+#endif
+}
+
+//==============================================================================
+
+std::string AssetCooker::GetExtension(const std::string &name) noexcept
+{
+	const auto dot = name.find_last_of('.');
+	if (dot == std::string::npos || name.find_first_of("\\/", dot) != std::string::npos)
+	{
+		return std::string();
+	}
+
+	auto extension = name.substr(dot + 1);
+	std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+	return extension;
+}
+
+//==============================================================================
+
+void AssetCooker::Scan(const std::string &directory) noexcept
+{
+#ifdef _WIN32
+	WIN32_FIND_DATAA data;
+	const auto handle = FindFirstFileA((directory + "\\*").c_str(), &data);
+	if (handle == INVALID_HANDLE_VALUE)
+	{
+		return;
+	}
+
+	do
+	{
+		const std::string name = data.cFileName;
+		if (name == "." || name == "..")
+		{
+			continue;
+		}
+
+		if (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+		{
+			Scan(directory + "\\" + name);
+		}
+		else
+		{
+			sources.push_back(directory + "\\" + name);
+		}
+	}
+	while (FindNextFileA(handle, &data));
+
+	FindClose(handle);
+#else
+	const auto handle = opendir(GetNativePath(directory).c_str());
+	if (!handle)
+	{
+		return;
+	}
+
+	while (const auto entry = readdir(handle))
+	{
+		const std::string name = entry->d_name;
+		if (name == "." || name == "..")
+		{
+			continue;
+		}
+
+		struct stat info;
+		if (stat(GetNativePath(directory + "\\" + name).c_str(), &info) != 0)
+		{
+			continue;
+		}
+
+		if (S_ISDIR(info.st_mode))
+		{
+			Scan(directory + "\\" + name);
+		}
+		else
+		{
+			sources.push_back(directory + "\\" + name);
+		}
+	}
+
+	closedir(handle);
+#endif
+}
+
+//==============================================================================
+
+void AssetCooker::HashSources(size_t first, size_t last, std::vector<uint64_t> *result) noexcept
+{
+	std::string content;
+	for (auto i = first; i < last; i++)
+	{
+		(*result)[i] = ReadFile(sources[i], content) ? Hash(content.data(), content.size()) : 0;
+	}
+}
+
+//==============================================================================
+
+uint64_t AssetCooker::GetKey(AssetPack::Type type, const std::vector<std::string> &dependencies) const noexcept
+{
+	// the cooker version, the settings the type is cooked with, then every source
+	auto key = Hash(&VERSION, sizeof(VERSION));
+	key = Hash(&type, sizeof(type), key);
+
+	if (type == AssetPack::Type::TEXTURE)
+	{
+		key = Hash(&settings.mipmaps,  sizeof(settings.mipmaps),  key);
+		key = Hash(&settings.compress, sizeof(settings.compress), key);
+	}
+	else
+	if (type == AssetPack::Type::SHADER)
+	{
+		key = Hash(&settings.strip, sizeof(settings.strip), key);
+	}
+
+	std::string content;
+	for (auto &dependency : dependencies)
+	{
+		// includes from outside the scanned directories are hashed on demand
+		const auto it = hashes.find(dependency);
+		const auto hash = it != hashes.end() ? it->second : ReadFile(dependency, content) ? Hash(content.data(), content.size()) : 0;
+
+		key = Hash(dependency.c_str(), dependency.size() + 1, key);
+		key = Hash(&hash, sizeof(hash), key);
+	}
+
+	return key;
+}
+
+//==============================================================================
+
+void AssetCooker::ReadManifest(const std::string &path) noexcept
+{
+	manifest.clear();
+
+	std::ifstream file(path);
+	if (!file)
+	{
+		return;
+	}
+
+	// one asset per line: key, name, then its dependencies, separated by tabs
+	std::string line;
+	while (std::getline(file, line))
+	{
+		std::vector<std::string> fields;
+		std::istringstream stream(line);
+		for (std::string field; std::getline(stream, field, '\t');)
+		{
+			fields.push_back(field);
+		}
+
+		if (fields.size() < 3)
+		{
+			continue;
+		}
+
+		auto &record = manifest[fields[1]];
+		record.key = std::strtoull(fields[0].c_str(), nullptr, 16);
+		record.dependencies.assign(fields.begin() + 2, fields.end());
+	}
+}
+
+//==============================================================================
+
+bool AssetCooker::WriteManifest(const std::string &path) const noexcept
+{
+	std::ofstream file(path, std::ios::trunc);
+	if (!file)
+	{
+		std::cout << "error: manifest " << path << " cannot be written" << std::endl;
+		return false;
+	}
+
+	// failed assets are left out, so the next run tries them again
+	for (auto &asset : assets)
+	{
+		if (asset.failed)
+		{
+			continue;
+		}
+
+		char key[17];
+		std::snprintf(key, sizeof(key), "%016llx", static_cast<unsigned long long>(asset.key));
+
+		file << key << '\t' << asset.name;
+		for (auto &dependency : asset.dependencies)
+		{
+			file << '\t' << dependency;
+		}
+		file << '\n';
+	}
+
+	return static_cast<bool>(file);
+}
+
+//==============================================================================
+
+void AssetCooker::Work() noexcept
+{
+	// runs on the worker threads, assets are handed out one at a time
+	for (auto index = next++; index < pending.size(); index = next++)
+	{
+		auto &asset = assets[pending[index]];
+
+		auto cooked = false;
+		switch (asset.type)
+		{
+		case AssetPack::Type::TEXTURE:     cooked = CookTexture(asset);    break;
+		case AssetPack::Type::HDR_TEXTURE: cooked = CookHDRTexture(asset); break;
+		case AssetPack::Type::SHADER:      cooked = CookShader(asset);     break;
+		}
+
+		asset.key    = GetKey(asset.type, asset.dependencies);
+		asset.cooked = cooked;
+		asset.failed = !cooked;
+	}
+}
+
+//==============================================================================
+
+bool AssetCooker::CookTexture(Asset &asset) const noexcept
+{
+	asset.dependencies.assign(1, asset.name);
+
+	int width;
+	int height;
+	int components;
+
+	// flipped like Texture::Load, the flag is per thread
+	stbi_set_flip_vertically_on_load_thread(true);
+	const auto data = stbi_load(GetNativePath(asset.name).c_str(), &width, &height, &components, 0);
+	if (!data)
+	{
+		std::cout << "error: texture " << asset.name << " cannot be decoded" << std::endl;
+		return false;
+	}
+
+	const auto texels = static_cast<size_t>(width) * height;
+
+	// the statistics Texture::Init computes from the source, and whether
+	// the texels need every channel the file has
+	auto low  = data[0];
+	auto high = data[0];
+	double sum[3] = { 0.0, 0.0, 0.0 };
+
+	auto grey   = true;
+	auto opaque = true;
+
+	for (size_t i = 0; i < texels; i++)
+	{
+		const auto texel = &data[i * components];
+		low  = std::min(low,  texel[0]);
+		high = std::max(high, texel[0]);
+
+		for (int c = 0; c < 3; c++)
+		{
+			sum[c] += texel[components < 3 ? 0 : c];
+		}
+
+		grey   = grey   && (components < 3 || (texel[0] == texel[1] && texel[0] == texel[2]));
+		opaque = opaque && (components % 2 == 1 || texel[components - 1] == 255);
+	}
+
+	auto &entry = asset.entry;
+	entry.range[0] = low  / 255.0f;
+	entry.range[1] = high / 255.0f;
+	for (int c = 0; c < 3; c++)
+	{
+		entry.average[c] = static_cast<float>(sum[c] / (255.0 * texels));
+	}
+
+	// grey maps keep one channel, which the loader swizzles back to grey
+	const auto channels = grey && opaque ? 1 : opaque ? 3 : 4;
+
+	std::vector<unsigned char> level(texels * channels);
+	for (size_t i = 0; i < texels; i++)
+	{
+		const auto texel = &data[i * components];
+		for (int c = 0; c < channels; c++)
+		{
+			const auto source = c == 3 ? components - 1 : components < 3 ? 0 : c;
+			level[i * channels + c] = texel[source];
+		}
+	}
+
+	stbi_image_free(data);
+
+	const auto compress = channels == 1 && settings.compress;
+
+	entry.type   = AssetPack::Type::TEXTURE;
+	entry.format = compress ? AssetPack::Format::RGTC1 : channels == 1 ? AssetPack::Format::R8 : channels == 3 ? AssetPack::Format::RGB8 : AssetPack::Format::RGBA8;
+	entry.width  = width;
+	entry.height = height;
+	entry.mips   = 1;
+
+	if (settings.mipmaps)
+	{
+		for (auto size = std::max(width, height); size > 1; size /= 2)
+		{
+			entry.mips++;
+		}
+	}
+
+	std::vector<unsigned char> next_level;
+	for (unsigned int mip = 0; mip < entry.mips; mip++)
+	{
+		const auto w = std::max(width  >> mip, 1);
+		const auto h = std::max(height >> mip, 1);
+
+		const auto offset = asset.payload.size();
+		asset.payload.resize(offset + AssetPack::GetLevelSize(entry.format, w, h));
+
+		if (compress)
+		{
+			CompressRGTC1(level.data(), w, h, &asset.payload[offset]);
+		}
+		else
+		{
+			std::copy(level.begin(), level.end(), asset.payload.begin() + offset);
+		}
+
+		if (mip + 1 < entry.mips)
+		{
+			next_level.resize(static_cast<size_t>(std::max(w / 2, 1)) * std::max(h / 2, 1) * channels);
+			Downsample(level.data(), w, h, channels, next_level.data());
+			level.swap(next_level);
+		}
+	}
+
+	return true;
+}
+
+//==============================================================================
+
+bool AssetCooker::CookHDRTexture(Asset &asset) const noexcept
+{
+	asset.dependencies.assign(1, asset.name);
+
+	// decoded to bottom to top half floats, as Environment uploads them
+	HDRImage image;
+	if (!image.Load(GetNativePath(asset.name)))
+	{
+		return false;
+	}
+
+	auto &entry = asset.entry;
+	entry.type   = AssetPack::Type::HDR_TEXTURE;
+	entry.format = AssetPack::Format::RGB16F;
+	entry.width  = image.GetWidth();
+	entry.height = image.GetHeight();
+	entry.mips   = 1;
+
+	entry.range[0] = 0.0f;
+	entry.range[1] = 1.0f;
+	entry.average[0] = entry.average[1] = entry.average[2] = 0.5f;
+
+	const auto pixels = reinterpret_cast<const unsigned char *>(image.GetPixels());
+	asset.payload.assign(pixels, pixels + AssetPack::GetLevelSize(entry.format, entry.width, entry.height));
+
+	return true;
+}
+
+//==============================================================================
+
+bool AssetCooker::CookShader(Asset &asset) const noexcept
+{
+	asset.dependencies.clear();
+
+	std::string code;
+	if (!Preprocess(asset.name, code, asset.dependencies, 0))
+	{
+		return false;
+	}
+
+	asset.entry.type   = AssetPack::Type::SHADER;
+	asset.entry.format = AssetPack::Format::TEXT;
+	asset.payload.assign(code.begin(), code.end());
+
+	return true;
+}
+
+//==============================================================================
+
+bool AssetCooker::Preprocess(const std::string &name, std::string &code, std::vector<std::string> &dependencies, unsigned int depth) const noexcept
+{
+	if (depth > 16)
+	{
+		std::cout << "error: shader " << name << " is included recursively" << std::endl;
+		return false;
+	}
+
+	std::string source;
+	if (!ReadFile(name, source))
+	{
+		std::cout << "error: shader " << name << " is not found" << std::endl;
+		return false;
+	}
+
+	if (std::find(dependencies.begin(), dependencies.end(), name) == dependencies.end())
+	{
+		dependencies.push_back(name);
+	}
+
+	// includes are relative to the including file
+	const auto directory = name.substr(0, name.find_last_of("\\/") + 1);
+
+	std::istringstream lines(source);
+	std::string line;
+	auto comment = false;
+
+	while (std::getline(lines, line))
+	{
+		if (!line.empty() && line.back() == '\r')
+		{
+			line.pop_back();
+		}
+
+		if (settings.strip)
+		{
+			StripComments(line, comment);
+
+			if (line.find_first_not_of(" \t") == std::string::npos)
+			{
+				continue;
+			}
+		}
+
+		const auto start = line.find_first_not_of(" \t");
+		if (start != std::string::npos && line.compare(start, 8, "#include") == 0)
+		{
+			const auto open  = line.find('"', start);
+			const auto close = open == std::string::npos ? open : line.find('"', open + 1);
+			if (close == std::string::npos)
+			{
+				std::cout << "error: shader " << name << " has a malformed #include" << std::endl;
+				return false;
+			}
+
+			auto include = directory + line.substr(open + 1, close - open - 1);
+			std::replace(include.begin(), include.end(), '/', '\\');
+
+			if (!Preprocess(include, code, dependencies, depth + 1))
+			{
+				return false;
+			}
+			continue;
+		}
+
+		code += line;
+		code += '\n';
+	}
+
+	return true;
+}
+
+//==============================================================================
+
+void AssetCooker::StripComments(std::string &line, bool &comment) noexcept
+{
+	// comment tells whether the line starts inside a block comment
+	std::string result;
+	for (size_t i = 0; i < line.size(); i++)
+	{
+		if (comment)
+		{
+			if (line.compare(i, 2, "*/") == 0)
+			{
+				comment = false;
+				i++;
+			}
+		}
+		else
+		if (line.compare(i, 2, "//") == 0)
+		{
+			break;
+		}
+		else
+		if (line.compare(i, 2, "/*") == 0)
+		{
+			comment = true;
+			i++;
+		}
+		else
+		{
+			result += line[i];
+		}
+	}
+
+	const auto end = result.find_last_not_of(" \t");
+	result.erase(end == std::string::npos ? 0 : end + 1);
+
+	line.swap(result);
+}
+
+//==============================================================================
+
+void AssetCooker::Downsample(const unsigned char *source, int width, int height, int channels, unsigned char *target) noexcept
+{
+	// 2x2 box filter, odd edges repeat their last texel
+	const auto w = std::max(width  / 2, 1);
+	const auto h = std::max(height / 2, 1);
+
+	for (int y = 0; y < h; y++)
+	{
+		const auto y0 = std::min(2 * y,     height - 1);
+		const auto y1 = std::min(2 * y + 1, height - 1);
+
+		for (int x = 0; x < w; x++)
+		{
+			const auto x0 = std::min(2 * x,     width - 1);
+			const auto x1 = std::min(2 * x + 1, width - 1);
+
+			for (int c = 0; c < channels; c++)
+			{
+				const auto sum =
+					source[(static_cast<size_t>(y0) * width + x0) * channels + c] +
+					source[(static_cast<size_t>(y0) * width + x1) * channels + c] +
+					source[(static_cast<size_t>(y1) * width + x0) * channels + c] +
+					source[(static_cast<size_t>(y1) * width + x1) * channels + c];
+
+				target[(static_cast<size_t>(y) * w + x) * channels + c] = static_cast<unsigned char>((sum + 2) / 4);
+			}
+		}
+	}
+}
+
+//==============================================================================
+
+void AssetCooker::CompressRGTC1(const unsigned char *source, int width, int height, unsigned char *target) noexcept
+{
+	// 4x4 blocks in rows, partial blocks repeat their last row and column
+	unsigned char block[16];
+
+	for (int by = 0; by < height; by += 4)
+	{
+		for (int bx = 0; bx < width; bx += 4)
+		{
+			for (int i = 0; i < 16; i++)
+			{
+				const auto x = std::min(bx + i % 4, width  - 1);
+				const auto y = std::min(by + i / 4, height - 1);
+				block[i] = source[static_cast<size_t>(y) * width + x];
+			}
+
+			CompressBlock(block, target);
+			target += 8;
+		}
+	}
+}
+
+//==============================================================================
+
+void AssetCooker::CompressBlock(const unsigned char block[16], unsigned char *target) noexcept
+{
+	const auto low  = *std::min_element(block, block + 16);
+	const auto high = *std::max_element(block, block + 16);
+
+	// the eight value mode: red0 > red1, codes 2 .. 7 interpolate from red0 towards red1
+	target[0] = high;
+	target[1] = low;
+
+	uint64_t indices = 0;
+	if (high > low)
+	{
+		const auto range = high - low;
+		for (int i = 0; i < 16; i++)
+		{
+			const auto step = ((high - block[i]) * 7 + range / 2) / range;
+			const uint64_t code = step == 0 ? 0 : step == 7 ? 1 : step + 1;
+			indices |= code << (3 * i);
+		}
+	}
+
+	for (int i = 0; i < 6; i++)
+	{
+		target[2 + i] = static_cast<unsigned char>(indices >> (8 * i));
+	}
+}
+
+//==============================================================================
+
+AssetCooker::AssetCooker(const Settings &settings) noexcept :
+	settings(settings),
+	next(0)
+{
+}
+
+//==============================================================================
+
+AssetCooker::Settings AssetCooker::GetDefaultSettings() noexcept
+{
+	return { true, true, true, 0 };
+}
+
+//==============================================================================
+
+bool AssetCooker::Cook(const std::vector<std::string> &directories, const std::string &path, bool force) noexcept
+{
+	const auto start = std::chrono::steady_clock::now();
+
+	sources.clear();
+	for (auto &directory : directories)
+	{
+		Scan(directory);
+	}
+	std::sort(sources.begin(), sources.end());
+
+	// every file is a possible dependency, but only these become entries
+	assets.clear();
+	for (auto &source : sources)
+	{
+		const auto extension = GetExtension(source);
+
+		Asset asset;
+		if (extension == "png" || extension == "jpg" || extension == "jpeg" || extension == "tga" || extension == "bmp")
+		{
+			asset.type = AssetPack::Type::TEXTURE;
+		}
+		else
+		if (extension == "hdr")
+		{
+			asset.type = AssetPack::Type::HDR_TEXTURE;
+		}
+		else
+		if (extension == "vs" || extension == "gs" || extension == "fs" || extension == "cs")
+		{
+			asset.type = AssetPack::Type::SHADER;
+		}
+		else
+		{
+			continue;
+		}
+
+		asset.name = source;
+		asset.key  = 0;
+		asset.cooked = false;
+		asset.failed = false;
+
+		// a name that fills the field unterminated is rejected by the writer
+		std::memset(&asset.entry, 0, sizeof(asset.entry));
+		source.copy(asset.entry.name, sizeof(asset.entry.name));
+
+		assets.push_back(asset);
+	}
+
+	const auto threads = settings.threads ? settings.threads : std::max(std::thread::hardware_concurrency(), 1u);
+
+	// content hashes first, in parallel, one range of files per thread
+	{
+		std::vector<uint64_t> result(sources.size());
+		std::vector<std::thread> workers;
+		for (unsigned int i = 0; i < threads; i++)
+		{
+			const auto first = sources.size() * i / threads;
+			const auto last  = sources.size() * (i + 1) / threads;
+			workers.emplace_back(&AssetCooker::HashSources, this, first, last, &result);
+		}
+
+		for (auto &worker : workers)
+		{
+			worker.join();
+		}
+
+		hashes.clear();
+		for (size_t i = 0; i < sources.size(); i++)
+		{
+			hashes[sources[i]] = result[i];
+		}
+	}
+
+	// unchanged assets are copied from the previous pack as they are
+	AssetPack previous;
+	manifest.clear();
+	if (!force)
+	{
+		ReadManifest(path + ".manifest");
+		previous.Open(path);
+	}
+
+	AssetPackWriter writer;
+	pending.clear();
+
+	for (size_t i = 0; i < assets.size(); i++)
+	{
+		auto &asset = assets[i];
+
+		const auto record = manifest.find(asset.name);
+		const auto entry  = previous.Find(asset.name);
+
+		if (record != manifest.end() && entry && entry->type == asset.type &&
+			GetKey(asset.type, record->second.dependencies) == record->second.key)
+		{
+			asset.key = record->second.key;
+			asset.dependencies = record->second.dependencies;
+			writer.Add(*entry, previous.GetData(*entry), static_cast<size_t>(entry->size));
+		}
+		else
+		{
+			pending.push_back(i);
+		}
+	}
+
+	next = 0;
+	{
+		std::vector<std::thread> workers;
+		for (size_t i = 0; i < std::min<size_t>(threads, pending.size()); i++)
+		{
+			workers.emplace_back(&AssetCooker::Work, this);
+		}
+
+		for (auto &worker : workers)
+		{
+			worker.join();
+		}
+	}
+
+	size_t failed = 0;
+	for (auto index : pending)
+	{
+		auto &asset = assets[index];
+		if (asset.failed || !writer.Add(asset.entry, std::move(asset.payload)))
+		{
+			asset.failed = true;
+			failed++;
+		}
+	}
+
+	// written beside the previous pack, which the reused entries still point into
+	const auto temporary = path + ".tmp";
+	if (!writer.Write(temporary))
+	{
+		return false;
+	}
+
+	previous.Close();
+	std::remove(path.c_str());
+
+	if (std::rename(temporary.c_str(), path.c_str()) != 0)
+	{
+		std::cout << "error: asset pack " << path << " cannot be replaced" << std::endl;
+		return false;
+	}
+
+	WriteManifest(path + ".manifest");
+
+	const auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	std::cout << path << ": " << pending.size() - failed << " cooked, " << assets.size() - pending.size() << " up to date, "
+		<< failed << " failed in " << static_cast<int>(elapsed) << " ms" << std::endl;
+
+	return failed == 0;
+}
+
+//==============================================================================
@@ -0,0 +1,99 @@
+
+#pragma once
+
+//==============================================================================
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "AssetPack.h"
+
+//==============================================================================
+
+// converts the loose source assets into an AssetPack; an asset is only cooked
+// again when its sources, its includes or the settings it depends on change
+class AssetCooker
+{
+public:
+	struct Settings
+	{
+		bool mipmaps;          // every mip level stored, none generated at load
+		bool compress;         // RGTC1 for single channel textures
+		bool strip;            // shader comments and blank lines removed
+		unsigned int threads;  // 0 for every core
+	};
+
+	// bumped whenever the cooked output of the same sources changes
+	static const uint32_t VERSION = 1;
+
+private:
+	struct Asset
+	{
+		std::string name;
+		AssetPack::Type type;
+
+		// what the cooked entry was made from: the asset and its includes
+		std::vector<std::string> dependencies;
+		uint64_t key;
+
+		AssetPack::Entry entry;
+		std::vector<unsigned char> payload;
+		bool cooked;
+		bool failed;
+	};
+
+	struct Record
+	{
+		uint64_t key;
+		std::vector<std::string> dependencies;
+	};
+
+	Settings settings;
+
+	std::vector<std::string> sources;
+	std::map<std::string, uint64_t> hashes;
+	std::map<std::string, Record> manifest;
+
+	std::vector<Asset> assets;
+	std::vector<size_t> pending;
+	std::atomic<size_t> next;
+
+private:
+	static uint64_t Hash(const void *data, size_t size, uint64_t hash = 14695981039346656037ull) noexcept;
+	static bool ReadFile(const std::string &name, std::string &content) noexcept;
+	static std::string GetNativePath(const std::string &name) noexcept;
+	static std::string GetExtension(const std::string &name) noexcept;
+
+	void Scan(const std::string &directory) noexcept;
+
+	void HashSources(size_t first, size_t last, std::vector<uint64_t> *result) noexcept;
+	uint64_t GetKey(AssetPack::Type type, const std::vector<std::string> &dependencies) const noexcept;
+
+	void ReadManifest(const std::string &path) noexcept;
+	bool WriteManifest(const std::string &path) const noexcept;
+
+	void Work() noexcept;
+	bool CookTexture   (Asset &asset) const noexcept;
+	bool CookHDRTexture(Asset &asset) const noexcept;
+	bool CookShader    (Asset &asset) const noexcept;
+	bool Preprocess(const std::string &name, std::string &code, std::vector<std::string> &dependencies, unsigned int depth) const noexcept;
+	static void StripComments(std::string &line, bool &comment) noexcept;
+
+	// a box filtered chain, then optionally block compressed
+	static void Downsample(const unsigned char *source, int width, int height, int channels, unsigned char *target) noexcept;
+	static void CompressRGTC1(const unsigned char *source, int width, int height, unsigned char *target) noexcept;
+	static void CompressBlock(const unsigned char block[16], unsigned char *target) noexcept;
+
+public:
+	AssetCooker(const Settings &settings) noexcept;
+
+	static Settings GetDefaultSettings() noexcept;
+
+	// everything below the directories into path, with path.manifest next to it
+	bool Cook(const std::vector<std::string> &directories, const std::string &path, bool force = false) noexcept;
+};
+
+//==============================================================================
@@ -0,0 +1,211 @@
+
+#include "AssetPack.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+//==============================================================================
+
+const uint32_t AssetPack::VERSION;
+const size_t AssetPack::ALIGNMENT;
+
+//==============================================================================
+
+bool AssetPack::Validate(const std::string &path) noexcept
+{
+	const auto header = reinterpret_cast<const Header *>(data);
+
+	if (size < sizeof(Header) || std::memcmp(header->magic, "PACK", 4) != 0 || header->version != VERSION)
+	{
+		std::cout << "error: asset pack " << path << " has an unknown format" << std::endl;
+		return false;
+	}
+
+	if (header->index_offset > size || (size - header->index_offset) / sizeof(Entry) < header->count)
+	{
+		std::cout << "error: asset pack " << path << " is truncated" << std::endl;
+		return false;
+	}
+
+	entries = reinterpret_cast<const Entry *>(data + header->index_offset);
+	count = header->count;
+
+	for (uint32_t i = 0; i < count; i++)
+	{
+		const auto &entry = entries[i];
+		if (entry.offset > size || entry.size > size - entry.offset || entry.name[sizeof(entry.name) - 1] != '\0')
+		{
+			std::cout << "error: asset pack " << path << " is truncated" << std::endl;
+			return false;
+		}
+
+		if (!IsPayloadValid(entry))
+		{
+			std::cout << "error: asset pack " << path << " entry " << entry.name << " does not match its format" << std::endl;
+			return false;
+		}
+	}
+
+	return true;
+}
+
+//==============================================================================
+
+bool AssetPack::IsPayloadValid(const Entry &entry) noexcept
+{
+	switch (entry.type)
+	{
+	case Type::SHADER:
+		return entry.format == Format::TEXT;
+
+	case Type::HDR_TEXTURE:
+		// a single level of 3 halves per texel
+		if (entry.format != Format::RGB16F || entry.mips != 1)
+		{
+			return false;
+		}
+		break;
+
+	case Type::TEXTURE:
+		if (entry.format == Format::RGB16F || entry.format == Format::TEXT || entry.mips < 1 || entry.mips > 32)
+		{
+			return false;
+		}
+		break;
+
+	default:
+		return false;
+	}
+
+	if (entry.width == 0 || entry.height == 0)
+	{
+		return false;
+	}
+
+	// every level follows the previous one, see Texture::Load()
+	uint64_t expected = 0;
+	for (uint32_t mip = 0; mip < entry.mips; mip++)
+	{
+		const auto w = std::max(entry.width  >> mip, 1u);
+		const auto h = std::max(entry.height >> mip, 1u);
+		expected += GetLevelSize(entry.format, w, h);
+	}
+
+	return expected != 0 && expected == entry.size;
+}
+
+//==============================================================================
+
+bool AssetPack::Before(const Entry &entry, const std::string &name) noexcept
+{
+	return name.compare(entry.name) > 0;
+}
+
+//==============================================================================
+
+AssetPack::AssetPack() noexcept :
+	data(nullptr),
+	size(0),
+	entries(nullptr),
+	count(0)
+{
+}
+
+//==============================================================================
+
+AssetPack::~AssetPack() noexcept
+{
+	Close();
+}
+
+//==============================================================================
+
+bool AssetPack::Open(const std::string &path) noexcept
+{
+	Close();
+
+	if (!file.Open(path))
+	{
+		return false;
+	}
+
+	data = file.GetData();
+	size = file.GetSize();
+
+	if (!Validate(path))
+	{
+		Close();
+		return false;
+	}
+
+	return true;
+}
+
+//==============================================================================
+
+void AssetPack::Close() noexcept
+{
+	file.Close();
+
+	data = nullptr;
+	size = 0;
+	entries = nullptr;
+	count = 0;
+}
+
+//==============================================================================
+
+bool AssetPack::IsOpen() const noexcept
+{
+	return data != nullptr;
+}
+
+//==============================================================================
+
+const AssetPack::Entry *AssetPack::Find(const std::string &name) const noexcept
+{
+	// a binary search straight over the mapped index
+	const auto end = entries + count;
+	const auto it = std::lower_bound(entries, end, name, Before);
+
+	return it != end && name == it->name ? it : nullptr;
+}
+
+//==============================================================================
+
+const unsigned char *AssetPack::GetData(const Entry &entry) const noexcept
+{
+	return data + entry.offset;
+}
+
+//==============================================================================
+
+bool AssetPack::IsCompressed(Format format) noexcept
+{
+	return format == Format::RGTC1 || format == Format::RGTC2;
+}
+
+//==============================================================================
+
+size_t AssetPack::GetLevelSize(Format format, uint32_t width, uint32_t height) noexcept
+{
+	const size_t texels = static_cast<size_t>(width) * height;
+	const size_t blocks = static_cast<size_t>((width + 3) / 4) * ((height + 3) / 4);
+
+	switch (format)
+	{
+	case Format::R8:     return texels;
+	case Format::RG8:    return texels * 2;
+	case Format::RGB8:   return texels * 3;
+	case Format::RGBA8:  return texels * 4;
+	case Format::RGB16F: return texels * 6;
+	case Format::RGTC1:  return blocks * 8;
+	case Format::RGTC2:  return blocks * 16;
+	case Format::TEXT:
+	default:
+		return 0;
+	}
+}
+
+//==============================================================================
@@ -0,0 +1,83 @@
+
+#pragma once
+
+//==============================================================================
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "MappedFile.h"
+
+//==============================================================================
+
+// one read-only archive of cooked assets, mapped into memory as a whole;
+// payloads start on 4 KB boundaries and are uploaded straight from the mapping
+class AssetPack
+{
+public:
+	enum class Type : uint32_t { TEXTURE, HDR_TEXTURE, SHADER };
+
+	// texel layout of a payload, every mip level follows the previous one
+	enum class Format : uint32_t { R8, RG8, RGB8, RGBA8, RGB16F, RGTC1, RGTC2, TEXT };
+
+	static const uint32_t VERSION = 1;
+	static const size_t ALIGNMENT = 4096;
+
+	struct Header
+	{
+		char magic[4];
+		uint32_t version;
+		uint32_t count;
+		uint32_t reserved;
+		uint64_t index_offset;
+	};
+
+	// the index is sorted by name, names are the paths the loose files are loaded by
+	struct Entry
+	{
+		char name[96];
+		Type type;
+		Format format;
+		uint32_t width;
+		uint32_t height;
+		uint32_t mips;
+		float range[2];
+		float average[3];
+		uint64_t offset;
+		uint64_t size;
+	};
+
+private:
+	MappedFile file;
+	const unsigned char *data;
+	size_t size;
+
+	const Entry *entries;
+	uint32_t count;
+
+private:
+	bool Validate(const std::string &path) noexcept;
+	// the payload holds exactly what Texture and Environment upload for the entry
+	static bool IsPayloadValid(const Entry &entry) noexcept;
+
+	static bool Before(const Entry &entry, const std::string &name) noexcept;
+
+public:
+	AssetPack() noexcept;
+	~AssetPack() noexcept;
+
+	// a missing pack is not an error, the loose files are used instead
+	bool Open(const std::string &path) noexcept;
+	void Close() noexcept;
+
+	bool IsOpen() const noexcept;
+
+	const Entry *Find(const std::string &name) const noexcept;
+	const unsigned char *GetData(const Entry &entry) const noexcept;
+
+	static bool IsCompressed(Format format) noexcept;
+	static size_t GetLevelSize(Format format, uint32_t width, uint32_t height) noexcept;
+};
+
+//==============================================================================
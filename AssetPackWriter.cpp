@@ -0,0 +1,101 @@
+
+#include "AssetPackWriter.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+//==============================================================================
+
+bool AssetPackWriter::Before(const Item &a, const Item &b) noexcept
+{
+	return std::strcmp(a.entry.name, b.entry.name) < 0;
+}
+
+//==============================================================================
+
+uint64_t AssetPackWriter::Align(uint64_t offset) noexcept
+{
+	return (offset + AssetPack::ALIGNMENT - 1) / AssetPack::ALIGNMENT * AssetPack::ALIGNMENT;
+}
+
+//==============================================================================
+
+bool AssetPackWriter::Add(const AssetPack::Entry &entry, std::vector<unsigned char> payload) noexcept
+{
+	if (!Add(entry, nullptr, 0))
+	{
+		return false;
+	}
+
+	// moving a vector keeps its buffer, so data stays valid
+	auto &item = items.back();
+	item.payload = std::move(payload);
+	item.data = item.payload.data();
+	item.size = item.payload.size();
+	return true;
+}
+
+//==============================================================================
+
+bool AssetPackWriter::Add(const AssetPack::Entry &entry, const unsigned char *data, size_t size) noexcept
+{
+	if (entry.name[sizeof(entry.name) - 1] != '\0')
+	{
+		std::cout << "error: asset name " << std::string(entry.name, sizeof(entry.name)) << " is too long" << std::endl;
+		return false;
+	}
+
+	items.push_back({ entry, std::vector<unsigned char>(), data, size });
+	return true;
+}
+
+//==============================================================================
+
+bool AssetPackWriter::Write(const std::string &path) noexcept
+{
+	std::sort(items.begin(), items.end(), Before);
+
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	if (!file)
+	{
+		std::cout << "error: asset pack " << path << " cannot be written" << std::endl;
+		return false;
+	}
+
+	// payloads on 4 KB boundaries after the header, the index at the end
+	auto offset = Align(sizeof(AssetPack::Header));
+
+	std::vector<AssetPack::Entry> index;
+	for (auto &item : items)
+	{
+		auto entry = item.entry;
+		entry.offset = offset;
+		entry.size   = item.size;
+		index.push_back(entry);
+
+		file.seekp(static_cast<std::streamoff>(offset));
+		file.write(reinterpret_cast<const char *>(item.data), item.size);
+
+		offset = Align(offset + item.size);
+	}
+
+	AssetPack::Header header = { { 'P', 'A', 'C', 'K' }, AssetPack::VERSION, static_cast<uint32_t>(index.size()), 0, offset };
+
+	file.seekp(static_cast<std::streamoff>(offset));
+	file.write(reinterpret_cast<const char *>(index.data()), index.size() * sizeof(AssetPack::Entry));
+
+	file.seekp(0);
+	file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+	if (!file)
+	{
+		std::cout << "error: asset pack " << path << " cannot be written" << std::endl;
+		return false;
+	}
+
+	return true;
+}
+
+//==============================================================================
@@ -0,0 +1,43 @@
+
+#pragma once
+
+//==============================================================================
+
+#include <string>
+#include <vector>
+
+#include "AssetPack.h"
+
+//==============================================================================
+
+// collects cooked payloads and writes them out in the AssetPack layout
+class AssetPackWriter
+{
+private:
+	struct Item
+	{
+		AssetPack::Entry entry;
+		std::vector<unsigned char> payload;
+
+		// the payload's data, or memory owned by the caller
+		const unsigned char *data;
+		size_t size;
+	};
+
+	std::vector<Item> items;
+
+private:
+	static bool Before(const Item &a, const Item &b) noexcept;
+	static uint64_t Align(uint64_t offset) noexcept;
+
+public:
+	// the entry's offset and size are filled in by Write
+	bool Add(const AssetPack::Entry &entry, std::vector<unsigned char> payload) noexcept;
+
+	// without a copy, e.g. from a mapped pack; the data must outlive Write
+	bool Add(const AssetPack::Entry &entry, const unsigned char *data, size_t size) noexcept;
+
+	bool Write(const std::string &path) noexcept;
+};
+
+//==============================================================================
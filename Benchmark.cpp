@@ -0,0 +1,285 @@
+
+#include "Benchmark.h"
+
+#include "Cubemap.h"
+#include "Environment.h"
+#include "Scene.h"
+#include "Shader.h"
+#include "Skybox.h"
+#include "Sphere.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "GLAD/glad.h"
+
+//==============================================================================
+
+void Benchmark::Compare(const std::vector<float> &data, const std::vector<float> &reference, double &sum, double &max, size_t &count) noexcept
+{
+	// relative error of every channel against the reference, accumulated
+	for (size_t i = 0; i < std::min(data.size(), reference.size()); i++)
+	{
+		const auto error = std::abs(static_cast<double>(data[i]) - reference[i]) / std::max(static_cast<double>(std::abs(reference[i])), 1e-3);
+		sum += error;
+		max = std::max(max, error);
+		count++;
+	}
+}
+
+//==============================================================================
+
+double Benchmark::Bake(Environment &environment) const noexcept
+{
+	// GL stages only, the background load is not part of the bake
+	while (environment.GetStage() == Environment::Stage::LOADING)
+	{
+		environment.Update(scene);
+		std::this_thread::yield();
+	}
+
+	glFinish();
+	const auto start = std::chrono::steady_clock::now();
+
+	while (!environment.IsReady())
+	{
+		environment.Update(scene);
+	}
+
+	glFinish();
+	const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+	return elapsed.count();
+}
+
+//==============================================================================
+
+double Benchmark::Render(const Environment &environment) const noexcept
+{
+	const auto draws = 64;
+
+	// the background pass is bound by cubemap fetches, like the IBL lookups
+	auto background_shader = scene.GetShader("background");
+	background_shader->Use();
+	background_shader->SetMat4("view", glm::mat4(1.0f));
+	background_shader->SetMat4("projection", glm::perspective(glm::radians(90.0f), 16.0f / 9.0f, 0.1f, 10.0f));
+	background_shader->SetFloat("fade", 0.0f);
+	background_shader->SetBool("tonemap", true);
+
+	environment.GetEnvironmentMap()->Bind(0);
+
+	glBeginQuery(GL_TIME_ELAPSED, query);
+	for (auto i = 0; i < draws; i++)
+	{
+		skybox->Draw();
+	}
+	glEndQuery(GL_TIME_ELAPSED);
+
+	GLuint64 nanoseconds = 0;
+	glGetQueryObjectui64v(query, GL_QUERY_RESULT, &nanoseconds);
+
+	return nanoseconds / 1e6 / draws;
+}
+
+//==============================================================================
+
+double Benchmark::Render(const Drawable &mesh) const noexcept
+{
+	const auto draws = 16;
+
+	// seen from inside by the background pass, every triangle is transformed
+	// and then culled, which leaves the vertex work the index order is about
+	auto background_shader = scene.GetShader("background");
+	background_shader->Use();
+	background_shader->SetMat4("view", glm::mat4(1.0f));
+	background_shader->SetMat4("projection", glm::perspective(glm::radians(90.0f), 16.0f / 9.0f, 0.1f, 10.0f));
+	background_shader->SetFloat("fade", 0.0f);
+	background_shader->SetBool("tonemap", true);
+
+	// warm up, the first draw may include the upload
+	mesh.Draw();
+	glFinish();
+
+	// wall clock like Bake(), nothing else is queued
+	const auto start = std::chrono::steady_clock::now();
+	for (auto i = 0; i < draws; i++)
+	{
+		mesh.Draw();
+	}
+	glFinish();
+
+	const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+	return elapsed.count() / draws;
+}
+
+//==============================================================================
+
+Benchmark::Benchmark(const Scene &scene) noexcept :
+	scene(scene),
+	skybox(nullptr),
+	query(0)
+{
+	skybox = new Skybox;
+	glGenQueries(1, &query);
+}
+
+//==============================================================================
+
+Benchmark::~Benchmark() noexcept
+{
+	delete skybox;
+	glDeleteQueries(1, &query);
+}
+
+//==============================================================================
+
+std::vector<Benchmark::Result> Benchmark::CompareFormats(const std::string &path, const IBLQuality &quality) const noexcept
+{
+	std::vector<Result> results;
+
+	std::vector<float> reference_env;
+	std::vector<float> reference_irradiance;
+	std::vector<std::vector<float>> reference_prefilter;
+
+	for (auto format : { HDRFormat::RGB16F, HDRFormat::R11G11B10F, HDRFormat::RGB9E5 })
+	{
+		auto settings = quality;
+		settings.format = format;
+		settings.lazy = false;
+		settings.octahedral = false;
+
+		Environment environment(path, settings);
+
+		Result result = { format, 0, 0.0, 0.0, 0.0, 0.0 };
+		result.bake_ms = Bake(environment);
+
+		if (!environment.GetPrefilterMap())
+		{
+			std::cout << "error: benchmark environment " << path << " is not baked" << std::endl;
+			return results;
+		}
+
+		result.memory    = environment.GetMemorySize();
+		result.render_ms = Render(environment);
+
+		const auto env = environment.GetEnvironmentMap()->Read(0);
+		const auto irradiance = environment.GetIrradianceMap()->Read(0);
+
+		std::vector<std::vector<float>> prefilter;
+		for (unsigned int mip = 0; mip < settings.prefilter_mips; mip++)
+		{
+			prefilter.push_back(environment.GetPrefilterMap()->Read(mip));
+		}
+
+		if (format == HDRFormat::RGB16F)
+		{
+			reference_env        = env;
+			reference_irradiance = irradiance;
+			reference_prefilter  = prefilter;
+		}
+		else
+		{
+			double sum = 0.0;
+			size_t count = 0;
+
+			Compare(env, reference_env, sum, result.max_error, count);
+			Compare(irradiance, reference_irradiance, sum, result.max_error, count);
+			for (size_t mip = 0; mip < prefilter.size(); mip++)
+			{
+				Compare(prefilter[mip], reference_prefilter[mip], sum, result.max_error, count);
+			}
+
+			result.mean_error = count ? sum / count : 0.0;
+		}
+
+		results.push_back(result);
+	}
+
+	return results;
+}
+
+//==============================================================================
+
+std::vector<Benchmark::MeshResult> Benchmark::CompareMeshes() const noexcept
+{
+	std::vector<MeshResult> results;
+
+	// 255 is the densest that still fits 16 bit indices
+	for (auto segments : { 64u, 255u, 512u })
+	{
+		for (auto optimized : { false, true })
+		{
+			const auto start = std::chrono::steady_clock::now();
+			Sphere sphere(segments, optimized);
+			const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+			MeshResult result = { segments, optimized, static_cast<size_t>(segments + 1) * (segments + 1), sphere.GetMemorySize(), sphere.GetStatistics(), 0.0 };
+			result.render_ms = Render(sphere);
+			results.push_back(result);
+
+			if (optimized)
+			{
+				std::cout << segments << " segments optimized in " << elapsed.count() << " ms" << std::endl;
+			}
+		}
+	}
+
+	return results;
+}
+
+//==============================================================================
+
+void Benchmark::Print(const std::vector<Result> &results) noexcept
+{
+	if (results.empty())
+	{
+		return;
+	}
+
+	const auto reference = static_cast<double>(results.front().memory);
+
+	std::cout << std::left << std::setw(12) << "format"
+		<< std::right << std::setw(12) << "memory, MB" << std::setw(10) << "saved"
+		<< std::setw(12) << "bake, ms" << std::setw(12) << "render, ms"
+		<< std::setw(14) << "mean error" << std::setw(14) << "max error" << std::endl;
+
+	for (auto &result : results)
+	{
+		const auto saved = reference > 0.0 ? 100.0 * (1.0 - result.memory / reference) : 0.0;
+
+		std::cout << std::left << std::setw(12) << GetName(result.format) << std::right << std::fixed
+			<< std::setw(12) << std::setprecision(2) << result.memory / (1024.0 * 1024.0)
+			<< std::setw(9) << std::setprecision(1) << saved << "%"
+			<< std::setw(12) << std::setprecision(2) << result.bake_ms
+			<< std::setw(12) << std::setprecision(3) << result.render_ms
+			<< std::setw(13) << std::setprecision(3) << 100.0 * result.mean_error << "%"
+			<< std::setw(13) << std::setprecision(1) << 100.0 * result.max_error << "%" << std::endl;
+	}
+}
+
+//==============================================================================
+
+void Benchmark::Print(const std::vector<MeshResult> &results) noexcept
+{
+	std::cout << std::left << std::setw(10) << "segments" << std::setw(11) << "order"
+		<< std::right << std::setw(10) << "vertices" << std::setw(12) << "memory, KB"
+		<< std::setw(8) << "ACMR" << std::setw(8) << "ATVR" << std::setw(12) << "render, ms" << std::endl;
+
+	for (auto &result : results)
+	{
+		std::cout << std::left << std::setw(10) << result.segments << std::setw(11) << (result.optimized ? "optimized" : "strip")
+			<< std::right << std::fixed
+			<< std::setw(10) << result.vertices
+			<< std::setw(12) << std::setprecision(1) << result.memory / 1024.0
+			<< std::setw(8) << std::setprecision(3) << result.statistics.acmr
+			<< std::setw(8) << std::setprecision(3) << result.statistics.atvr
+			<< std::setw(12) << std::setprecision(3) << result.render_ms << std::endl;
+	}
+}
+
+//==============================================================================
@@ -0,0 +1,71 @@
+
+#pragma once
+
+//==============================================================================
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "HDRFormat.h"
+#include "IBLQuality.h"
+#include "MeshOptimizer.h"
+
+//==============================================================================
+
+class Drawable;
+class Environment;
+class Scene;
+class Skybox;
+
+//==============================================================================
+
+// measures the IBL storage formats against RGB16F on one environment,
+// and the optimized mesh order against the generated one
+class Benchmark
+{
+public:
+	struct Result
+	{
+		HDRFormat format;
+		size_t memory;
+		double bake_ms;
+		double render_ms;
+		double mean_error;
+		double max_error;
+	};
+
+	struct MeshResult
+	{
+		unsigned int segments;
+		bool optimized;
+		size_t vertices;
+		size_t memory;
+		MeshOptimizer::Statistics statistics;
+		double render_ms;
+	};
+
+private:
+	const Scene &scene;
+	Skybox *skybox;
+	unsigned int query;
+
+private:
+	double Bake(Environment &environment) const noexcept;
+	double Render(const Environment &environment) const noexcept;
+	double Render(const Drawable &mesh) const noexcept;
+
+	static void Compare(const std::vector<float> &data, const std::vector<float> &reference, double &sum, double &max, size_t &count) noexcept;
+
+public:
+	Benchmark(const Scene &scene) noexcept;
+	~Benchmark() noexcept;
+
+	std::vector<Result> CompareFormats(const std::string &path, const IBLQuality &quality) const noexcept;
+	std::vector<MeshResult> CompareMeshes() const noexcept;
+
+	static void Print(const std::vector<Result> &results) noexcept;
+	static void Print(const std::vector<MeshResult> &results) noexcept;
+};
+
+//==============================================================================
@@ -0,0 +1,231 @@
+
+#include "ClusterCuller.h"
+
+#include <algorithm>
+#include <string>
+
+#include "GLAD/glad.h"
+
+#include "Mesh.h"
+#include "Shader.h"
+
+//==============================================================================
+
+ClusterCuller::ClusterCuller() noexcept :
+	width(0),
+	height(0),
+	depth_texture(0),
+	pyramid_texture(0),
+	pyramid_width(0),
+	pyramid_height(0),
+	pyramid_levels(0),
+	counter_buffer(0),
+	counter_capacity(0)
+{
+	glGenBuffers(1, &counter_buffer);
+}
+
+//==============================================================================
+
+ClusterCuller::~ClusterCuller() noexcept
+{
+	glDeleteTextures(1, &depth_texture);
+	glDeleteTextures(1, &pyramid_texture);
+	glDeleteBuffers(1, &counter_buffer);
+}
+
+//==============================================================================
+
+void ClusterCuller::Resize(unsigned int width, unsigned int height) noexcept
+{
+	glDeleteTextures(1, &depth_texture);
+	glDeleteTextures(1, &pyramid_texture);
+
+	this->width  = width;
+	this->height = height;
+
+	glGenTextures(1, &depth_texture);
+	glBindTexture(GL_TEXTURE_2D, depth_texture);
+	glTexStorage2D(GL_TEXTURE_2D, 1, GL_DEPTH_COMPONENT32F, width, height);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+	// every level past the first halves exactly
+	pyramid_width  = 1;
+	pyramid_height = 1;
+	while (pyramid_width * 2 <= width)
+	{
+		pyramid_width *= 2;
+	}
+	while (pyramid_height * 2 <= height)
+	{
+		pyramid_height *= 2;
+	}
+
+	pyramid_levels = 1;
+	while ((std::max(pyramid_width, pyramid_height) >> pyramid_levels) > 0)
+	{
+		pyramid_levels++;
+	}
+
+	glGenTextures(1, &pyramid_texture);
+	glBindTexture(GL_TEXTURE_2D, pyramid_texture);
+	glTexStorage2D(GL_TEXTURE_2D, pyramid_levels, GL_R32F, pyramid_width, pyramid_height);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+	glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+//==============================================================================
+
+void ClusterCuller::GetFrustumPlanes(const glm::mat4 &view_projection, glm::vec4 *planes) noexcept
+{
+	// the rows of the matrix, added to and subtracted from the w row
+	const auto rows = glm::transpose(view_projection);
+	for (int i = 0; i < 3; i++)
+	{
+		planes[2 * i + 0] = rows[3] + rows[i];
+		planes[2 * i + 1] = rows[3] - rows[i];
+	}
+
+	for (int i = 0; i < 6; i++)
+	{
+		planes[i] /= glm::length(glm::vec3(planes[i]));
+	}
+}
+
+//==============================================================================
+
+void ClusterCuller::Cull(const Shader *cull_shader, const std::vector<Mesh*> &meshes, const glm::mat4 &view, const glm::mat4 &projection, Pass pass) noexcept
+{
+	if (meshes.empty())
+	{
+		return;
+	}
+
+	// a counter per mesh, so no dispatch has to wait for the one before
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, counter_buffer);
+	if (counter_capacity < meshes.size())
+	{
+		counter_capacity = meshes.size();
+		glBufferData(GL_SHADER_STORAGE_BUFFER, counter_capacity * sizeof(unsigned int), nullptr, GL_DYNAMIC_COPY);
+	}
+	glClearBufferData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, counter_buffer);
+
+	glm::vec4 planes[6];
+	GetFrustumPlanes(projection * view, planes);
+	const auto camera = glm::vec3(glm::inverse(view)[3]);
+
+	const auto late = pass == Pass::LATE;
+
+	cull_shader->Use();
+	for (unsigned int i = 0; i < 6; i++)
+	{
+		cull_shader->SetVec4("planes[" + std::to_string(i) + "]", planes[i]);
+	}
+	cull_shader->SetMat4("view", view);
+	cull_shader->SetMat4("projection", projection);
+	cull_shader->SetBool("late", late);
+	cull_shader->SetInt("pyramid", 0);
+	cull_shader->SetInt("pyramid_levels", static_cast<int>(pyramid_levels));
+
+	if (late)
+	{
+		glActiveTexture(GL_TEXTURE0);
+		glBindTexture(GL_TEXTURE_2D, pyramid_texture);
+	}
+
+	for (size_t i = 0; i < meshes.size(); i++)
+	{
+		const auto mesh = meshes[i];
+		const auto commands = mesh->GetCommandBuffer(static_cast<unsigned int>(pass));
+
+		// the commands past the visible ones draw nothing
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, commands);
+		glClearBufferData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, mesh->GetMeshletBuffer());
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, mesh->GetVisibilityBuffer());
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, commands);
+
+		// the bounds are in the mesh's own space, the cones are tested there
+		const auto model = mesh->GetModel() * mesh->GetPositionDecode();
+		const auto axes  = glm::mat3(model);
+		const auto scale = std::max(glm::length(axes[0]), std::max(glm::length(axes[1]), glm::length(axes[2])));
+
+		cull_shader->SetMat4("model", model);
+		cull_shader->SetFloat("model_scale", scale);
+		cull_shader->SetVec3("object_camera", glm::vec3(glm::inverse(model) * glm::vec4(camera, 1.0f)));
+		cull_shader->SetBool("cone_culling", !mesh->IsDoubleSided());
+		cull_shader->SetInt("meshlet_count", static_cast<int>(mesh->GetMeshletCount()));
+		cull_shader->SetInt("counter", static_cast<int>(i));
+
+		glDispatchCompute((mesh->GetMeshletCount() + GROUP_SIZE - 1) / GROUP_SIZE, 1, 1);
+
+		mesh->SetCommands(commands);
+	}
+
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+	// the draws read the commands, the next pass the visibility, and the next
+	// clear overwrites both
+	glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT);
+}
+
+//==============================================================================
+
+void ClusterCuller::BuildDepthPyramid(const Shader *pyramid_shader, unsigned int width, unsigned int height) noexcept
+{
+	if (width == 0 || height == 0)
+	{
+		return;
+	}
+
+	if (width != this->width || height != this->height)
+	{
+		Resize(width, height);
+	}
+
+	// the default framebuffer cannot be sampled, so its depth is copied first
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_2D, depth_texture);
+	glCopyTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, 0, 0, width, height);
+
+	pyramid_shader->Use();
+	pyramid_shader->SetInt("source", 0);
+
+	for (unsigned int level = 0; level < pyramid_levels; level++)
+	{
+		if (level > 0)
+		{
+			glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+			glBindTexture(GL_TEXTURE_2D, pyramid_texture);
+		}
+
+		pyramid_shader->SetInt("source_level", level > 0 ? level - 1 : 0);
+		glBindImageTexture(0, pyramid_texture, level, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+
+		const auto level_width  = std::max(pyramid_width  >> level, 1u);
+		const auto level_height = std::max(pyramid_height >> level, 1u);
+		glDispatchCompute((level_width + PYRAMID_GROUP_SIZE - 1) / PYRAMID_GROUP_SIZE, (level_height + PYRAMID_GROUP_SIZE - 1) / PYRAMID_GROUP_SIZE, 1);
+	}
+
+	glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+	glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+//==============================================================================
+
+void ClusterCuller::Reset(const std::vector<Mesh*> &meshes) noexcept
+{
+	for (auto mesh : meshes)
+	{
+		mesh->SetCommands(0);
+	}
+}
+
+//==============================================================================
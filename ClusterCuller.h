@@ -0,0 +1,73 @@
+
+#pragma once
+
+//==============================================================================
+
+#include <cstddef>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+//==============================================================================
+
+class Mesh;
+class Shader;
+
+//==============================================================================
+
+// culls the meshlets of large meshes on the GPU, in two passes per frame: the
+// early pass keeps what was visible last frame, the depth it leaves becomes a
+// pyramid of the farthest depth (Hi-Z), and the late pass tests every meshlet
+// against that, draws the ones that just came into view and remembers what is
+// visible for the next frame; both passes also cull by the frustum and by the
+// normal cones
+//
+// each pass compacts the visible meshlets into the front of the mesh's command
+// buffer; GL 4.3 has no draw count from a buffer, so the rest is zeroed and
+// the draw walks every command
+class ClusterCuller
+{
+public:
+	enum class Pass : unsigned int { EARLY, LATE };
+
+private:
+	// invocations per work group of cull.cs and, per side, of depth_pyramid.cs
+	static const unsigned int GROUP_SIZE = 64;
+	static const unsigned int PYRAMID_GROUP_SIZE = 8;
+
+	unsigned int width;
+	unsigned int height;
+	unsigned int depth_texture;
+
+	// the largest power of two below the screen, down to a single texel
+	unsigned int pyramid_texture;
+	unsigned int pyramid_width;
+	unsigned int pyramid_height;
+	unsigned int pyramid_levels;
+
+	// the commands each mesh got so far in this pass
+	unsigned int counter_buffer;
+	size_t counter_capacity;
+
+private:
+	void Resize(unsigned int width, unsigned int height) noexcept;
+
+	// world space, normalized, so a sphere is outside when its distance is below -radius
+	static void GetFrustumPlanes(const glm::mat4 &view_projection, glm::vec4 *planes) noexcept;
+
+public:
+	ClusterCuller() noexcept;
+	~ClusterCuller() noexcept;
+
+	// fills the pass's command buffer of every mesh and has the mesh draw it;
+	// the late pass needs the pyramid of this frame
+	void Cull(const Shader *cull_shader, const std::vector<Mesh*> &meshes, const glm::mat4 &view, const glm::mat4 &projection, Pass pass) noexcept;
+
+	// from the depth buffer of the bound read framebuffer
+	void BuildDepthPyramid(const Shader *pyramid_shader, unsigned int width, unsigned int height) noexcept;
+
+	// back to every triangle, e.g. for the probe captures
+	static void Reset(const std::vector<Mesh*> &meshes) noexcept;
+};
+
+//==============================================================================
@@ -0,0 +1,65 @@
+
+#include "AssetCooker.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+//==============================================================================
+
+// Cooker [--force] [--no-mipmaps] [--no-compress] [--no-strip] [--threads N] [pack]
+// cooks shaders\ and textures\ into the pack the renderer opens, assets.pak by default
+int main(int argc, char **argv)
+{
+	auto settings = AssetCooker::GetDefaultSettings();
+	auto force = false;
+	std::string path = "assets.pak";
+
+	for (int i = 1; i < argc; i++)
+	{
+		const std::string argument = argv[i];
+
+		if (argument == "--force")
+		{
+			force = true;
+		}
+		else
+		if (argument == "--no-mipmaps")
+		{
+			settings.mipmaps = false;
+		}
+		else
+		if (argument == "--no-compress")
+		{
+			settings.compress = false;
+		}
+		else
+		if (argument == "--no-strip")
+		{
+			settings.strip = false;
+		}
+		else
+		if (argument == "--threads" && i + 1 < argc)
+		{
+			settings.threads = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
+		}
+		else
+		if (argument.compare(0, 2, "--") != 0)
+		{
+			path = argument;
+		}
+		else
+		{
+			std::cout << "error: unknown option " << argument << std::endl;
+			return 1;
+		}
+	}
+
+	AssetCooker cooker(settings);
+	return cooker.Cook({ "shaders", "textures" }, path, force) ? 0 : 1;
+}
+
+//==============================================================================
@@ -3,6 +3,7 @@
 
 #include "Texture.h"
 
+#include <cmath>
 #include <iostream>
 
 #include "stb_image.h"
@@ -36,15 +37,17 @@ void Cubemap::SetParametersMipmap() noexcept
 //==============================================================================
 
 Cubemap::Cubemap() noexcept :
-	cubemap(0)
+	cubemap(0),
+	format(HDRFormat::RGB16F)
 {
 	glGenTextures(1, &cubemap);
 }
 
 //==============================================================================
 
-Cubemap::Cubemap(unsigned int width, unsigned int height, bool mipmap) noexcept :
-	cubemap(0)
+Cubemap::Cubemap(unsigned int width, unsigned int height, bool mipmap, HDRFormat format) noexcept :
+	cubemap(0),
+	format(format)
 {
 	glGenTextures(1, &cubemap);
 
@@ -52,7 +55,7 @@ Cubemap::Cubemap(unsigned int width, unsigned int height, bool mipmap) noexcept
 	
 	for (unsigned int i = 0; i < 6; i++)
 	{
-		glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_RGB16F, width, height, 0, GL_RGB, GL_FLOAT, nullptr);
+		glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GetInternalFormat(format), width, height, 0, GL_RGB, GL_FLOAT, nullptr);
 	}
 	
 	if (mipmap)
@@ -69,6 +72,33 @@ Cubemap::Cubemap(unsigned int width, unsigned int height, bool mipmap) noexcept
 
 //==============================================================================
 
+Cubemap::Cubemap(unsigned int size, unsigned int base_level, unsigned int max_level, HDRFormat format) noexcept :
+	cubemap(0),
+	format(format)
+{
+	glGenTextures(1, &cubemap);
+
+	glBindTexture(GL_TEXTURE_CUBE_MAP, cubemap);
+
+	// storage only for the requested part of the mip chain
+	for (unsigned int mip = base_level; mip <= max_level; mip++)
+	{
+		for (unsigned int i = 0; i < 6; i++)
+		{
+			glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, mip, GetInternalFormat(format), size >> mip, size >> mip, 0, GL_RGB, GL_FLOAT, nullptr);
+		}
+	}
+
+	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_BASE_LEVEL, base_level);
+	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAX_LEVEL,  max_level);
+
+	SetParametersMipmap();
+
+	glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+}
+
+//==============================================================================
+
 Cubemap::~Cubemap() noexcept
 {
 	glDeleteTextures(1, &cubemap);
@@ -83,6 +113,13 @@ unsigned int Cubemap::GetID() const noexcept
 
 //==============================================================================
 
+HDRFormat Cubemap::GetFormat() const noexcept
+{
+	return format;
+}
+
+//==============================================================================
+
 void Cubemap::Load(const std::vector<std::string> &faces, bool flip) noexcept
 {
 	glBindTexture(GL_TEXTURE_CUBE_MAP, cubemap);
@@ -140,6 +177,79 @@ void Cubemap::GenerateMipmap() const noexcept
 
 //==============================================================================
 
+std::vector<float> Cubemap::Read(unsigned int mip) const noexcept
+{
+	glBindTexture(GL_TEXTURE_CUBE_MAP, cubemap);
+
+	int size = 0;
+	glGetTexLevelParameteriv(GL_TEXTURE_CUBE_MAP_POSITIVE_X, mip, GL_TEXTURE_WIDTH, &size);
+
+	const auto face_size = static_cast<size_t>(3) * size * size;
+	std::vector<float> data(6 * face_size);
+
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+	for (unsigned int i = 0; i < 6 && size > 0; i++)
+	{
+		glGetTexImage(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, mip, GL_RGB, GL_FLOAT, &data[i * face_size]);
+	}
+
+	glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+
+	return data;
+}
+
+//==============================================================================
+
+void Cubemap::Convert(HDRFormat format) noexcept
+{
+	if (format == this->format)
+	{
+		return;
+	}
+
+	int base_level = 0;
+	int max_level = 0;
+
+	glBindTexture(GL_TEXTURE_CUBE_MAP, cubemap);
+	glGetTexParameteriv(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_BASE_LEVEL, &base_level);
+	glGetTexParameteriv(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAX_LEVEL,  &max_level);
+
+	// a round trip through the CPU, the driver encodes the new format on upload
+	std::vector<std::vector<float>> levels;
+	for (auto mip = base_level; mip <= max_level; mip++)
+	{
+		int size = 0;
+		glGetTexLevelParameteriv(GL_TEXTURE_CUBE_MAP_POSITIVE_X, mip, GL_TEXTURE_WIDTH, &size);
+		if (size == 0)
+		{
+			break;
+		}
+
+		levels.push_back(Read(mip));
+	}
+
+	glBindTexture(GL_TEXTURE_CUBE_MAP, cubemap);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+	for (size_t level = 0; level < levels.size(); level++)
+	{
+		const auto mip = base_level + static_cast<int>(level);
+		const auto size = static_cast<int>(std::sqrt(levels[level].size() / 18));
+		const auto face_size = static_cast<size_t>(3) * size * size;
+
+		for (unsigned int i = 0; i < 6; i++)
+		{
+			glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, mip, GetInternalFormat(format), size, size, 0, GL_RGB, GL_FLOAT, &levels[level][i * face_size]);
+		}
+	}
+
+	glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+
+	this->format = format;
+}
+
+//==============================================================================
+
 void Cubemap::Bind(unsigned int texture_unit) const noexcept
 {
 	glActiveTexture(GL_TEXTURE0 + texture_unit);
@@ -6,12 +6,15 @@
 #include <string>
 #include <vector>
 
+#include "HDRFormat.h"
+
 //==============================================================================
 
 class Cubemap
 {
 private:
 	unsigned int cubemap;
+	HDRFormat format;
 
 public:
 	void SetParameters()       noexcept;
@@ -19,15 +22,23 @@ public:
 
 public:
 	Cubemap() noexcept;
-	Cubemap(unsigned int width, unsigned int height, bool mipmap = true) noexcept;
+	Cubemap(unsigned int width, unsigned int height, bool mipmap = true, HDRFormat format = HDRFormat::RGB16F) noexcept;
+	Cubemap(unsigned int size, unsigned int base_level, unsigned int max_level, HDRFormat format = HDRFormat::RGB16F) noexcept;
 	~Cubemap() noexcept;
 
 	unsigned int GetID() const noexcept;
+	HDRFormat GetFormat() const noexcept;
 
 	void Load(const std::vector<std::string> &faces, bool flip) noexcept;
 
 	void GenerateMipmap() const noexcept;
 
+	// six faces of one mip level as RGB floats
+	std::vector<float> Read(unsigned int mip) const noexcept;
+
+	// re-stores every level, e.g. into RGB9E5 once rendering is done
+	void Convert(HDRFormat format) noexcept;
+
 	void Bind(unsigned int texture_unit = 0) const noexcept;
 	static void Unbind() noexcept;
 };
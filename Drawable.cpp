@@ -1,15 +1,33 @@
 
 #include "Drawable.h"
 
+#include <cstring>
+
+#include <glm/gtc/matrix_transform.hpp>
+
 #include "GLAD/glad.h"
 
 //==============================================================================
 
+const float Drawable::LEVEL_HYSTERESIS = 0.75f;
+
+//==============================================================================
+
 Drawable::Drawable() noexcept :
 	VAO(0),
 	VBO(0),
+	EBO(0),
+	material(nullptr),
 	model(1.0f),
-	material(nullptr)
+	position_decode(1.0f),
+	radius(1.0f),
+	index_count(0),
+	index_type(GL_UNSIGNED_INT),
+	mode(GL_TRIANGLES),
+	statistics{ 0.0f, 0.0f },
+	vertex_memory(0),
+	index_memory(0),
+	level(0)
 {
 	glGenVertexArrays(1, &VAO);
 	glGenBuffers(1, &VBO);
@@ -21,6 +39,259 @@ Drawable::~Drawable() noexcept
 {
 	glDeleteVertexArrays(1, &VAO);
 	glDeleteBuffers(1, &VBO);
+	glDeleteBuffers(1, &EBO);
+}
+
+//==============================================================================
+
+void Drawable::SetVertices(const std::vector<glm::vec3> &positions, const std::vector<glm::vec3> &normals,
+	const std::vector<glm::vec2> &uvs, const std::vector<glm::vec4> &tangents, VertexFormat::Position format) noexcept
+{
+	const auto count = positions.size();
+
+	std::vector<unsigned char> data(GetVertexSize(count, !normals.empty(), !uvs.empty(), !tangents.empty(), format));
+	PackVertices(positions, normals, uvs, tangents, format, data.data());
+
+	glBindBuffer(GL_ARRAY_BUFFER, VBO);
+	glBufferData(GL_ARRAY_BUFFER, data.size(), data.data(), GL_STATIC_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	SetLayout(count, !normals.empty(), !uvs.empty(), !tangents.empty(), format);
+}
+
+//==============================================================================
+
+void Drawable::SetIndices(const std::vector<unsigned int> &indices, unsigned int mode, size_t vertex_count) noexcept
+{
+	std::vector<unsigned char> data(GetIndexSize(indices.size(), vertex_count));
+	PackIndices(indices, mode, vertex_count, data.data());
+
+	if (!EBO)
+	{
+		glGenBuffers(1, &EBO);
+	}
+
+	glBindVertexArray(VAO);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, data.size(), data.data(), GL_STATIC_DRAW);
+	glBindVertexArray(0);
+
+	index_memory = data.size();
+}
+
+//==============================================================================
+
+void Drawable::SetLevels(const std::vector<std::vector<unsigned int>> &indices, const std::vector<float> &errors, unsigned int mode, size_t vertex_count) noexcept
+{
+	size_t count = 0;
+	for (const auto &level_indices : indices)
+	{
+		count += level_indices.size();
+	}
+
+	std::vector<unsigned char> data(GetIndexSize(count, vertex_count));
+	PackLevels(indices, errors, mode, vertex_count, data.data());
+
+	if (!EBO)
+	{
+		glGenBuffers(1, &EBO);
+	}
+
+	glBindVertexArray(VAO);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, data.size(), data.data(), GL_STATIC_DRAW);
+	glBindVertexArray(0);
+
+	index_memory = data.size();
+}
+
+//==============================================================================
+
+void Drawable::DrawElements() const noexcept
+{
+	const auto first = levels.empty() ? 0 : levels[level].first;
+	const auto count = levels.empty() ? index_count : levels[level].count;
+	const auto index_size = index_type == GL_UNSIGNED_SHORT ? sizeof(unsigned short) : sizeof(unsigned int);
+
+	glBindVertexArray(VAO);
+	glDrawElements(mode, count, index_type, reinterpret_cast<void*>(first * index_size));
+	glBindVertexArray(0);
+}
+
+//==============================================================================
+
+size_t Drawable::GetVertexSize(size_t count, bool normals, bool uvs, bool tangents, VertexFormat::Position format) noexcept
+{
+	return count * (VertexFormat::GetPositionSize(format) + (normals ? VertexFormat::NORMAL_SIZE : 0) + (uvs ? VertexFormat::TEXCOORD_SIZE : 0) +
+		(tangents ? VertexFormat::TANGENT_SIZE : 0));
+}
+
+//==============================================================================
+
+size_t Drawable::GetIndexSize(size_t count, size_t vertex_count) noexcept
+{
+	return count * (vertex_count <= 0x10000 ? sizeof(unsigned short) : sizeof(unsigned int));
+}
+
+//==============================================================================
+
+void Drawable::PackVertices(const std::vector<glm::vec3> &positions, const std::vector<glm::vec3> &normals,
+	const std::vector<glm::vec2> &uvs, const std::vector<glm::vec4> &tangents, VertexFormat::Position format, unsigned char *target) noexcept
+{
+	const auto count = positions.size();
+
+	glm::vec3 low(0.0f);
+	glm::vec3 high(0.0f);
+	if (count > 0)
+	{
+		low = high = positions[0];
+	}
+
+	radius = 0.0f;
+	for (const auto &position : positions)
+	{
+		low  = glm::min(low,  position);
+		high = glm::max(high, position);
+		radius = glm::max(radius, glm::length(position));
+	}
+
+	// snorm positions span the bounds with the largest half extent on every axis
+	const auto center = (low + high) * 0.5f;
+	const auto extent = glm::max(glm::max(high.x - center.x, high.y - center.y), high.z - center.z);
+	const auto scale  = extent > 0.0f ? extent : 1.0f;
+
+	const auto quantized = format == VertexFormat::Position::SNORM16;
+	position_decode = quantized ? glm::scale(glm::translate(glm::mat4(1.0f), center), glm::vec3(scale)) : glm::mat4(1.0f);
+
+	const auto position_size   = VertexFormat::GetPositionSize(format);
+	const auto normal_offset   = count * position_size;
+	const auto texcoord_offset = normal_offset + (normals.empty() ? 0 : count * VertexFormat::NORMAL_SIZE);
+	const auto tangent_offset  = texcoord_offset + (uvs.empty() ? 0 : count * VertexFormat::TEXCOORD_SIZE);
+
+	for (size_t i = 0; i < count; i++)
+	{
+		if (quantized)
+		{
+			const auto packed = VertexFormat::EncodePosition((positions[i] - center) / scale);
+			std::memcpy(&target[i * position_size], &packed, sizeof(packed));
+		}
+		else
+		{
+			std::memcpy(&target[i * position_size], &positions[i], sizeof(glm::vec3));
+		}
+
+		if (!normals.empty())
+		{
+			const auto packed = VertexFormat::EncodeNormal(normals[i]);
+			std::memcpy(&target[normal_offset + i * VertexFormat::NORMAL_SIZE], &packed, sizeof(packed));
+		}
+
+		if (!uvs.empty())
+		{
+			const auto packed = VertexFormat::EncodeTexCoord(uvs[i]);
+			std::memcpy(&target[texcoord_offset + i * VertexFormat::TEXCOORD_SIZE], &packed, sizeof(packed));
+		}
+
+		if (!tangents.empty())
+		{
+			const auto packed = VertexFormat::EncodeTangent(tangents[i]);
+			std::memcpy(&target[tangent_offset + i * VertexFormat::TANGENT_SIZE], &packed, sizeof(packed));
+		}
+	}
+}
+
+//==============================================================================
+
+void Drawable::PackIndices(const std::vector<unsigned int> &indices, unsigned int mode, size_t vertex_count, unsigned char *target) noexcept
+{
+	this->mode  = mode;
+	index_count = static_cast<unsigned int>(indices.size());
+	statistics  = MeshOptimizer::Analyze(mode == GL_TRIANGLE_STRIP ? MeshOptimizer::StripToList(indices) : indices, vertex_count);
+
+	if (vertex_count <= 0x10000)
+	{
+		index_type = GL_UNSIGNED_SHORT;
+		for (size_t i = 0; i < indices.size(); i++)
+		{
+			const auto index = static_cast<unsigned short>(indices[i]);
+			std::memcpy(&target[i * sizeof(index)], &index, sizeof(index));
+		}
+	}
+	else
+	{
+		index_type = GL_UNSIGNED_INT;
+		std::memcpy(target, indices.data(), indices.size() * sizeof(unsigned int));
+	}
+}
+
+//==============================================================================
+
+void Drawable::PackLevels(const std::vector<std::vector<unsigned int>> &indices, const std::vector<float> &errors, unsigned int mode, size_t vertex_count, unsigned char *target) noexcept
+{
+	levels.clear();
+	level = 0;
+
+	std::vector<unsigned int> all;
+	for (size_t i = 0; i < indices.size() && i < MAX_LEVELS; i++)
+	{
+		levels.push_back({ static_cast<unsigned int>(all.size()), static_cast<unsigned int>(indices[i].size()), i < errors.size() ? errors[i] : 0.0f });
+		all.insert(all.end(), indices[i].begin(), indices[i].end());
+	}
+
+	PackIndices(all, mode, vertex_count, target);
+
+	if (!indices.empty())
+	{
+		statistics = MeshOptimizer::Analyze(mode == GL_TRIANGLE_STRIP ? MeshOptimizer::StripToList(indices[0]) : indices[0], vertex_count);
+	}
+}
+
+//==============================================================================
+
+void Drawable::SetLayout(size_t count, bool normals, bool uvs, bool tangents, VertexFormat::Position format) noexcept
+{
+	const auto quantized       = format == VertexFormat::Position::SNORM16;
+	const auto position_size   = VertexFormat::GetPositionSize(format);
+	const auto normal_offset   = count * position_size;
+	const auto texcoord_offset = normal_offset + (normals ? count * VertexFormat::NORMAL_SIZE : 0);
+	const auto tangent_offset  = texcoord_offset + (uvs ? count * VertexFormat::TEXCOORD_SIZE : 0);
+
+	glBindVertexArray(VAO);
+	glBindBuffer(GL_ARRAY_BUFFER, VBO);
+	vertex_memory = GetVertexSize(count, normals, uvs, tangents, format);
+
+	// snorm decodes as c / 32767 since GL 4.2, so -1, 0 and 1 stay exact
+	glEnableVertexAttribArray(VertexFormat::POSITION);
+	if (quantized)
+	{
+		glVertexAttribPointer(VertexFormat::POSITION, 3, GL_SHORT, GL_TRUE, position_size, (void*)0);
+	}
+	else
+	{
+		glVertexAttribPointer(VertexFormat::POSITION, 3, GL_FLOAT, GL_FALSE, position_size, (void*)0);
+	}
+
+	if (normals)
+	{
+		glEnableVertexAttribArray(VertexFormat::NORMAL);
+		glVertexAttribPointer(VertexFormat::NORMAL, 2, GL_SHORT, GL_TRUE, VertexFormat::NORMAL_SIZE, (void*)normal_offset);
+	}
+
+	if (uvs)
+	{
+		glEnableVertexAttribArray(VertexFormat::TEXCOORD);
+		glVertexAttribPointer(VertexFormat::TEXCOORD, 2, GL_HALF_FLOAT, GL_FALSE, VertexFormat::TEXCOORD_SIZE, (void*)texcoord_offset);
+	}
+
+	// the 2 bit w decodes to -1, 0 or 1, the same rule as above
+	if (tangents)
+	{
+		glEnableVertexAttribArray(VertexFormat::TANGENT);
+		glVertexAttribPointer(VertexFormat::TANGENT, 4, GL_INT_2_10_10_10_REV, GL_TRUE, VertexFormat::TANGENT_SIZE, (void*)tangent_offset);
+	}
+
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glBindVertexArray(0);
 }
 
 //==============================================================================
@@ -39,6 +310,100 @@ void Drawable::SetModel(const glm::mat4 &model) noexcept
 
 //==============================================================================
 
+const glm::mat4 &Drawable::GetPositionDecode() const noexcept
+{
+	return position_decode;
+}
+
+//==============================================================================
+
+glm::vec4 Drawable::GetBoundingSphere() const noexcept
+{
+	return GetBoundingSphere(model, radius);
+}
+
+//==============================================================================
+
+glm::vec4 Drawable::GetBoundingSphere(const glm::mat4 &model, float radius) noexcept
+{
+	const auto scale = glm::max(glm::length(glm::vec3(model[0])),
+		glm::max(glm::length(glm::vec3(model[1])), glm::length(glm::vec3(model[2]))));
+
+	return glm::vec4(glm::vec3(model[3]), radius * scale);
+}
+
+//==============================================================================
+
+float Drawable::GetRadius() const noexcept
+{
+	return radius;
+}
+
+//==============================================================================
+
+void Drawable::SelectLevel(const glm::vec3 &camera, float pixel_scale, float threshold) noexcept
+{
+	if (levels.size() < 2)
+	{
+		return;
+	}
+
+	// the error of a level as seen from the nearest point of the bounds
+	const auto bounds = GetBoundingSphere();
+	const auto scale = glm::max(glm::length(glm::vec3(model[0])),
+		glm::max(glm::length(glm::vec3(model[1])), glm::length(glm::vec3(model[2]))));
+	const auto distance = glm::max(glm::length(camera - glm::vec3(bounds)) - bounds.w, 1e-3f);
+	const auto pixels = scale * pixel_scale / distance;
+
+	while (level > 0 && levels[level].error * pixels > threshold)
+	{
+		level--;
+	}
+
+	while (level + 1 < levels.size() && levels[level + 1].error * pixels <= threshold * LEVEL_HYSTERESIS)
+	{
+		level++;
+	}
+}
+
+//==============================================================================
+
+unsigned int Drawable::GetLevel() const noexcept
+{
+	return level;
+}
+
+//==============================================================================
+
+unsigned int Drawable::GetLevelCount() const noexcept
+{
+	return levels.empty() ? 1 : static_cast<unsigned int>(levels.size());
+}
+
+//==============================================================================
+
+unsigned int Drawable::GetTriangleCount() const noexcept
+{
+	const auto count = levels.empty() ? index_count : levels[level].count;
+	return mode == GL_TRIANGLE_STRIP ? (count >= 3 ? count - 2 : 0) : count / 3;
+}
+
+//==============================================================================
+
+const MeshOptimizer::Statistics &Drawable::GetStatistics() const noexcept
+{
+	return statistics;
+}
+
+//==============================================================================
+
+size_t Drawable::GetMemorySize() const noexcept
+{
+	return vertex_memory + index_memory;
+}
+
+//==============================================================================
+
 Material *Drawable::GetMaterial() const noexcept
 {
 	return material;
@@ -3,8 +3,14 @@
 
 //==============================================================================
 
+#include <cstddef>
+#include <vector>
+
 #include <glm/glm.hpp>
 
+#include "MeshOptimizer.h"
+#include "VertexFormat.h"
+
 //==============================================================================
 
 class Material;
@@ -13,11 +19,72 @@ class Material;
 
 class Drawable
 {
+public:
+	// levels of detail past this are not kept
+	static const unsigned int MAX_LEVELS = 8;
+
+	// a coarser level is only taken once its error is this fraction of the
+	// threshold, so an object at the boundary does not switch every frame
+	static const float LEVEL_HYSTERESIS;
+
+protected:
+	// a range of the index buffer; error is how far it strays from the finest
+	// level, in the units of the positions as they were given
+	struct Level
+	{
+		unsigned int first;
+		unsigned int count;
+		float error;
+	};
+
 protected:
 	unsigned int VAO;
 	unsigned int VBO;
+	unsigned int EBO;
 	Material *material;
 	glm::mat4 model;
+	glm::mat4 position_decode;
+	float radius;
+
+	unsigned int index_count;
+	unsigned int index_type;
+	unsigned int mode;
+	MeshOptimizer::Statistics statistics;
+	size_t vertex_memory;
+	size_t index_memory;
+
+	// finest first, all in the one index buffer; empty for a single level
+	std::vector<Level> levels;
+	unsigned int level;
+
+protected:
+	// one stream per attribute given, back to back in VBO; also fits radius;
+	// tangents carry the sign of the bitangent in w, see MeshOptimizer::GenerateTangents()
+	void SetVertices(const std::vector<glm::vec3> &positions, const std::vector<glm::vec3> &normals,
+		const std::vector<glm::vec2> &uvs, const std::vector<glm::vec4> &tangents, VertexFormat::Position format) noexcept;
+
+	// 16 bit when the vertices allow it; the statistics are of the order given
+	void SetIndices(const std::vector<unsigned int> &indices, unsigned int mode, size_t vertex_count) noexcept;
+
+	// every level back to back, finest first, with one error each; the
+	// statistics are of the finest level
+	void SetLevels(const std::vector<std::vector<unsigned int>> &indices, const std::vector<float> &errors, unsigned int mode, size_t vertex_count) noexcept;
+
+	// the selected level
+	void DrawElements() const noexcept;
+
+	// the two halves of SetVertices() and SetIndices(): the packing makes no GL
+	// calls, so it may fill a mapped buffer on another thread, and the layout
+	// then describes the filled buffers to the VAO
+	static size_t GetVertexSize(size_t count, bool normals, bool uvs, bool tangents, VertexFormat::Position format) noexcept;
+	static size_t GetIndexSize(size_t count, size_t vertex_count) noexcept;
+
+	void PackVertices(const std::vector<glm::vec3> &positions, const std::vector<glm::vec3> &normals,
+		const std::vector<glm::vec2> &uvs, const std::vector<glm::vec4> &tangents, VertexFormat::Position format, unsigned char *target) noexcept;
+	void PackIndices(const std::vector<unsigned int> &indices, unsigned int mode, size_t vertex_count, unsigned char *target) noexcept;
+	void PackLevels(const std::vector<std::vector<unsigned int>> &indices, const std::vector<float> &errors, unsigned int mode, size_t vertex_count, unsigned char *target) noexcept;
+
+	void SetLayout(size_t count, bool normals, bool uvs, bool tangents, VertexFormat::Position format) noexcept;
 
 public:
 	Drawable() noexcept;
@@ -28,6 +95,29 @@ public:
 	const glm::mat4 &GetModel() const     noexcept;
 	void SetModel(const glm::mat4 &model) noexcept;
 
+	// from quantized positions back to the mesh's own space, applied before the model;
+	// a uniform scale, so the normal matrix of the product stays valid
+	const glm::mat4 &GetPositionDecode() const noexcept;
+
+	glm::vec4 GetBoundingSphere() const noexcept;
+	// the same for bounds of radius placed by model
+	static glm::vec4 GetBoundingSphere(const glm::mat4 &model, float radius) noexcept;
+
+	// the bounds around the origin of the object's own space, before the model
+	float GetRadius() const noexcept;
+
+	// the coarsest level whose error projects to at most threshold pixels, seen
+	// from camera; pixel_scale is the pixels one unit covers at distance 1,
+	// e.g. projection[1][1] * height / 2
+	void SelectLevel(const glm::vec3 &camera, float pixel_scale, float threshold) noexcept;
+	unsigned int GetLevel() const      noexcept;
+	unsigned int GetLevelCount() const noexcept;
+	unsigned int GetTriangleCount() const noexcept;
+
+	// post transform cache behaviour of the index order, see MeshOptimizer
+	const MeshOptimizer::Statistics &GetStatistics() const noexcept;
+	size_t GetMemorySize() const noexcept;
+
 	Material *GetMaterial() const        noexcept;
 	void SetMaterial(Material *material) noexcept;
 };
@@ -0,0 +1,559 @@
+
+#include "Environment.h"
+
+#include "AssetPack.h"
+#include "Cubemap.h"
+#include "OctahedralMap.h"
+#include "Scene.h"
+#include "Texture.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+#include <glm/gtc/packing.hpp>
+
+#include "GLAD/glad.h"
+
+//==============================================================================
+
+void Environment::Load() noexcept
+{
+	// runs on the loader thread: CPU work only, no GL calls
+	const auto entry = pack ? pack->Find(path) : nullptr;
+	if (entry && entry->type == AssetPack::Type::HDR_TEXTURE &&
+		static_cast<int>(entry->width) <= max_texture_size && static_cast<int>(entry->height) <= max_texture_size)
+	{
+		// cooked bottom to top like a flipped HDRImage, nothing to decode
+		pixels = reinterpret_cast<const unsigned short *>(pack->GetData(*entry));
+		width  = entry->width;
+		height = entry->height;
+	}
+	else if (image.Open(path))
+	{
+		const auto bytes = 3 * sizeof(unsigned short) * image.GetWidth() * image.GetHeight();
+
+		streaming = image.GetWidth() > max_texture_size || image.GetHeight() > max_texture_size || bytes > STREAM_SIZE;
+
+		if (streaming)
+		{
+			// copied once, the GL thread must not read the image while the
+			// loader thread decodes into it
+			width  = image.GetWidth();
+			height = image.GetHeight();
+
+			DecodeBand();
+		}
+		else if (image.ReadBand(image.GetHeight()))
+		{
+			pixels = image.GetPixels();
+			width  = image.GetWidth();
+			height = image.GetHeight();
+		}
+	}
+
+	if (pixels)
+	{
+		ProjectSH(pixels, width, height, 0, height, radiance_sh);
+
+		std::copy(radiance_sh, radiance_sh + 9, sh);
+		ConvolveSH(sh);
+	}
+
+	loaded = true;
+}
+
+//==============================================================================
+
+void Environment::LoadBand() noexcept
+{
+	// runs on the loader thread while the GL thread uploads the band before
+	DecodeBand();
+
+	loaded = true;
+}
+
+//==============================================================================
+
+void Environment::DecodeBand() noexcept
+{
+	const auto band_rows = static_cast<int>(BAND_SIZE / (3 * sizeof(unsigned short) * width));
+	if (!image.ReadBand(glm::clamp(band_rows, 1, max_texture_size - 1)))
+	{
+		next_band.rows = 0;
+		return;
+	}
+
+	// a copy, the image keeps its band for the overlap with the next one
+	next_band.first = image.GetFirstRow();
+	next_band.rows  = image.GetRows();
+	next_band.pixels.assign(image.GetPixels(), image.GetPixels() + 3 * static_cast<size_t>(width) * next_band.rows);
+
+	// the band is flipped, its rows run upwards from row bottom of the map;
+	// a band after the first repeats its top row from the previous band
+	const auto bottom = height - next_band.first - next_band.rows;
+	ProjectSH(next_band.pixels.data(), width, height, bottom, next_band.first > 0 ? next_band.rows - 1 : next_band.rows, radiance_sh);
+}
+
+//==============================================================================
+
+void Environment::ConvertBand(const Scene &scene) noexcept
+{
+	// width and height rather than the image, which the loader thread owns
+	const auto first  = band.first;
+	const auto rows   = band.rows;
+	const auto bottom = height - first - rows;
+	const auto pixels = band.pixels.data();
+
+	// every map texel is owned by one tile, neighbouring tiles overlap by
+	// a texel so that filtering across their edges matches the whole map
+	const auto min_y = bottom == 0 ? -1.0f : bottom + 0.5f;
+	const auto max_y = first  == 0 ? height + 1.0f : bottom + rows - 0.5f;
+
+	const auto tile_width = std::min(width, max_texture_size);
+
+	Texture tile;
+	for (auto x = 0;; x += tile_width - 1)
+	{
+		const auto w = std::min(tile_width, width - x);
+		tile.LoadHDR(pixels + 3 * x, w, rows, HDRFormat::RGB16F, width);
+
+		const auto min_x = x == 0 ? -1.0f : x + 0.5f;
+		const auto max_x = x + w == width ? width + 1.0f : x + w - 0.5f;
+
+		scene.ConvertEquirectangular(&tile, glm::vec2(width, height),
+			glm::vec4(x, bottom, w, rows), glm::vec4(min_x, min_y, max_x, max_y),
+			env_cubemap, quality.environment_size);
+
+		if (x + w == width)
+		{
+			break;
+		}
+	}
+}
+
+//==============================================================================
+
+void Environment::ProjectSH(const unsigned short *pixels, int width, int height, int first, int rows, glm::vec3 sh[9]) noexcept
+{
+	const auto PI = 3.14159265359f;
+
+	// a sparse grid is plenty for nine coefficients, aligned to the whole
+	// map so that bands add up to the same sum
+	const auto step = std::max(1, height / 128);
+
+	for (int y = (first + step - 1) / step * step; y < first + rows; y += step)
+	{
+		// same mapping as rect2cubemap.fs: v = asin(dir.y) / PI + 0.5
+		const auto latitude = ((static_cast<float>(y) + 0.5f) / static_cast<float>(height) - 0.5f) * PI;
+		const auto solid_angle = (2.0f * PI * step / width) * (PI * step / height) * std::cos(latitude);
+
+		for (int x = 0; x < width; x += step)
+		{
+			const auto longitude = ((static_cast<float>(x) + 0.5f) / static_cast<float>(width) - 0.5f) * 2.0f * PI;
+
+			const glm::vec3 dir(
+				std::cos(latitude) * std::cos(longitude),
+				std::sin(latitude),
+				std::cos(latitude) * std::sin(longitude));
+
+			const auto texel = &pixels[3 * (static_cast<size_t>(y - first) * width + x)];
+			AddSH(sh, dir, glm::vec3(glm::unpackHalf1x16(texel[0]), glm::unpackHalf1x16(texel[1]), glm::unpackHalf1x16(texel[2])) * solid_angle);
+		}
+	}
+}
+
+//==============================================================================
+
+void Environment::AddSH(glm::vec3 sh[9], const glm::vec3 &dir, const glm::vec3 &radiance) noexcept
+{
+	sh[0] += radiance * 0.282095f;
+	sh[1] += radiance * 0.488603f * dir.y;
+	sh[2] += radiance * 0.488603f * dir.z;
+	sh[3] += radiance * 0.488603f * dir.x;
+	sh[4] += radiance * 1.092548f * dir.x * dir.y;
+	sh[5] += radiance * 1.092548f * dir.y * dir.z;
+	sh[6] += radiance * 0.315392f * (3.0f * dir.z * dir.z - 1.0f);
+	sh[7] += radiance * 1.092548f * dir.x * dir.z;
+	sh[8] += radiance * 0.546274f * (dir.x * dir.x - dir.y * dir.y);
+}
+
+//==============================================================================
+
+void Environment::ConvolveSH(glm::vec3 sh[9]) noexcept
+{
+	// cosine lobe convolution, divided by PI to match irradiance.fs
+	const float bands[9] = { 1.0f, 2.0f / 3.0f, 2.0f / 3.0f, 2.0f / 3.0f, 0.25f, 0.25f, 0.25f, 0.25f, 0.25f };
+	for (unsigned int i = 0; i < 9; i++)
+	{
+		sh[i] *= bands[i];
+	}
+}
+
+//==============================================================================
+
+glm::vec3 Environment::EvaluateSH(const glm::vec3 sh[9], const glm::vec3 &dir) noexcept
+{
+	// same basis as IrradianceSH() in pbr.fs
+	return glm::max(
+		sh[0] * 0.282095f +
+		sh[1] * 0.488603f * dir.y +
+		sh[2] * 0.488603f * dir.z +
+		sh[3] * 0.488603f * dir.x +
+		sh[4] * 1.092548f * dir.x * dir.y +
+		sh[5] * 1.092548f * dir.y * dir.z +
+		sh[6] * 0.315392f * (3.0f * dir.z * dir.z - 1.0f) +
+		sh[7] * 1.092548f * dir.x * dir.z +
+		sh[8] * 0.546274f * (dir.x * dir.x - dir.y * dir.y), glm::vec3(0.0f));
+}
+
+//==============================================================================
+
+Environment::Environment(const std::string &path, const IBLQuality &quality, const AssetPack *pack) noexcept :
+	path(path),
+	loaded(false),
+	pack(pack),
+	pixels(nullptr),
+	width(0),
+	height(0),
+	streaming(false),
+	max_texture_size(0),
+	band{ {}, 0, 0 },
+	next_band{ {}, 0, 0 },
+	stage(Stage::LOADING),
+	prefilter_mip(0),
+	prefilter_first(0),
+	prefilter_last(quality.prefilter_mips - 1),
+	quality(quality),
+	env_cubemap(nullptr),
+	irradiance_map(nullptr),
+	prefilter_map(nullptr),
+	irradiance_oct(nullptr),
+	prefilter_oct(nullptr)
+{
+	for (unsigned int i = 0; i < 9; i++)
+	{
+		sh[i] = glm::vec3(0.0f);
+		radiance_sh[i] = glm::vec3(0.0f);
+	}
+
+	glGetIntegerv(GL_MAX_TEXTURE_SIZE, &max_texture_size);
+
+	loader = std::thread(&Environment::Load, this);
+}
+
+//==============================================================================
+
+Environment::~Environment() noexcept
+{
+	if (loader.joinable())
+	{
+		loader.join();
+	}
+
+	delete env_cubemap;
+	delete irradiance_map;
+	delete prefilter_map;
+	delete irradiance_oct;
+	delete prefilter_oct;
+}
+
+//==============================================================================
+
+Environment::Stage Environment::GetStage() const noexcept
+{
+	return stage;
+}
+
+//==============================================================================
+
+bool Environment::IsReady() const noexcept
+{
+	return stage == Stage::READY;
+}
+
+//==============================================================================
+
+const glm::vec3 *Environment::GetSH() const noexcept
+{
+	// a streamed map is projected band by band during the cubemap stage
+	return stage == Stage::LOADING || (streaming && stage == Stage::CUBEMAP) ? nullptr : sh;
+}
+
+//==============================================================================
+
+const glm::vec3 *Environment::GetRadianceSH() const noexcept
+{
+	return stage == Stage::LOADING || (streaming && stage == Stage::CUBEMAP) ? nullptr : radiance_sh;
+}
+
+//==============================================================================
+
+const Cubemap *Environment::GetEnvironmentMap() const noexcept
+{
+	return stage > Stage::CUBEMAP ? env_cubemap : nullptr;
+}
+
+//==============================================================================
+
+const Cubemap *Environment::GetIrradianceMap() const noexcept
+{
+	return stage > Stage::IRRADIANCE ? irradiance_map : nullptr;
+}
+
+//==============================================================================
+
+const Cubemap *Environment::GetPrefilterMap() const noexcept
+{
+	return stage > Stage::PREFILTER ? prefilter_map : nullptr;
+}
+
+//==============================================================================
+
+bool Environment::IsOctahedral() const noexcept
+{
+	return quality.octahedral;
+}
+
+//==============================================================================
+
+const OctahedralMap *Environment::GetIrradianceOctahedral() const noexcept
+{
+	return stage > Stage::IRRADIANCE ? irradiance_oct : nullptr;
+}
+
+//==============================================================================
+
+const OctahedralMap *Environment::GetPrefilterOctahedral() const noexcept
+{
+	return stage > Stage::PREFILTER ? prefilter_oct : nullptr;
+}
+
+//==============================================================================
+
+unsigned int Environment::GetSize() const noexcept
+{
+	return quality.environment_size;
+}
+
+//==============================================================================
+
+glm::vec2 Environment::GetPrefilterRange() const noexcept
+{
+	return glm::vec2(prefilter_first, prefilter_last);
+}
+
+//==============================================================================
+
+size_t Environment::GetMemorySize() const noexcept
+{
+	size_t bytes = 0;
+	// the loader thread owns the image and the next band while it runs
+	if (stage != Stage::LOADING && loaded)
+	{
+		bytes += image.GetMemorySize() + (band.pixels.size() + next_band.pixels.size()) * sizeof(unsigned short);
+	}
+
+	if (env_cubemap)
+	{
+		const size_t size = quality.environment_size;
+		bytes += 6 * size * size * GetTexelSize(env_cubemap->GetFormat()) * 4 / 3;
+	}
+
+	if (irradiance_map)
+	{
+		const size_t size = quality.irradiance_size;
+		bytes += 6 * size * size * GetTexelSize(irradiance_map->GetFormat());
+	}
+
+	if (prefilter_map)
+	{
+		for (auto mip = prefilter_first; mip <= prefilter_last; mip++)
+		{
+			const size_t size = quality.prefilter_size >> mip;
+			bytes += 6 * size * size * GetTexelSize(prefilter_map->GetFormat());
+		}
+	}
+
+	// octahedral maps are twice the face size on a side
+	if (irradiance_oct)
+	{
+		const size_t size = 2 * quality.irradiance_size;
+		bytes += size * size * GetTexelSize(irradiance_oct->GetFormat());
+	}
+
+	if (prefilter_oct)
+	{
+		for (auto mip = prefilter_first; mip <= prefilter_last; mip++)
+		{
+			const size_t size = 2 * quality.prefilter_size >> mip;
+			bytes += size * size * GetTexelSize(prefilter_oct->GetFormat());
+		}
+	}
+
+	return bytes;
+}
+
+//==============================================================================
+
+void Environment::Update(const Scene &scene) noexcept
+{
+	switch (stage)
+	{
+	case Stage::LOADING:
+		if (loaded)
+		{
+			loader.join();
+			stage = pixels || streaming ? Stage::CUBEMAP : Stage::READY;
+		}
+		break;
+
+	case Stage::CUBEMAP:
+		{
+			const auto size = quality.environment_size;
+
+			if (!env_cubemap)
+			{
+				env_cubemap = new Cubemap(size, size, true, GetRenderableFormat(quality.format));
+			}
+
+			if (streaming)
+			{
+				// at most one band per frame; one the loader thread has not
+				// decoded yet is uploaded on a later frame instead of waited for
+				if (!loaded)
+				{
+					break;
+				}
+
+				if (loader.joinable())
+				{
+					loader.join();
+				}
+
+				std::swap(band, next_band);
+				if (band.rows == 0)
+				{
+					delete env_cubemap;
+					env_cubemap = nullptr;
+
+					stage = Stage::READY;
+					break;
+				}
+
+				// the next band is decoded while this one is uploaded
+				const auto complete = image.IsComplete();
+				if (!complete)
+				{
+					loaded = false;
+					loader = std::thread(&Environment::LoadBand, this);
+				}
+
+				ConvertBand(scene);
+
+				if (!complete)
+				{
+					break;
+				}
+
+				std::copy(radiance_sh, radiance_sh + 9, sh);
+				ConvolveSH(sh);
+			}
+			else
+			{
+				Texture hdr_texture;
+				hdr_texture.LoadHDR(pixels, width, height);
+
+				scene.ConvertEquirectangular(&hdr_texture, env_cubemap, size);
+			}
+
+			image.Free();
+			pixels = nullptr;
+
+			std::vector<unsigned short>().swap(band.pixels);
+			std::vector<unsigned short>().swap(next_band.pixels);
+
+			env_cubemap->GenerateMipmap();
+
+			stage = Stage::IRRADIANCE;
+		}
+		break;
+
+	case Stage::IRRADIANCE:
+		{
+			if (quality.octahedral)
+			{
+				irradiance_oct = new OctahedralMap(2 * quality.irradiance_size, 0, 0, GetRenderableFormat(quality.format));
+				scene.CalculateIrradiance(env_cubemap, irradiance_oct, 2 * quality.irradiance_size, quality.irradiance_delta);
+			}
+			else
+			{
+				irradiance_map = new Cubemap(quality.irradiance_size, quality.irradiance_size, false, GetRenderableFormat(quality.format));
+				scene.CalculateIrradiance(env_cubemap, irradiance_map, quality.irradiance_size, quality.irradiance_delta);
+			}
+
+			if (quality.lazy)
+			{
+				// only the mips that the materials' roughness can reach
+				const auto range = scene.GetRoughnessRange() * quality.GetMaxReflectionLOD();
+				prefilter_first = static_cast<unsigned int>(std::floor(range.x));
+				prefilter_last  = static_cast<unsigned int>(std::ceil(range.y));
+			}
+
+			prefilter_mip = prefilter_first;
+			if (quality.octahedral)
+			{
+				prefilter_oct = new OctahedralMap(2 * quality.prefilter_size, prefilter_first, prefilter_last, GetRenderableFormat(quality.format));
+			}
+			else
+			{
+				prefilter_map = new Cubemap(quality.prefilter_size, prefilter_first, prefilter_last, GetRenderableFormat(quality.format));
+			}
+
+			stage = Stage::PREFILTER;
+		}
+		break;
+
+	case Stage::PREFILTER:
+		if (quality.octahedral)
+		{
+			scene.PrefilterEnvironmentMap(env_cubemap, quality.environment_size, prefilter_oct, 2 * quality.prefilter_size, prefilter_mip, quality.prefilter_mips, quality.sample_count);
+		}
+		else
+		{
+			scene.PrefilterEnvironmentMap(env_cubemap, quality.environment_size, prefilter_map, quality.prefilter_size, prefilter_mip, quality.prefilter_mips, quality.sample_count);
+		}
+
+		if (prefilter_mip == prefilter_last)
+		{
+			stage = quality.format != GetRenderableFormat(quality.format) ? Stage::CONVERT : Stage::READY;
+		}
+		else
+		{
+			prefilter_mip++;
+		}
+		break;
+
+	case Stage::CONVERT:
+		// formats that cannot be rendered to are stored once the bake is done
+		env_cubemap->Convert(quality.format);
+		if (quality.octahedral)
+		{
+			irradiance_oct->Convert(quality.format);
+			prefilter_oct->Convert(quality.format);
+		}
+		else
+		{
+			irradiance_map->Convert(quality.format);
+			prefilter_map->Convert(quality.format);
+		}
+
+		stage = Stage::READY;
+		break;
+
+	case Stage::READY:
+		break;
+	}
+}
+
+//==============================================================================
@@ -0,0 +1,125 @@
+
+#pragma once
+
+//==============================================================================
+
+#include <atomic>
+#include <cstddef>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "HDRImage.h"
+#include "IBLQuality.h"
+
+//==============================================================================
+
+class AssetPack;
+class Cubemap;
+class OctahedralMap;
+class Scene;
+class Texture;
+
+//==============================================================================
+
+class Environment
+{
+public:
+	enum class Stage { LOADING, CUBEMAP, IRRADIANCE, PREFILTER, CONVERT, READY };
+
+private:
+	// larger maps are streamed in bands instead of decoded whole
+	static const size_t STREAM_SIZE = 64 << 20;
+	static const size_t BAND_SIZE   = 8 << 20;
+
+	// decoded rows of a streamed map, flipped like HDRImage::GetPixels()
+	struct Band
+	{
+		std::vector<unsigned short> pixels;
+		int first; // as HDRImage::GetFirstRow()
+		int rows;  // 0 when the band could not be read
+	};
+
+	std::string path;
+	std::thread loader;
+	std::atomic<bool> loaded;
+
+	// a cooked map is used straight from the mapped pack, otherwise it is decoded
+	const AssetPack *pack;
+	HDRImage image;
+	const unsigned short *pixels;
+	int width;
+	int height;
+
+	bool streaming;
+	int max_texture_size;
+
+	// the loader thread decodes next_band while the GL thread uploads band
+	Band band;
+	Band next_band;
+	glm::vec3 sh[9];
+	glm::vec3 radiance_sh[9];
+
+	Stage stage;
+	unsigned int prefilter_mip;
+	unsigned int prefilter_first;
+	unsigned int prefilter_last;
+
+	IBLQuality quality;
+
+	Cubemap *env_cubemap;
+	Cubemap *irradiance_map;
+	Cubemap *prefilter_map;
+
+	// instead of the two above when the quality asks for octahedral maps
+	OctahedralMap *irradiance_oct;
+	OctahedralMap *prefilter_oct;
+
+private:
+	void Load() noexcept;
+	void LoadBand() noexcept;
+
+	// on the loader thread, the file read and RLE decode of the next band into
+	// next_band; the GL thread only uploads it, see ConvertBand()
+	void DecodeBand() noexcept;
+	void ConvertBand(const Scene &scene) noexcept;
+
+	// adds rows first .. first + rows - 1 of a bottom to top map, pixels points at row first
+	static void ProjectSH(const unsigned short *pixels, int width, int height, int first, int rows, glm::vec3 sh[9]) noexcept;
+
+public:
+	Environment(const std::string &path, const IBLQuality &quality, const AssetPack *pack = nullptr) noexcept;
+	~Environment() noexcept;
+
+	// radiance over a solid angle into SH9, then the irradiance convolution
+	static void AddSH(glm::vec3 sh[9], const glm::vec3 &dir, const glm::vec3 &radiance) noexcept;
+	static void ConvolveSH(glm::vec3 sh[9]) noexcept;
+	static glm::vec3 EvaluateSH(const glm::vec3 sh[9], const glm::vec3 &dir) noexcept;
+
+	Stage GetStage() const noexcept;
+	bool IsReady()   const noexcept;
+
+	const glm::vec3 *GetSH()         const noexcept;
+	const glm::vec3 *GetRadianceSH() const noexcept;
+
+	const Cubemap *GetEnvironmentMap() const noexcept;
+	const Cubemap *GetIrradianceMap()  const noexcept;
+	const Cubemap *GetPrefilterMap()   const noexcept;
+
+	bool IsOctahedral() const noexcept;
+
+	const OctahedralMap *GetIrradianceOctahedral() const noexcept;
+	const OctahedralMap *GetPrefilterOctahedral()  const noexcept;
+
+	unsigned int GetSize() const noexcept;
+
+	glm::vec2 GetPrefilterRange() const noexcept;
+
+	size_t GetMemorySize() const noexcept;
+
+	void Update(const Scene &scene) noexcept;
+};
+
+//==============================================================================
@@ -0,0 +1,219 @@
+
+#include "EnvironmentManager.h"
+
+#include "Environment.h"
+#include "Scene.h"
+
+//==============================================================================
+
+Environment *EnvironmentManager::Find(const std::string &name) const noexcept
+{
+	const auto it = environments.find(name);
+	if (it != environments.end())
+	{
+		return it->second.environment;
+	}
+
+	return nullptr;
+}
+
+//==============================================================================
+
+void EnvironmentManager::Touch(const std::string &name) noexcept
+{
+	environments[name].last_used = ++use_counter;
+}
+
+//==============================================================================
+
+void EnvironmentManager::Evict() noexcept
+{
+	// least recently used first, never one that is shown or still baking
+	while (GetMemorySize() > budget)
+	{
+		auto victim = environments.end();
+		for (auto it = environments.begin(); it != environments.end(); ++it)
+		{
+			if (it->first == target || it->first == current || it->first == previous || !it->second.environment->IsReady())
+			{
+				continue;
+			}
+
+			if (victim == environments.end() || it->second.last_used < victim->second.last_used)
+			{
+				victim = it;
+			}
+		}
+
+		if (victim == environments.end())
+		{
+			break;
+		}
+
+		delete victim->second.environment;
+		environments.erase(victim);
+	}
+}
+
+//==============================================================================
+
+EnvironmentManager::EnvironmentManager() noexcept :
+	use_counter(0),
+	budget(256 * 1024 * 1024),
+	pack(nullptr),
+	fade_duration(1.0f),
+	fade(0.0f)
+{
+}
+
+//==============================================================================
+
+EnvironmentManager::~EnvironmentManager() noexcept
+{
+	for (auto resident : environments)
+	{
+		delete resident.second.environment;
+	}
+}
+
+//==============================================================================
+
+void EnvironmentManager::SetBudget(size_t bytes) noexcept
+{
+	budget = bytes;
+}
+
+//==============================================================================
+
+void EnvironmentManager::SetFadeDuration(float seconds) noexcept
+{
+	fade_duration = seconds;
+}
+
+//==============================================================================
+
+void EnvironmentManager::SetAssetPack(const AssetPack *pack) noexcept
+{
+	this->pack = pack;
+}
+
+//==============================================================================
+
+void EnvironmentManager::Load(const std::string &name, const IBLQuality &quality) noexcept
+{
+	// resident environments are reused as they are, without a rebake
+	if (!Find(name))
+	{
+		environments[name].environment = new Environment(name, quality, pack);
+	}
+
+	Touch(name);
+}
+
+//==============================================================================
+
+void EnvironmentManager::Switch(const std::string &name, const IBLQuality &quality) noexcept
+{
+	Load(name, quality);
+	target = name;
+}
+
+//==============================================================================
+
+Environment *EnvironmentManager::GetCurrent() const noexcept
+{
+	return Find(current);
+}
+
+//==============================================================================
+
+Environment *EnvironmentManager::GetPrevious() const noexcept
+{
+	return Find(previous);
+}
+
+//==============================================================================
+
+float EnvironmentManager::GetFade() const noexcept
+{
+	return fade;
+}
+
+//==============================================================================
+
+size_t EnvironmentManager::GetMemorySize() const noexcept
+{
+	size_t bytes = 0;
+	for (auto &resident : environments)
+	{
+		bytes += resident.second.environment->GetMemorySize();
+	}
+
+	return bytes;
+}
+
+//==============================================================================
+
+void EnvironmentManager::Update(const Scene &scene) noexcept
+{
+	// one bake step per frame, the requested environment goes first
+	auto baking = Find(target);
+	if (!baking || baking->IsReady())
+	{
+		baking = nullptr;
+		for (auto &resident : environments)
+		{
+			if (!resident.second.environment->IsReady())
+			{
+				baking = resident.second.environment;
+				break;
+			}
+		}
+	}
+
+	if (baking)
+	{
+		baking->Update(scene);
+	}
+
+	if (target != current)
+	{
+		const auto shown = GetCurrent();
+		if (!shown || !shown->IsReady())
+		{
+			// nothing complete to fade from, the progressive fallbacks take over
+			previous.clear();
+			current = target;
+			fade = 0.0f;
+		}
+		else
+		if (Find(target)->IsReady() && !Find(target)->GetEnvironmentMap())
+		{
+			// failed to load, keep showing the current one
+			target = current;
+		}
+		else
+		if (Find(target)->IsReady())
+		{
+			previous = current;
+			current = target;
+			fade = 1.0f;
+			fade_start = std::chrono::steady_clock::now();
+		}
+	}
+
+	if (!previous.empty())
+	{
+		const std::chrono::duration<float> elapsed = std::chrono::steady_clock::now() - fade_start;
+		fade = fade_duration > 0.0f ? 1.0f - elapsed.count() / fade_duration : 0.0f;
+		if (fade <= 0.0f)
+		{
+			previous.clear();
+			fade = 0.0f;
+		}
+	}
+
+	Evict();
+}
+
+//==============================================================================
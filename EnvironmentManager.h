@@ -0,0 +1,70 @@
+
+#pragma once
+
+//==============================================================================
+
+#include <chrono>
+#include <cstddef>
+#include <map>
+#include <string>
+
+#include "IBLQuality.h"
+
+//==============================================================================
+
+class AssetPack;
+class Environment;
+class Scene;
+
+//==============================================================================
+
+class EnvironmentManager
+{
+private:
+	struct Resident
+	{
+		Environment *environment;
+		unsigned long long last_used;
+	};
+
+	std::map<std::string, Resident> environments;
+	unsigned long long use_counter;
+
+	size_t budget;
+	const AssetPack *pack;
+
+	std::string target;
+	std::string current;
+	std::string previous;
+
+	float fade_duration;
+	float fade;
+	std::chrono::steady_clock::time_point fade_start;
+
+private:
+	Environment *Find(const std::string &name) const noexcept;
+
+	void Touch(const std::string &name) noexcept;
+	void Evict() noexcept;
+
+public:
+	EnvironmentManager() noexcept;
+	~EnvironmentManager() noexcept;
+
+	void SetBudget(size_t bytes)          noexcept;
+	void SetFadeDuration(float seconds)   noexcept;
+	void SetAssetPack(const AssetPack *pack) noexcept;
+
+	void Load(const std::string &name, const IBLQuality &quality)   noexcept;
+	void Switch(const std::string &name, const IBLQuality &quality) noexcept;
+
+	Environment *GetCurrent()  const noexcept;
+	Environment *GetPrevious() const noexcept;
+	float GetFade()            const noexcept;
+
+	size_t GetMemorySize() const noexcept;
+
+	void Update(const Scene &scene) noexcept;
+};
+
+//==============================================================================
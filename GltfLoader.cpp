@@ -0,0 +1,1067 @@
+
+#include "GltfLoader.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include "stb_image.h"
+
+#include "GLAD/glad.h"
+
+#include "Material.h"
+#include "Mesh.h"
+#include "MeshOptimizer.h"
+#include "Texture.h"
+
+//==============================================================================
+
+const size_t GltfLoader::NONE;
+const uint32_t GltfLoader::CHUNK_JSON;
+const uint32_t GltfLoader::CHUNK_BIN;
+const unsigned int GltfLoader::MAX_DEPTH;
+
+//==============================================================================
+
+bool GltfLoader::ReadChunks(const unsigned char *&bin, size_t &bin_size) noexcept
+{
+	const auto data = file.GetData();
+	const auto size = file.GetSize();
+
+	uint32_t header[3] = { 0, 0, 0 };
+	if (size >= sizeof(header))
+	{
+		std::memcpy(header, data, sizeof(header));
+	}
+
+	if (size < sizeof(header) || std::memcmp(data, "glTF", 4) != 0 || header[1] != 2 || header[2] > size)
+	{
+		std::cout << "error: model " << name << " is no binary glTF 2.0 file" << std::endl;
+		return false;
+	}
+
+	// the JSON chunk comes first, the binary one is optional and unknown ones are skipped
+	auto json = false;
+	for (size_t offset = sizeof(header); offset + 8 <= header[2]; )
+	{
+		uint32_t chunk[2];
+		std::memcpy(chunk, data + offset, sizeof(chunk));
+		offset += sizeof(chunk);
+
+		if (chunk[0] > header[2] - offset)
+		{
+			std::cout << "error: model " << name << " is truncated" << std::endl;
+			return false;
+		}
+
+		const auto begin = reinterpret_cast<const char *>(data + offset);
+		if (!json)
+		{
+			if (chunk[1] != CHUNK_JSON || !document.Parse(begin, begin + chunk[0]))
+			{
+				std::cout << "error: model " << name << " has no valid JSON chunk" << std::endl;
+				return false;
+			}
+			json = true;
+		}
+		else
+		if (chunk[1] == CHUNK_BIN && !bin)
+		{
+			bin = data + offset;
+			bin_size = chunk[0];
+		}
+
+		offset += chunk[0];
+	}
+
+	const auto &version = document.Get("asset").Get("version").GetString();
+	if (!json || version.compare(0, 2, "2.") != 0)
+	{
+		std::cout << "error: model " << name << " is no glTF 2.0 model" << std::endl;
+		return false;
+	}
+
+	return true;
+}
+
+//==============================================================================
+
+bool GltfLoader::ReadBuffers(const unsigned char *bin, size_t bin_size) noexcept
+{
+	const auto &list = document.Get("buffers");
+	for (size_t i = 0; i < list.GetSize(); i++)
+	{
+		const auto &buffer = list.Get(i);
+		const auto length  = GetIndex(buffer.Get("byteLength"));
+
+		// the first buffer without a uri is the binary chunk, others are files next to the model
+		View view{ nullptr, 0, 0 };
+		if (!buffer.Has("uri"))
+		{
+			if (i == 0 && bin && length <= bin_size)
+			{
+				view.data = bin;
+				view.size = length;
+			}
+		}
+		else
+		{
+			const auto &uri = buffer.Get("uri").GetString();
+			if (uri.compare(0, 5, "data:") != 0)
+			{
+				auto mapped = new MappedFile;
+				external.push_back(mapped);
+
+				if (mapped->Open(directory + uri) && length <= mapped->GetSize())
+				{
+					view.data = mapped->GetData();
+					view.size = length;
+				}
+			}
+		}
+
+		if (!view.data)
+		{
+			std::cout << "error: model " << name << " buffer " << i << " cannot be read" << std::endl;
+			return false;
+		}
+
+		buffers.push_back(view);
+	}
+
+	return true;
+}
+
+//==============================================================================
+
+bool GltfLoader::ReadViews() noexcept
+{
+	const auto &list = document.Get("bufferViews");
+	for (size_t i = 0; i < list.GetSize(); i++)
+	{
+		const auto &view  = list.Get(i);
+		const auto buffer = GetIndex(view.Get("buffer"));
+		const auto offset = GetIndex(view.Get("byteOffset"), 0);
+		const auto length = GetIndex(view.Get("byteLength"));
+		const auto stride = GetIndex(view.Get("byteStride"), 0);
+
+		if (buffer >= buffers.size() || offset > buffers[buffer].size || length > buffers[buffer].size - offset || stride == NONE)
+		{
+			std::cout << "error: model " << name << " buffer view " << i << " is out of bounds" << std::endl;
+			return false;
+		}
+
+		views.push_back(View{ buffers[buffer].data + offset, length, stride });
+	}
+
+	return true;
+}
+
+//==============================================================================
+
+void GltfLoader::ReadAccessors() noexcept
+{
+	const auto &list = document.Get("accessors");
+	for (size_t i = 0; i < list.GetSize(); i++)
+	{
+		const auto &accessor = list.Get(i);
+		const auto &type     = accessor.Get("type").GetString();
+
+		Accessor result{ nullptr, GetIndex(accessor.Get("count")), 0,
+			static_cast<unsigned int>(GetIndex(accessor.Get("componentType"), 0)), 0,
+			accessor.Get("normalized").GetBoolean() };
+
+		result.components = type == "SCALAR" ? 1 : type == "VEC2" ? 2 : type == "VEC3" ? 3 : type == "VEC4" ? 4 : 0;
+
+		// data stays null for what cannot be read as is, e.g. sparse accessors;
+		// the primitives that use those are skipped
+		const auto view    = GetIndex(accessor.Get("bufferView"));
+		const auto offset  = GetIndex(accessor.Get("byteOffset"), 0);
+		const auto element = GetComponentSize(result.type) * result.components;
+
+		if (view < views.size() && element > 0 && result.count > 0 && result.count != NONE && !accessor.Has("sparse"))
+		{
+			const auto &range = views[view];
+			result.stride = range.stride ? range.stride : element;
+
+			if (offset <= range.size && element <= range.size - offset && (result.count - 1) <= (range.size - offset - element) / result.stride)
+			{
+				result.data = range.data + offset;
+			}
+		}
+
+		accessors.push_back(result);
+	}
+}
+
+//==============================================================================
+
+void GltfLoader::ReadImages() noexcept
+{
+	const auto &list = document.Get("images");
+	for (size_t i = 0; i < list.GetSize(); i++)
+	{
+		const auto &image = list.Get(i);
+		const auto view   = GetIndex(image.Get("bufferView"));
+
+		Image result{ nullptr, 0, std::string(), false, nullptr, 0, 0 };
+		if (view < views.size())
+		{
+			result.data = views[view].data;
+			result.size = views[view].size;
+		}
+		else
+		if (image.Has("uri") && image.Get("uri").GetString().compare(0, 5, "data:") != 0)
+		{
+			result.path = directory + image.Get("uri").GetString();
+		}
+
+		images.push_back(result);
+	}
+}
+
+//==============================================================================
+
+void GltfLoader::ReadMaterials() noexcept
+{
+	const auto &list = document.Get("materials");
+	for (size_t i = 0; i < list.GetSize(); i++)
+	{
+		AddMaterial(list.Get(i));
+	}
+}
+
+//==============================================================================
+
+void GltfLoader::ReadMeshes() noexcept
+{
+	const auto &list = document.Get("meshes");
+	mesh_primitives.resize(list.GetSize());
+
+	for (size_t i = 0; i < list.GetSize(); i++)
+	{
+		const auto &primitive_list = list.Get(i).Get("primitives");
+		for (size_t j = 0; j < primitive_list.GetSize(); j++)
+		{
+			const auto &primitive  = primitive_list.Get(j);
+			const auto &attributes = primitive.Get("attributes");
+			const auto mode        = GetIndex(primitive.Get("mode"), GL_TRIANGLES);
+
+			Primitive result;
+			result.position = GetIndex(attributes.Get("POSITION"));
+			result.normal   = GetIndex(attributes.Get("NORMAL"));
+			result.texcoord = GetIndex(attributes.Get("TEXCOORD_0"));
+			result.tangent  = GetIndex(attributes.Get("TANGENT"));
+			result.indices  = GetIndex(primitive.Get("indices"));
+			result.material = GetIndex(primitive.Get("material"));
+			result.strip    = mode == GL_TRIANGLE_STRIP;
+			result.failed   = false;
+
+			const auto position = result.position < accessors.size() ? &accessors[result.position] : nullptr;
+			const auto count    = position ? position->count : 0;
+
+			// optional attributes that cannot be used are left out, normals are then computed
+			if (result.normal >= accessors.size() || !accessors[result.normal].data ||
+				accessors[result.normal].components != 3 || accessors[result.normal].count != count)
+			{
+				result.normal = NONE;
+			}
+
+			if (result.texcoord >= accessors.size() || !accessors[result.texcoord].data ||
+				accessors[result.texcoord].components != 2 || accessors[result.texcoord].count != count)
+			{
+				result.texcoord = NONE;
+			}
+
+			// only of the given normals, otherwise generated along with the mesh
+			if (result.tangent >= accessors.size() || !accessors[result.tangent].data || result.normal == NONE || result.texcoord == NONE ||
+				accessors[result.tangent].components != 4 || accessors[result.tangent].count != count)
+			{
+				result.tangent = NONE;
+			}
+
+			if (result.material >= materials.size())
+			{
+				result.material = GetDefaultMaterial();
+			}
+
+			const auto indices = result.indices < accessors.size() ? &accessors[result.indices] : nullptr;
+			const auto valid   = position && position->data && position->components == 3 &&
+				(mode == GL_TRIANGLES || mode == GL_TRIANGLE_STRIP) &&
+				(result.indices == NONE || (indices && indices->data && indices->components == 1));
+
+			if (!valid)
+			{
+				std::cout << "error: model " << name << " mesh " << i << " primitive " << j << " cannot be drawn" << std::endl;
+				mesh_primitives[i].push_back(NONE);
+				continue;
+			}
+
+			mesh_primitives[i].push_back(primitives.size());
+			primitives.push_back(result);
+		}
+	}
+}
+
+//==============================================================================
+
+void GltfLoader::ReadNodes(const glm::mat4 &transform) noexcept
+{
+	const auto &nodes  = document.Get("nodes");
+	const auto &scenes = document.Get("scenes");
+
+	if (scenes.GetSize() > 0)
+	{
+		const auto scene = std::min(GetIndex(document.Get("scene"), 0), scenes.GetSize() - 1);
+		const auto &roots = scenes.Get(scene).Get("nodes");
+		for (size_t i = 0; i < roots.GetSize(); i++)
+		{
+			ReadNode(GetIndex(roots.Get(i)), transform, 0);
+		}
+
+		return;
+	}
+
+	// without scenes every node that is no child is a root
+	std::vector<bool> child(nodes.GetSize(), false);
+	for (size_t i = 0; i < nodes.GetSize(); i++)
+	{
+		const auto &children = nodes.Get(i).Get("children");
+		for (size_t j = 0; j < children.GetSize(); j++)
+		{
+			const auto index = GetIndex(children.Get(j));
+			if (index < child.size())
+			{
+				child[index] = true;
+			}
+		}
+	}
+
+	for (size_t i = 0; i < nodes.GetSize(); i++)
+	{
+		if (!child[i])
+		{
+			ReadNode(i, transform, 0);
+		}
+	}
+}
+
+//==============================================================================
+
+void GltfLoader::ReadNode(size_t index, const glm::mat4 &parent, unsigned int depth) noexcept
+{
+	const auto &nodes = document.Get("nodes");
+	if (index >= nodes.GetSize() || depth > MAX_DEPTH)
+	{
+		return;
+	}
+
+	const auto &node   = nodes.Get(index);
+	const auto &matrix = node.Get("matrix");
+
+	glm::mat4 local(1.0f);
+	if (matrix.GetSize() == 16)
+	{
+		for (unsigned int i = 0; i < 16; i++)
+		{
+			local[i / 4][i % 4] = static_cast<float>(matrix.Get(i).GetNumber(i % 5 == 0 ? 1.0 : 0.0));
+		}
+	}
+	else
+	{
+		const auto &t = node.Get("translation");
+		const auto &r = node.Get("rotation");
+		const auto &s = node.Get("scale");
+
+		const glm::vec3 translation(t.Get(0).GetNumber(), t.Get(1).GetNumber(), t.Get(2).GetNumber());
+		const glm::vec3 scale(s.Get(0).GetNumber(1.0), s.Get(1).GetNumber(1.0), s.Get(2).GetNumber(1.0));
+
+		// stored as x, y, z, w
+		const glm::quat rotation(static_cast<float>(r.Get(3).GetNumber(1.0)), static_cast<float>(r.Get(0).GetNumber()),
+			static_cast<float>(r.Get(1).GetNumber()), static_cast<float>(r.Get(2).GetNumber()));
+
+		local = glm::translate(glm::mat4(1.0f), translation) * glm::mat4_cast(rotation) * glm::scale(glm::mat4(1.0f), scale);
+	}
+
+	const auto world = parent * local;
+
+	const auto mesh = GetIndex(node.Get("mesh"));
+	if (mesh < mesh_primitives.size())
+	{
+		for (auto index : mesh_primitives[mesh])
+		{
+			if (index == NONE)
+			{
+				continue;
+			}
+
+			auto &primitive = primitives[index];
+
+			auto instance = new Mesh;
+			instance->SetModel(world);
+			instance->SetMaterial(materials[primitive.material]);
+			instance->SetDoubleSided(material_jobs[primitive.material].double_sided);
+
+			primitive.instances.push_back(meshes.size());
+			meshes.push_back(instance);
+		}
+	}
+
+	const auto &children = node.Get("children");
+	for (size_t i = 0; i < children.GetSize(); i++)
+	{
+		ReadNode(GetIndex(children.Get(i)), world, depth + 1);
+	}
+}
+
+//==============================================================================
+
+size_t GltfLoader::GetIndex(const Json &value, size_t fallback) noexcept
+{
+	if (value.IsNull())
+	{
+		return fallback;
+	}
+
+	// doubles hold every integer up to 2^53
+	const auto number = value.GetNumber(-1.0);
+	if (number < 0.0 || number >= 9007199254740992.0 || number != std::floor(number))
+	{
+		return NONE;
+	}
+
+	return static_cast<size_t>(number);
+}
+
+//==============================================================================
+
+size_t GltfLoader::GetComponentSize(unsigned int type) noexcept
+{
+	// glTF component types are the GL enums
+	switch (type)
+	{
+	case GL_BYTE:
+	case GL_UNSIGNED_BYTE:  return 1;
+	case GL_SHORT:
+	case GL_UNSIGNED_SHORT: return 2;
+	case GL_UNSIGNED_INT:
+	case GL_FLOAT:          return 4;
+	default:                return 0;
+	}
+}
+
+//==============================================================================
+
+size_t GltfLoader::GetImage(const Json &texture_info) const noexcept
+{
+	const auto texture = GetIndex(texture_info.Get("index"));
+	const auto source  = GetIndex(document.Get("textures").Get(texture).Get("source"));
+
+	return source < images.size() ? source : NONE;
+}
+
+//==============================================================================
+
+size_t GltfLoader::AddJob(Bake bake, size_t image, size_t occlusion, const glm::vec4 &factor) noexcept
+{
+	const auto key = std::to_string(static_cast<int>(bake)) + " " + std::to_string(image) + " " + std::to_string(occlusion) + " " +
+		std::to_string(factor.x) + " " + std::to_string(factor.y) + " " + std::to_string(factor.z) + " " + std::to_string(factor.w);
+
+	const auto it = job_keys.find(key);
+	if (it != job_keys.end())
+	{
+		return it->second;
+	}
+
+	if (image != NONE)
+	{
+		images[image].used = true;
+	}
+
+	if (occlusion != NONE)
+	{
+		images[occlusion].used = true;
+	}
+
+	Job job;
+	job.bake      = bake;
+	job.image     = image;
+	job.occlusion = occlusion;
+	job.factor    = factor;
+	job.width      = 0;
+	job.height     = 0;
+	job.components = 0;
+	job.texture    = nullptr;
+
+	job_keys[key] = jobs.size();
+	jobs.push_back(job);
+
+	return jobs.size() - 1;
+}
+
+//==============================================================================
+
+size_t GltfLoader::AddMaterial(const Json &material) noexcept
+{
+	const auto &pbr  = material.Get("pbrMetallicRoughness");
+	const auto &base = pbr.Get("baseColorFactor");
+
+	glm::vec4 color(1.0f);
+	for (unsigned int i = 0; i < 4; i++)
+	{
+		color[i] = static_cast<float>(base.Get(i).GetNumber(1.0));
+	}
+
+	const auto &occlusion = material.Get("occlusionTexture");
+	const glm::vec4 orm(occlusion.Get("strength").GetNumber(1.0), pbr.Get("roughnessFactor").GetNumber(1.0),
+		pbr.Get("metallicFactor").GetNumber(1.0), 1.0f);
+
+	const auto normal = GetImage(material.Get("normalTexture"));
+
+	MaterialJobs result;
+	result.albedo       = AddJob(Bake::ALBEDO, GetImage(pbr.Get("baseColorTexture")), NONE, color);
+	result.normal       = normal != NONE ? AddJob(Bake::NORMAL, normal, NONE, glm::vec4(1.0f)) : NONE;
+	result.orm          = AddJob(Bake::ORM, GetImage(pbr.Get("metallicRoughnessTexture")), GetImage(occlusion), orm);
+	result.double_sided = material.Get("doubleSided").GetBoolean();
+
+	materials.push_back(new Material);
+	material_jobs.push_back(result);
+
+	return materials.size() - 1;
+}
+
+//==============================================================================
+
+size_t GltfLoader::GetDefaultMaterial() noexcept
+{
+	// white, fully metallic and fully rough, as the specification defines it
+	if (default_material == NONE)
+	{
+		default_material = AddMaterial(Json());
+	}
+
+	return default_material;
+}
+
+//==============================================================================
+
+void GltfLoader::Run(Stage stage, size_t count) noexcept
+{
+	next = 0;
+
+	const auto threads = std::min<size_t>(std::max(std::thread::hardware_concurrency(), 1u), count);
+
+	std::vector<std::thread> workers;
+	for (size_t i = 0; i < threads; i++)
+	{
+		workers.emplace_back(&GltfLoader::Work, this, stage, count);
+	}
+
+	for (auto &worker : workers)
+	{
+		worker.join();
+	}
+}
+
+//==============================================================================
+
+void GltfLoader::Work(Stage stage, size_t count) noexcept
+{
+	for (auto job = next++; job < count; job = next++)
+	{
+		if (stage == Stage::BAKE)
+		{
+			BakeTexture(jobs[job]);
+		}
+		else
+		if (job < images.size())
+		{
+			DecodeImage(images[job]);
+		}
+		else
+		{
+			DecodePrimitive(primitives[job - images.size()]);
+		}
+	}
+}
+
+//==============================================================================
+
+void GltfLoader::DecodeImage(Image &image) noexcept
+{
+	if (!image.used)
+	{
+		return;
+	}
+
+	// glTF puts v = 0 on the first row, so nothing is flipped
+	stbi_set_flip_vertically_on_load_thread(false);
+
+	int components = 0;
+	if (image.data)
+	{
+		image.pixels = stbi_load_from_memory(image.data, static_cast<int>(image.size), &image.width, &image.height, &components, 4);
+	}
+	else
+	if (!image.path.empty())
+	{
+		image.pixels = stbi_load(image.path.c_str(), &image.width, &image.height, &components, 4);
+	}
+
+	if (!image.pixels)
+	{
+		std::cout << "error: model " << name << " has an image that cannot be decoded" << std::endl;
+	}
+}
+
+//==============================================================================
+
+void GltfLoader::DecodePrimitive(Primitive &primitive) noexcept
+{
+	if (primitive.failed || primitive.instances.empty())
+	{
+		return;
+	}
+
+	const auto &position = accessors[primitive.position];
+	const auto count = position.count;
+
+	std::vector<glm::vec3> positions(count);
+	ReadFloats(position, 3, &positions[0].x);
+
+	std::vector<unsigned int> indices;
+	if (primitive.indices != NONE)
+	{
+		if (!ReadIndices(accessors[primitive.indices], count, indices))
+		{
+			std::cout << "error: model " << name << " has indices out of range" << std::endl;
+			primitive.failed = true;
+			return;
+		}
+	}
+	else
+	{
+		indices.resize(count);
+		for (size_t i = 0; i < count; i++)
+		{
+			indices[i] = static_cast<unsigned int>(i);
+		}
+	}
+
+	if (primitive.strip)
+	{
+		indices = MeshOptimizer::StripToList(indices);
+	}
+	else
+	{
+		indices.resize(indices.size() - indices.size() % 3);
+	}
+
+	std::vector<glm::vec3> normals(count);
+	if (primitive.normal != NONE)
+	{
+		ReadFloats(accessors[primitive.normal], 3, &normals[0].x);
+
+		for (auto &normal : normals)
+		{
+			const auto length = glm::length(normal);
+			normal = length > 0.0f ? normal / length : glm::vec3(0.0f, 0.0f, 1.0f);
+		}
+	}
+	else
+	{
+		ComputeNormals(positions, indices, normals);
+	}
+
+	std::vector<glm::vec2> uvs;
+	if (primitive.texcoord != NONE)
+	{
+		uvs.resize(count);
+		ReadFloats(accessors[primitive.texcoord], 2, &uvs[0].x);
+	}
+
+	std::vector<glm::vec4> tangents;
+	if (primitive.tangent != NONE)
+	{
+		tangents.resize(count);
+		ReadFloats(accessors[primitive.tangent], 4, &tangents[0].x);
+	}
+
+	if (optimize)
+	{
+		MeshOptimizer::Remap(tangents, MeshOptimizer::Optimize(indices, positions, normals, uvs));
+	}
+
+	// the other instances share the first one's buffers, see Load()
+	primitive.failed = !meshes[primitive.instances[0]]->Fill(positions, normals, uvs, tangents, indices);
+}
+
+//==============================================================================
+
+void GltfLoader::BakeTexture(Job &job) noexcept
+{
+	const auto image     = job.image     != NONE && images[job.image].pixels     ? &images[job.image]     : nullptr;
+	const auto occlusion = job.occlusion != NONE && images[job.occlusion].pixels ? &images[job.occlusion] : nullptr;
+
+	// a missing map is one texel of its factor
+	const auto size = image ? image : occlusion;
+	job.width      = size ? size->width  : 1;
+	job.height     = size ? size->height : 1;
+	job.components = 3;
+
+	const auto texels = static_cast<size_t>(job.width) * job.height;
+	job.pixels.resize(texels * 3);
+
+	// the factor is linear and pbr.fs decodes the albedo with a 2.2 power
+	const auto albedo_scale = glm::pow(glm::vec3(job.factor), glm::vec3(1.0f / 2.2f));
+
+	for (size_t i = 0; i < texels; i++)
+	{
+		const auto source = image ? &image->pixels[i * 4] : nullptr;
+		const auto target = &job.pixels[i * 3];
+
+		glm::vec3 texel(255.0f);
+		if (job.bake == Bake::ALBEDO)
+		{
+			texel = (source ? glm::vec3(source[0], source[1], source[2]) : texel) * albedo_scale;
+		}
+		else
+		if (job.bake == Bake::NORMAL)
+		{
+			texel = source ? glm::vec3(source[0], source[1], source[2]) : glm::vec3(128.0f, 128.0f, 255.0f);
+		}
+		else
+		{
+			// glTF keeps roughness in g and metallic in b, occlusion comes from r of its own map
+			auto ao = 255.0f;
+			if (occlusion)
+			{
+				const auto x = i % job.width * occlusion->width  / job.width;
+				const auto y = i / job.width * occlusion->height / job.height;
+				ao = occlusion->pixels[(y * occlusion->width + x) * 4];
+			}
+
+			texel.r = 255.0f + job.factor.x * (ao - 255.0f);
+			texel.g = (source ? source[1] : 255.0f) * job.factor.y;
+			texel.b = (source ? source[2] : 255.0f) * job.factor.z;
+		}
+
+		texel = glm::clamp(texel + 0.5f, 0.0f, 255.0f);
+		target[0] = static_cast<unsigned char>(texel.r);
+		target[1] = static_cast<unsigned char>(texel.g);
+		target[2] = static_cast<unsigned char>(texel.b);
+	}
+}
+
+//==============================================================================
+
+void GltfLoader::ReadFloats(const Accessor &accessor, unsigned int components, float *target) noexcept
+{
+	const auto size = GetComponentSize(accessor.type);
+
+	for (size_t i = 0; i < accessor.count; i++)
+	{
+		const auto element = accessor.data + i * accessor.stride;
+		for (unsigned int c = 0; c < components; c++)
+		{
+			auto &value = target[i * components + c];
+			if (c >= accessor.components)
+			{
+				value = 0.0f;
+				continue;
+			}
+
+			const auto component = element + c * size;
+			switch (accessor.type)
+			{
+			case GL_BYTE:
+			{
+				int8_t v;
+				std::memcpy(&v, component, sizeof(v));
+				value = accessor.normalized ? std::max(v / 127.0f, -1.0f) : v;
+				break;
+			}
+			case GL_UNSIGNED_BYTE:
+			{
+				uint8_t v;
+				std::memcpy(&v, component, sizeof(v));
+				value = accessor.normalized ? v / 255.0f : v;
+				break;
+			}
+			case GL_SHORT:
+			{
+				int16_t v;
+				std::memcpy(&v, component, sizeof(v));
+				value = accessor.normalized ? std::max(v / 32767.0f, -1.0f) : v;
+				break;
+			}
+			case GL_UNSIGNED_SHORT:
+			{
+				uint16_t v;
+				std::memcpy(&v, component, sizeof(v));
+				value = accessor.normalized ? v / 65535.0f : v;
+				break;
+			}
+			case GL_UNSIGNED_INT:
+			{
+				uint32_t v;
+				std::memcpy(&v, component, sizeof(v));
+				value = static_cast<float>(v);
+				break;
+			}
+			default:
+				std::memcpy(&value, component, sizeof(value));
+				break;
+			}
+		}
+	}
+}
+
+//==============================================================================
+
+bool GltfLoader::ReadIndices(const Accessor &accessor, size_t vertex_count, std::vector<unsigned int> &indices) noexcept
+{
+	indices.resize(accessor.count);
+
+	for (size_t i = 0; i < accessor.count; i++)
+	{
+		const auto element = accessor.data + i * accessor.stride;
+
+		uint32_t index = 0;
+		switch (accessor.type)
+		{
+		case GL_UNSIGNED_BYTE:
+			index = element[0];
+			break;
+		case GL_UNSIGNED_SHORT:
+		{
+			uint16_t v;
+			std::memcpy(&v, element, sizeof(v));
+			index = v;
+			break;
+		}
+		case GL_UNSIGNED_INT:
+			std::memcpy(&index, element, sizeof(index));
+			break;
+		default:
+			return false;
+		}
+
+		if (index >= vertex_count)
+		{
+			return false;
+		}
+
+		indices[i] = index;
+	}
+
+	return true;
+}
+
+//==============================================================================
+
+void GltfLoader::ComputeNormals(const std::vector<glm::vec3> &positions, const std::vector<unsigned int> &indices, std::vector<glm::vec3> &normals) noexcept
+{
+	normals.assign(positions.size(), glm::vec3(0.0f));
+
+	// the cross product is twice the area, so larger triangles weigh more
+	for (size_t i = 0; i + 2 < indices.size(); i += 3)
+	{
+		const auto &a = positions[indices[i + 0]];
+		const auto &b = positions[indices[i + 1]];
+		const auto &c = positions[indices[i + 2]];
+
+		const auto normal = glm::cross(b - a, c - a);
+		normals[indices[i + 0]] += normal;
+		normals[indices[i + 1]] += normal;
+		normals[indices[i + 2]] += normal;
+	}
+
+	for (auto &normal : normals)
+	{
+		const auto length = glm::length(normal);
+		normal = length > 0.0f ? normal / length : glm::vec3(0.0f, 0.0f, 1.0f);
+	}
+}
+
+//==============================================================================
+
+void GltfLoader::Release() noexcept
+{
+	for (auto &image : images)
+	{
+		stbi_image_free(image.pixels);
+	}
+
+	for (auto mapped : external)
+	{
+		delete mapped;
+	}
+
+	file.Close();
+	external.clear();
+	document = Json();
+
+	buffers.clear();
+	views.clear();
+	accessors.clear();
+	images.clear();
+	jobs.clear();
+	job_keys.clear();
+	material_jobs.clear();
+	mesh_primitives.clear();
+	primitives.clear();
+
+	default_material = NONE;
+}
+
+//==============================================================================
+
+GltfLoader::GltfLoader() noexcept :
+	default_material(NONE),
+	optimize(false),
+	next(0)
+{
+}
+
+//==============================================================================
+
+GltfLoader::~GltfLoader() noexcept
+{
+	Release();
+}
+
+//==============================================================================
+
+bool GltfLoader::Load(const std::string &path, const glm::mat4 &transform, bool optimize) noexcept
+{
+	Release();
+
+	textures.clear();
+	materials.clear();
+	meshes.clear();
+
+	name = path;
+	this->optimize = optimize;
+
+	const auto slash = path.find_last_of("\\/");
+	directory = slash == std::string::npos ? std::string() : path.substr(0, slash + 1);
+
+	if (!file.Open(path))
+	{
+		std::cout << "error: model " << path << " cannot be opened" << std::endl;
+		return false;
+	}
+
+	const unsigned char *bin = nullptr;
+	size_t bin_size = 0;
+
+	if (!ReadChunks(bin, bin_size) || !ReadBuffers(bin, bin_size) || !ReadViews())
+	{
+		Release();
+		return false;
+	}
+
+	ReadAccessors();
+	ReadImages();
+	ReadMaterials();
+	ReadMeshes();
+	ReadNodes(transform);
+
+	// the buffers are mapped here, on the GL thread, and filled by the workers;
+	// one set per primitive, its other instances share them once unmapped
+	for (auto &primitive : primitives)
+	{
+		if (primitive.instances.empty())
+		{
+			continue;
+		}
+
+		const auto vertex_count = accessors[primitive.position].count;
+
+		auto index_count = primitive.indices != NONE ? accessors[primitive.indices].count : vertex_count;
+		index_count = primitive.strip ? (index_count >= 3 ? (index_count - 2) * 3 : 0) : index_count - index_count % 3;
+
+		if (!meshes[primitive.instances[0]]->Map(vertex_count, index_count, true, primitive.texcoord != NONE, optimize))
+		{
+			primitive.failed = true;
+		}
+	}
+
+	Run(Stage::DECODE, images.size() + primitives.size());
+	Run(Stage::BAKE, jobs.size());
+
+	for (auto &job : jobs)
+	{
+		job.texture = new Texture;
+		job.texture->Load(job.pixels.data(), job.width, job.height, job.components);
+		textures.push_back(job.texture);
+	}
+
+	for (size_t i = 0; i < materials.size(); i++)
+	{
+		const auto &slots = material_jobs[i];
+
+		materials[i]->SetAlbedo(jobs[slots.albedo].texture);
+		materials[i]->SetORM(jobs[slots.orm].texture);
+		if (slots.normal != NONE)
+		{
+			materials[i]->SetNormal(jobs[slots.normal].texture);
+		}
+	}
+
+	// what could not be decoded is dropped, the rest keeps the node order
+	for (auto &primitive : primitives)
+	{
+		if (primitive.instances.empty())
+		{
+			continue;
+		}
+
+		const auto first = meshes[primitive.instances[0]];
+		const auto unmapped = first->Unmap() && !primitive.failed;
+
+		for (auto instance : primitive.instances)
+		{
+			const auto drawable = unmapped && (meshes[instance] == first || meshes[instance]->Share(*first));
+			if (!drawable)
+			{
+				delete meshes[instance];
+				meshes[instance] = nullptr;
+			}
+		}
+	}
+
+	meshes.erase(std::remove(meshes.begin(), meshes.end(), nullptr), meshes.end());
+
+	Release();
+	return true;
+}
+
+//==============================================================================
+
+const std::vector<Texture*> &GltfLoader::GetTextures() const noexcept
+{
+	return textures;
+}
+
+//==============================================================================
+
+const std::vector<Material*> &GltfLoader::GetMaterials() const noexcept
+{
+	return materials;
+}
+
+//==============================================================================
+
+const std::vector<Mesh*> &GltfLoader::GetMeshes() const noexcept
+{
+	return meshes;
+}
+
+//==============================================================================
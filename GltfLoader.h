@@ -0,0 +1,192 @@
+
+#pragma once
+
+//==============================================================================
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "Json.h"
+#include "MappedFile.h"
+
+//==============================================================================
+
+class Material;
+class Mesh;
+class Texture;
+
+//==============================================================================
+
+// binary glTF 2.0; the file is mapped and its JSON chunk parsed once on the GL
+// thread, which also maps one Mesh per primitive and node, then worker threads
+// decode the images and pack the vertex data straight into those mappings;
+// only the texture uploads wait for the workers to join
+//
+// metallic-roughness materials become an albedo, a normal and an ORM map with
+// the factors baked in; emission, alpha and texture transforms are ignored
+class GltfLoader
+{
+private:
+	enum class Stage { DECODE, BAKE };
+	enum class Bake { ALBEDO, NORMAL, ORM };
+
+	static const size_t NONE = static_cast<size_t>(-1);
+
+	static const uint32_t CHUNK_JSON = 0x4E4F534A;
+	static const uint32_t CHUNK_BIN  = 0x004E4942;
+
+	// node nesting past this is ignored, it only happens in broken files
+	static const unsigned int MAX_DEPTH = 64;
+
+	struct View
+	{
+		const unsigned char *data;
+		size_t size;
+		size_t stride;
+	};
+
+	// validated against its view, so reading count elements stays in the file
+	struct Accessor
+	{
+		const unsigned char *data;
+		size_t count;
+		size_t stride;
+		unsigned int type;
+		unsigned int components;
+		bool normalized;
+	};
+
+	struct Image
+	{
+		const unsigned char *data;
+		size_t size;
+		std::string path;
+		bool used;
+
+		unsigned char *pixels; // RGBA, from stb_image
+		int width;
+		int height;
+	};
+
+	// one texture as a material uses it; materials with the same images and
+	// factors share it
+	struct Job
+	{
+		Bake bake;
+		size_t image;
+		size_t occlusion;
+		glm::vec4 factor; // base color, or occlusion strength, roughness and metallic
+
+		std::vector<unsigned char> pixels;
+		int width;
+		int height;
+		int components;
+		Texture *texture;
+	};
+
+	struct MaterialJobs
+	{
+		size_t albedo;
+		size_t normal;
+		size_t orm;
+		bool double_sided;
+	};
+
+	struct Primitive
+	{
+		size_t position;
+		size_t normal;
+		size_t texcoord;
+		size_t tangent;
+		size_t indices;
+		bool strip;
+		size_t material;
+
+		std::vector<size_t> instances; // into meshes
+		bool failed;
+	};
+
+	std::string name;
+	std::string directory;
+	MappedFile file;
+	std::vector<MappedFile*> external;
+	Json document;
+
+	std::vector<View> buffers;
+	std::vector<View> views;
+	std::vector<Accessor> accessors;
+	std::vector<Image> images;
+
+	std::vector<Job> jobs;
+	std::map<std::string, size_t> job_keys;
+	std::vector<MaterialJobs> material_jobs;
+	size_t default_material;
+
+	// the primitives of every glTF mesh, NONE for those that cannot be drawn
+	std::vector<std::vector<size_t>> mesh_primitives;
+	std::vector<Primitive> primitives;
+
+	std::vector<Texture*> textures;
+	std::vector<Material*> materials;
+	std::vector<Mesh*> meshes;
+
+	bool optimize;
+	std::atomic<size_t> next;
+
+private:
+	bool ReadChunks(const unsigned char *&bin, size_t &bin_size) noexcept;
+	bool ReadBuffers(const unsigned char *bin, size_t bin_size) noexcept;
+	bool ReadViews() noexcept;
+	void ReadAccessors() noexcept;
+	void ReadImages() noexcept;
+	void ReadMaterials() noexcept;
+	void ReadMeshes() noexcept;
+	void ReadNodes(const glm::mat4 &transform) noexcept;
+	void ReadNode(size_t index, const glm::mat4 &parent, unsigned int depth) noexcept;
+
+	// fallback when the member is missing, NONE when it is no valid index
+	static size_t GetIndex(const Json &value, size_t fallback = NONE) noexcept;
+	static size_t GetComponentSize(unsigned int type) noexcept;
+
+	size_t GetImage(const Json &texture_info) const noexcept;
+	size_t AddJob(Bake bake, size_t image, size_t occlusion, const glm::vec4 &factor) noexcept;
+	size_t AddMaterial(const Json &material) noexcept;
+	size_t GetDefaultMaterial() noexcept;
+
+	void Run(Stage stage, size_t count) noexcept;
+	void Work(Stage stage, size_t count) noexcept;
+	void DecodeImage(Image &image) noexcept;
+	void DecodePrimitive(Primitive &primitive) noexcept;
+	void BakeTexture(Job &job) noexcept;
+
+	// every element as floats, normalized integers mapped to [0, 1] or [-1, 1]
+	static void ReadFloats(const Accessor &accessor, unsigned int components, float *target) noexcept;
+	static bool ReadIndices(const Accessor &accessor, size_t vertex_count, std::vector<unsigned int> &indices) noexcept;
+	static void ComputeNormals(const std::vector<glm::vec3> &positions, const std::vector<unsigned int> &indices, std::vector<glm::vec3> &normals) noexcept;
+
+	// everything but the results
+	void Release() noexcept;
+
+public:
+	GltfLoader() noexcept;
+	~GltfLoader() noexcept;
+
+	// every node of the default scene, below transform; the caller takes over
+	// the textures, materials and meshes, e.g. Scene::AddModel(); optimize runs
+	// MeshOptimizer on every primitive and simplifies it into levels of detail,
+	// which takes about twenty times as long as the rest of the load, so it is
+	// for files not exported in an optimized order
+	bool Load(const std::string &path, const glm::mat4 &transform = glm::mat4(1.0f), bool optimize = false) noexcept;
+
+	const std::vector<Texture*>  &GetTextures()  const noexcept;
+	const std::vector<Material*> &GetMaterials() const noexcept;
+	const std::vector<Mesh*>     &GetMeshes()    const noexcept;
+};
+
+//==============================================================================
@@ -0,0 +1,53 @@
+
+#include "HDRFormat.h"
+
+#include "GLAD/glad.h"
+
+//==============================================================================
+
+unsigned int GetInternalFormat(HDRFormat format) noexcept
+{
+	switch (format)
+	{
+	case HDRFormat::R11G11B10F:
+		return GL_R11F_G11F_B10F;
+	case HDRFormat::RGB9E5:
+		return GL_RGB9_E5;
+	case HDRFormat::RGB16F:
+	default:
+		return GL_RGB16F;
+	}
+}
+
+//==============================================================================
+
+size_t GetTexelSize(HDRFormat format) noexcept
+{
+	// RGB16F is padded to 8 bytes per texel by most drivers
+	return format == HDRFormat::RGB16F ? 8 : 4;
+}
+
+//==============================================================================
+
+const char *GetName(HDRFormat format) noexcept
+{
+	switch (format)
+	{
+	case HDRFormat::R11G11B10F:
+		return "R11G11B10F";
+	case HDRFormat::RGB9E5:
+		return "RGB9E5";
+	case HDRFormat::RGB16F:
+	default:
+		return "RGB16F";
+	}
+}
+
+//==============================================================================
+
+HDRFormat GetRenderableFormat(HDRFormat format) noexcept
+{
+	return format == HDRFormat::RGB9E5 ? HDRFormat::RGB16F : format;
+}
+
+//==============================================================================
@@ -0,0 +1,22 @@
+
+#pragma once
+
+//==============================================================================
+
+#include <cstddef>
+
+//==============================================================================
+
+// storage of HDR textures and cubemaps, the packed ones take half of RGB16F
+enum class HDRFormat { RGB16F, R11G11B10F, RGB9E5 };
+
+//==============================================================================
+
+unsigned int GetInternalFormat(HDRFormat format) noexcept;
+size_t GetTexelSize(HDRFormat format)            noexcept;
+const char *GetName(HDRFormat format)            noexcept;
+
+// RGB9E5 is not color-renderable, render targets use lossless RGB16F instead
+HDRFormat GetRenderableFormat(HDRFormat format) noexcept;
+
+//==============================================================================
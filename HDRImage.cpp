@@ -0,0 +1,461 @@
+
+#include "HDRImage.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <thread>
+
+#include <glm/gtc/packing.hpp>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define HDR_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+// MSVC exposes every intrinsic, GCC and Clang need them enabled per function
+#if defined(HDR_X86) && defined(__GNUC__)
+#define HDR_TARGET_F16C __attribute__((target("sse4.1,avx,f16c")))
+#else
+#define HDR_TARGET_F16C
+#endif
+
+//==============================================================================
+
+bool HDRImage::HasF16C() noexcept
+{
+#if defined(HDR_X86) && defined(_MSC_VER)
+	int info[4];
+	__cpuid(info, 1);
+
+	const auto sse41 = (info[2] & (1 << 19)) != 0;
+	const auto avx   = (info[2] & (1 << 28)) != 0 && (info[2] & (1 << 27)) != 0 && (_xgetbv(0) & 6) == 6;
+	const auto f16c  = (info[2] & (1 << 29)) != 0;
+	return sse41 && avx && f16c;
+#elif defined(HDR_X86) && defined(__GNUC__)
+	return __builtin_cpu_supports("sse4.1") && __builtin_cpu_supports("avx") && __builtin_cpu_supports("f16c");
+#else
+	return false;
+#endif
+}
+
+//==============================================================================
+
+bool HDRImage::SkipScanline(const unsigned char *&src, const unsigned char *end, int width) noexcept
+{
+	// only the run headers are read, so finding every scanline is cheap
+	const auto rle = width >= 8 && width < 32768 && end - src >= 4 &&
+		src[0] == 2 && src[1] == 2 && ((src[2] << 8) | src[3]) == width;
+
+	if (!rle)
+	{
+		src += 4 * static_cast<size_t>(width);
+		return src <= end;
+	}
+
+	src += 4;
+	for (int channel = 0; channel < 4; channel++)
+	{
+		for (int x = 0; x < width;)
+		{
+			if (src >= end)
+			{
+				return false;
+			}
+
+			const int count = *src++;
+			if (count > 128)
+			{
+				x   += count - 128;
+				src += 1;
+			}
+			else
+			{
+				x   += count;
+				src += count;
+			}
+
+			if (count == 0 || x > width)
+			{
+				return false;
+			}
+		}
+	}
+
+	return src <= end;
+}
+
+//==============================================================================
+
+void HDRImage::DecodeScanline(const unsigned char *src, const unsigned char *end, unsigned char *rgbe, int width) noexcept
+{
+	// SkipScanline has validated the runs already
+	const auto rle = width >= 8 && width < 32768 && end - src >= 4 &&
+		src[0] == 2 && src[1] == 2 && ((src[2] << 8) | src[3]) == width;
+
+	if (!rle)
+	{
+		std::memcpy(rgbe, src, 4 * static_cast<size_t>(width));
+		return;
+	}
+
+	src += 4;
+	for (int channel = 0; channel < 4; channel++)
+	{
+		for (int x = 0; x < width;)
+		{
+			const int count = *src++;
+			if (count > 128)
+			{
+				const auto value = *src++;
+				for (int i = 0; i < count - 128; i++, x++)
+				{
+					rgbe[4 * x + channel] = value;
+				}
+			}
+			else
+			{
+				for (int i = 0; i < count; i++, x++)
+				{
+					rgbe[4 * x + channel] = *src++;
+				}
+			}
+		}
+	}
+}
+
+//==============================================================================
+
+void HDRImage::Convert(const unsigned char *rgbe, unsigned short *half, int width) noexcept
+{
+	for (int x = 0; x < width; x++, rgbe += 4, half += 3)
+	{
+		// mantissa * 2^(exponent - 128 - 8), as stb_image decodes it
+		const auto scale = rgbe[3] ? std::ldexp(1.0f, rgbe[3] - 136) : 0.0f;
+
+		half[0] = glm::packHalf1x16(rgbe[0] * scale);
+		half[1] = glm::packHalf1x16(rgbe[1] * scale);
+		half[2] = glm::packHalf1x16(rgbe[2] * scale);
+	}
+}
+
+//==============================================================================
+
+HDR_TARGET_F16C void HDRImage::ConvertF16C(const unsigned char *rgbe, unsigned short *half, int width) noexcept
+{
+#ifdef HDR_X86
+	// eight texels per iteration: 24 floats, then three 8-wide half conversions
+	float rgb[24 + 1];
+
+	auto x = 0;
+	for (; x + 8 <= width; x += 8, rgbe += 32, half += 24)
+	{
+		for (int i = 0; i < 8; i++)
+		{
+			int texel;
+			std::memcpy(&texel, &rgbe[4 * i], sizeof(texel));
+
+			// 2^(e - 136) built from the exponent bits; anything below 2^-126 is zero as a half anyway
+			const auto e = rgbe[4 * i + 3];
+			const auto bits = e >= 10 ? (e - 136 + 127) << 23 : 0;
+			const auto scale = _mm_castsi128_ps(_mm_set1_epi32(bits));
+
+			const auto mantissa = _mm_cvtepi32_ps(_mm_cvtepu8_epi32(_mm_cvtsi32_si128(texel)));
+
+			// the fourth lane spills into the next texel, which overwrites it
+			_mm_storeu_ps(&rgb[3 * i], _mm_mul_ps(mantissa, scale));
+		}
+
+		for (int i = 0; i < 3; i++)
+		{
+			const auto packed = _mm256_cvtps_ph(_mm256_loadu_ps(&rgb[8 * i]), _MM_FROUND_TO_NEAREST_INT);
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(&half[8 * i]), packed);
+		}
+	}
+
+	Convert(rgbe, half, width - x);
+#else
+	Convert(rgbe, half, width);
+#endif
+}
+
+//==============================================================================
+
+void HDRImage::DecodeRows(const std::vector<const unsigned char *> *scanlines, const unsigned char *end, int first, int last, int offset, bool f16c) noexcept
+{
+	std::vector<unsigned char> rgbe(4 * static_cast<size_t>(width));
+
+	for (auto y = first; y < last; y++)
+	{
+		DecodeScanline((*scanlines)[y], end, rgbe.data(), width);
+
+		const auto row = flip ? rows - 1 - (offset + y) : offset + y;
+		const auto half = &pixels[3 * static_cast<size_t>(row) * width];
+
+		if (f16c)
+		{
+			ConvertF16C(rgbe.data(), half, width);
+		}
+		else
+		{
+			Convert(rgbe.data(), half, width);
+		}
+	}
+}
+
+//==============================================================================
+
+bool HDRImage::ReadMore(size_t bytes) noexcept
+{
+	if (!file || file.peek() == std::ifstream::traits_type::eof())
+	{
+		return false;
+	}
+
+	const auto size = buffer.size();
+	buffer.resize(size + bytes);
+	file.read(reinterpret_cast<char *>(&buffer[size]), bytes);
+	buffer.resize(size + static_cast<size_t>(file.gcount()));
+
+	return true;
+}
+
+//==============================================================================
+
+HDRImage::HDRImage() noexcept :
+	width(0),
+	height(0),
+	next_row(0),
+	first_row(0),
+	rows(0),
+	flip(true),
+	consumed(0)
+{
+}
+
+//==============================================================================
+
+bool HDRImage::Open(const std::string &path) noexcept
+{
+	Free();
+
+	this->path = path;
+
+	file.open(path, std::ios::binary);
+	if (!file)
+	{
+		std::cout << "error: texture " << path << " is not found" << std::endl;
+		return false;
+	}
+
+	// text header: magic, variables, a blank line, then the resolution
+	std::string line;
+	std::getline(file, line);
+	auto valid = line.compare(0, 2, "#?") == 0;
+
+	while (valid && std::getline(file, line) && !line.empty())
+	{
+		if (line.compare(0, 7, "FORMAT=") == 0 && line != "FORMAT=32-bit_rle_rgbe")
+		{
+			valid = false;
+		}
+	}
+
+	int w = 0;
+	int h = 0;
+	if (!valid || !std::getline(file, line) || std::sscanf(line.c_str(), "-Y %d +X %d", &h, &w) != 2 || w <= 0 || h <= 0)
+	{
+		std::cout << "error: texture " << path << " is not a supported Radiance file" << std::endl;
+		Free();
+		return false;
+	}
+
+	width  = w;
+	height = h;
+
+	return true;
+}
+
+//==============================================================================
+
+bool HDRImage::ReadBand(int count, bool flip) noexcept
+{
+	count = std::min(count, height - next_row);
+	if (!file.is_open() || count <= 0)
+	{
+		return false;
+	}
+
+	// scanlines have variable length, so their offsets are found sequentially;
+	// offsets rather than pointers since the buffer grows while reading
+	buffer.erase(buffer.begin(), buffer.begin() + consumed);
+	consumed = 0;
+
+	std::vector<size_t> offsets(count);
+	for (int y = 0; y < count; y++)
+	{
+		offsets[y] = consumed;
+
+		for (;;)
+		{
+			const unsigned char *src = buffer.data() + consumed;
+			if (SkipScanline(src, buffer.data() + buffer.size(), width))
+			{
+				consumed = src - buffer.data();
+				break;
+			}
+
+			// at most the uncompressed size of the remaining rows, at least 1 MB
+			if (!ReadMore(std::max<size_t>(4 * static_cast<size_t>(width) * (count - y), 1 << 20)))
+			{
+				std::cout << "error: texture " << path << " is truncated" << std::endl;
+				Free();
+				return false;
+			}
+		}
+	}
+
+	std::vector<const unsigned char *> scanlines(count);
+	for (int y = 0; y < count; y++)
+	{
+		scanlines[y] = buffer.data() + offsets[y];
+	}
+
+	// a band after the first starts with the previous band's last row,
+	// so that bands can be filtered without seams
+	std::vector<unsigned short> overlap;
+	if (next_row > 0)
+	{
+		const auto last = this->flip ? 0 : rows - 1;
+		const auto begin = pixels.begin() + 3 * static_cast<size_t>(last) * width;
+		overlap.assign(begin, begin + 3 * width);
+	}
+
+	const auto offset = static_cast<int>(overlap.size() / (3 * width));
+
+	this->flip = flip;
+	first_row = next_row - offset;
+	rows = offset + count;
+	next_row += count;
+
+	pixels.resize(3 * static_cast<size_t>(width) * rows);
+
+	if (offset)
+	{
+		const auto row = flip ? rows - 1 : 0;
+		std::copy(overlap.begin(), overlap.end(), pixels.begin() + 3 * static_cast<size_t>(row) * width);
+	}
+
+	// then decoded and converted in parallel, one range of rows per thread
+	const auto f16c = HasF16C();
+	const auto threads = std::max(1, std::min(static_cast<int>(std::thread::hardware_concurrency()), count / 16));
+	const auto end = buffer.data() + buffer.size();
+
+	std::vector<std::thread> workers;
+	for (int i = 0; i < threads; i++)
+	{
+		const auto first = count * i / threads;
+		const auto last  = count * (i + 1) / threads;
+
+		workers.emplace_back(&HDRImage::DecodeRows, this, &scanlines, end, first, last, offset, f16c);
+	}
+
+	for (auto &worker : workers)
+	{
+		worker.join();
+	}
+
+	if (IsComplete())
+	{
+		file.close();
+		std::vector<unsigned char>().swap(buffer);
+		consumed = 0;
+	}
+
+	return true;
+}
+
+//==============================================================================
+
+bool HDRImage::Load(const std::string &path, bool flip) noexcept
+{
+	return Open(path) && ReadBand(height, flip);
+}
+
+//==============================================================================
+
+void HDRImage::Free() noexcept
+{
+	width     = 0;
+	height    = 0;
+	next_row  = 0;
+	first_row = 0;
+	rows      = 0;
+	consumed  = 0;
+
+	if (file.is_open())
+	{
+		file.close();
+	}
+	file.clear();
+
+	std::vector<unsigned char>().swap(buffer);
+	std::vector<unsigned short>().swap(pixels);
+}
+
+//==============================================================================
+
+int HDRImage::GetWidth() const noexcept
+{
+	return width;
+}
+
+//==============================================================================
+
+int HDRImage::GetHeight() const noexcept
+{
+	return height;
+}
+
+//==============================================================================
+
+int HDRImage::GetFirstRow() const noexcept
+{
+	return first_row;
+}
+
+//==============================================================================
+
+int HDRImage::GetRows() const noexcept
+{
+	return rows;
+}
+
+//==============================================================================
+
+bool HDRImage::IsComplete() const noexcept
+{
+	return height > 0 && next_row == height;
+}
+
+//==============================================================================
+
+const unsigned short *HDRImage::GetPixels() const noexcept
+{
+	return pixels.empty() ? nullptr : pixels.data();
+}
+
+//==============================================================================
+
+size_t HDRImage::GetMemorySize() const noexcept
+{
+	return pixels.size() * sizeof(unsigned short) + buffer.capacity();
+}
+
+//==============================================================================
@@ -0,0 +1,71 @@
+
+#pragma once
+
+//==============================================================================
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+//==============================================================================
+
+// Radiance .hdr reader that decodes RGBE straight to half float RGB,
+// either whole or streamed in bands of rows from the top of the file down
+class HDRImage
+{
+private:
+	std::string path;
+	std::ifstream file;
+
+	int width;
+	int height;
+	int next_row;
+	int first_row;
+	int rows;
+	bool flip;
+
+	std::vector<unsigned char> buffer;
+	size_t consumed;
+
+	std::vector<unsigned short> pixels;
+
+private:
+	static bool HasF16C() noexcept;
+
+	static bool SkipScanline  (const unsigned char *&src, const unsigned char *end, int width) noexcept;
+	static void DecodeScanline(const unsigned char *src, const unsigned char *end, unsigned char *rgbe, int width) noexcept;
+
+	static void Convert    (const unsigned char *rgbe, unsigned short *half, int width) noexcept;
+	static void ConvertF16C(const unsigned char *rgbe, unsigned short *half, int width) noexcept;
+
+	void DecodeRows(const std::vector<const unsigned char *> *scanlines, const unsigned char *end, int first, int last, int offset, bool f16c) noexcept;
+
+	bool ReadMore(size_t bytes) noexcept;
+
+public:
+	HDRImage() noexcept;
+
+	// Open reads the header only, each ReadBand decodes the next rows
+	bool Open(const std::string &path) noexcept;
+	bool ReadBand(int count, bool flip = true) noexcept;
+
+	bool Load(const std::string &path, bool flip = true) noexcept;
+	void Free() noexcept;
+
+	int GetWidth()  const noexcept;
+	int GetHeight() const noexcept;
+
+	// the band in file rows, counted from the top; bands after the first
+	// repeat the previous band's last row
+	int GetFirstRow() const noexcept;
+	int GetRows()     const noexcept;
+
+	bool IsComplete() const noexcept;
+
+	// three halves per texel, rows bottom to top when flipped
+	const unsigned short *GetPixels() const noexcept;
+
+	size_t GetMemorySize() const noexcept;
+};
+
+//==============================================================================
@@ -0,0 +1,30 @@
+
+#include "IBLQuality.h"
+
+//==============================================================================
+
+IBLQuality IBLQuality::Get(Preset preset, bool lazy) noexcept
+{
+	//        env   irr  pref  mips  brdf  probe  samples  delta   format                 lazy  octahedral
+	switch (preset)
+	{
+	case Preset::LOW:
+		return {  256,  16,   64,   4,   128,   64,    256, 0.1f,   HDRFormat::R11G11B10F, lazy, false };
+	case Preset::MEDIUM:
+		return {  512,  32,  128,   5,   256,   64,    512, 0.05f,  HDRFormat::R11G11B10F, lazy, false };
+	case Preset::ULTRA:
+		return { 1024,  64,  256,   6,   512,  256,   2048, 0.025f, HDRFormat::RGB16F,     lazy, false };
+	case Preset::HIGH:
+	default:
+		return {  512,  32,  128,   5,   512,  128,   1024, 0.025f, HDRFormat::RGB16F,     lazy, false };
+	}
+}
+
+//==============================================================================
+
+float IBLQuality::GetMaxReflectionLOD() const noexcept
+{
+	return static_cast<float>(prefilter_mips - 1);
+}
+
+//==============================================================================
@@ -0,0 +1,41 @@
+
+#pragma once
+
+//==============================================================================
+
+#include "HDRFormat.h"
+
+//==============================================================================
+
+class IBLQuality
+{
+public:
+	enum class Preset { LOW, MEDIUM, HIGH, ULTRA };
+
+public:
+	unsigned int environment_size;
+	unsigned int irradiance_size;
+	unsigned int prefilter_size;
+	unsigned int prefilter_mips;
+	unsigned int brdf_size;
+	unsigned int probe_size;
+	unsigned int sample_count;
+	float irradiance_delta;
+
+	// storage of the baked maps, probes use the renderable counterpart
+	HDRFormat format;
+
+	// bake only the prefilter mips covering the roughness range in use
+	bool lazy;
+
+	// irradiance and prefilter maps as octahedral 2D textures of twice the
+	// face size: two thirds of the cubemap memory, one pass per bake
+	bool octahedral;
+
+public:
+	static IBLQuality Get(Preset preset, bool lazy = false) noexcept;
+
+	float GetMaxReflectionLOD() const noexcept;
+};
+
+//==============================================================================
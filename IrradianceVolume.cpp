@@ -0,0 +1,296 @@
+
+#include "IrradianceVolume.h"
+
+#include "Environment.h"
+#include "Shader.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+#include "GLAD/glad.h"
+
+//==============================================================================
+
+const unsigned int IrradianceVolume::BLOCKS;
+
+//==============================================================================
+
+void IrradianceVolume::Work() noexcept
+{
+	// runs on the worker threads, probes are handed out one at a time
+	for (auto index = next_probe++; index < probes.size() / 9; index = next_probe++)
+	{
+		BakeProbe(index);
+		baked_probes++;
+	}
+}
+
+//==============================================================================
+
+void IrradianceVolume::BakeProbe(unsigned int index) noexcept
+{
+	const auto PI = 3.14159265359f;
+	const auto golden_angle = PI * (3.0f - std::sqrt(5.0f));
+
+	const glm::ivec3 cell(
+		index % resolution.x,
+		index / resolution.x % resolution.y,
+		index / (resolution.x * resolution.y));
+
+	const auto steps = glm::max(glm::vec3(resolution - 1), glm::vec3(1.0f));
+	const auto position = min + (max - min) * glm::vec3(cell) / steps;
+
+	auto sh = &probes[9 * index];
+	for (unsigned int i = 0; i < 9; i++)
+	{
+		sh[i] = glm::vec3(0.0f);
+	}
+
+	const auto solid_angle = 4.0f * PI / sample_count;
+
+	for (unsigned int i = 0; i < sample_count; i++)
+	{
+		const auto y = 1.0f - 2.0f * (static_cast<float>(i) + 0.5f) / sample_count;
+		const auto r = std::sqrt(1.0f - y * y);
+		const auto phi = golden_angle * i;
+
+		const glm::vec3 dir(r * std::cos(phi), y, r * std::sin(phi));
+		Environment::AddSH(sh, dir, Trace(position, dir) * solid_angle);
+	}
+
+	Environment::ConvolveSH(sh);
+}
+
+//==============================================================================
+
+glm::vec3 IrradianceVolume::Trace(const glm::vec3 &origin, const glm::vec3 &dir) const noexcept
+{
+	const auto PI = 3.14159265359f;
+
+	auto distance = 0.0f;
+	const auto hit = Intersect(origin, dir, FLT_MAX, distance);
+	if (hit < 0)
+	{
+		return Environment::EvaluateSH(sky_sh, dir);
+	}
+
+	// one diffuse bounce: the lights and the unoccluded sky at the hit point
+	const auto &occluder = occluders[hit];
+	const auto point  = origin + dir * distance;
+	const auto normal = glm::normalize(point - glm::vec3(occluder.sphere));
+
+	auto irradiance = Environment::EvaluateSH(sky_irradiance, normal) * PI;
+
+	const auto surface = point + normal * 0.001f;
+	for (auto &emitter : emitters)
+	{
+		const auto to_light = emitter.position - point;
+		const auto distance2 = glm::dot(to_light, to_light);
+		const auto NdotL = glm::dot(normal, to_light) / std::sqrt(distance2);
+		if (NdotL > 0.0f && !Occluded(surface, emitter.position))
+		{
+			irradiance += emitter.color * NdotL / distance2;
+		}
+	}
+
+	return occluder.albedo / PI * irradiance;
+}
+
+//==============================================================================
+
+bool IrradianceVolume::Occluded(const glm::vec3 &origin, const glm::vec3 &target) const noexcept
+{
+	const auto offset = target - origin;
+	const auto length = glm::length(offset);
+
+	auto distance = 0.0f;
+	return Intersect(origin, offset / length, length, distance) >= 0;
+}
+
+//==============================================================================
+
+int IrradianceVolume::Intersect(const glm::vec3 &origin, const glm::vec3 &dir, float max_distance, float &distance) const noexcept
+{
+	// nearest sphere in front of the origin, spheres around the origin are skipped
+	auto hit = -1;
+	distance = max_distance;
+
+	for (size_t i = 0; i < occluders.size(); i++)
+	{
+		const auto local = origin - glm::vec3(occluders[i].sphere);
+		const auto radius = occluders[i].sphere.w;
+
+		const auto c = glm::dot(local, local) - radius * radius;
+		if (c <= 0.0f)
+		{
+			continue;
+		}
+
+		const auto b = glm::dot(local, dir);
+		const auto discriminant = b * b - c;
+		if (b >= 0.0f || discriminant < 0.0f)
+		{
+			continue;
+		}
+
+		const auto t = -b - std::sqrt(discriminant);
+		if (t < distance)
+		{
+			distance = t;
+			hit = static_cast<int>(i);
+		}
+	}
+
+	return hit;
+}
+
+//==============================================================================
+
+void IrradianceVolume::Upload() noexcept
+{
+	const auto count = resolution.x * resolution.y * resolution.z;
+
+	// texel (x, y, z + block * depth) holds scalars 4 * block .. 4 * block + 3
+	std::vector<float> data(4 * BLOCKS * count, 0.0f);
+	for (int probe = 0; probe < count; probe++)
+	{
+		const auto sh = &probes[9 * probe];
+		for (unsigned int k = 0; k < 27; k++)
+		{
+			const auto block = k / 4;
+			data[4 * (block * count + probe) + k % 4] = sh[k / 3][k % 3];
+		}
+	}
+
+	if (!texture)
+	{
+		glGenTextures(1, &texture);
+	}
+
+	glBindTexture(GL_TEXTURE_3D, texture);
+	glTexImage3D(GL_TEXTURE_3D, 0, GL_RGBA16F, resolution.x, resolution.y, resolution.z * BLOCKS, 0, GL_RGBA, GL_FLOAT, data.data());
+
+	glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+	glBindTexture(GL_TEXTURE_3D, 0);
+
+	ready = true;
+}
+
+//==============================================================================
+
+void IrradianceVolume::Join() noexcept
+{
+	for (auto &worker : workers)
+	{
+		worker.join();
+	}
+
+	workers.clear();
+}
+
+//==============================================================================
+
+IrradianceVolume::IrradianceVolume(const glm::vec3 &min, const glm::vec3 &max, const glm::ivec3 &resolution) noexcept :
+	min(min),
+	max(max),
+	resolution(glm::max(resolution, glm::ivec3(1))),
+	sample_count(512),
+	next_probe(0),
+	baked_probes(0),
+	texture(0),
+	ready(false)
+{
+	for (unsigned int i = 0; i < 9; i++)
+	{
+		sky_sh[i] = glm::vec3(0.0f);
+		sky_irradiance[i] = glm::vec3(0.0f);
+	}
+}
+
+//==============================================================================
+
+IrradianceVolume::~IrradianceVolume() noexcept
+{
+	// finish quickly by handing out no more probes
+	next_probe = static_cast<unsigned int>(probes.size());
+	Join();
+
+	glDeleteTextures(1, &texture);
+}
+
+//==============================================================================
+
+void IrradianceVolume::SetSampleCount(unsigned int sample_count) noexcept
+{
+	this->sample_count = std::max(sample_count, 1u);
+}
+
+//==============================================================================
+
+void IrradianceVolume::Bake(const std::vector<Occluder> &occluders, const std::vector<Emitter> &emitters, const glm::vec3 sky_sh[9]) noexcept
+{
+	// the previous grid stays visible until the new one is uploaded
+	Join();
+
+	this->occluders = occluders;
+	this->emitters  = emitters;
+	std::copy(sky_sh, sky_sh + 9, this->sky_sh);
+
+	std::copy(sky_sh, sky_sh + 9, sky_irradiance);
+	Environment::ConvolveSH(sky_irradiance);
+
+	probes.assign(9 * resolution.x * resolution.y * resolution.z, glm::vec3(0.0f));
+	next_probe   = 0;
+	baked_probes = 0;
+
+	const auto threads = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+	for (unsigned int i = 0; i < threads; i++)
+	{
+		workers.emplace_back(&IrradianceVolume::Work, this);
+	}
+}
+
+//==============================================================================
+
+bool IrradianceVolume::IsBaking() const noexcept
+{
+	return !workers.empty();
+}
+
+//==============================================================================
+
+bool IrradianceVolume::IsReady() const noexcept
+{
+	return ready;
+}
+
+//==============================================================================
+
+void IrradianceVolume::Bind(const Shader *shader, unsigned int texture_unit) const noexcept
+{
+	shader->SetVec3("volume_min", min);
+	shader->SetVec3("volume_max", max);
+	shader->SetIVec3("volume_resolution", resolution);
+
+	glActiveTexture(GL_TEXTURE0 + texture_unit);
+	glBindTexture(GL_TEXTURE_3D, texture);
+}
+
+//==============================================================================
+
+void IrradianceVolume::Update() noexcept
+{
+	if (IsBaking() && baked_probes == probes.size() / 9)
+	{
+		Join();
+		Upload();
+	}
+}
+
+//==============================================================================
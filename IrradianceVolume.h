@@ -0,0 +1,84 @@
+
+#pragma once
+
+//==============================================================================
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+//==============================================================================
+
+class Shader;
+
+//==============================================================================
+
+// SH9 irradiance probes on a regular grid, baked on the CPU
+class IrradianceVolume
+{
+public:
+	// the bake works on a snapshot of the scene, never on GL objects
+	struct Occluder
+	{
+		glm::vec4 sphere;
+		glm::vec3 albedo;
+	};
+
+	struct Emitter
+	{
+		glm::vec3 position;
+		glm::vec3 color;
+	};
+
+	// 27 coefficients packed into 7 RGBA blocks along z
+	static const unsigned int BLOCKS = 7;
+
+private:
+	glm::vec3 min;
+	glm::vec3 max;
+	glm::ivec3 resolution;
+	unsigned int sample_count;
+
+	std::vector<Occluder> occluders;
+	std::vector<Emitter> emitters;
+	glm::vec3 sky_sh[9];
+	glm::vec3 sky_irradiance[9];
+
+	std::vector<glm::vec3> probes;
+	std::vector<std::thread> workers;
+	std::atomic<unsigned int> next_probe;
+	std::atomic<unsigned int> baked_probes;
+
+	unsigned int texture;
+	bool ready;
+
+private:
+	void Work() noexcept;
+	void BakeProbe(unsigned int index) noexcept;
+
+	glm::vec3 Trace(const glm::vec3 &origin, const glm::vec3 &dir) const noexcept;
+	bool Occluded(const glm::vec3 &origin, const glm::vec3 &target) const noexcept;
+	int Intersect(const glm::vec3 &origin, const glm::vec3 &dir, float max_distance, float &distance) const noexcept;
+
+	void Upload() noexcept;
+	void Join()   noexcept;
+
+public:
+	IrradianceVolume(const glm::vec3 &min, const glm::vec3 &max, const glm::ivec3 &resolution) noexcept;
+	~IrradianceVolume() noexcept;
+
+	void SetSampleCount(unsigned int sample_count) noexcept;
+
+	void Bake(const std::vector<Occluder> &occluders, const std::vector<Emitter> &emitters, const glm::vec3 sky_sh[9]) noexcept;
+
+	bool IsBaking() const noexcept;
+	bool IsReady()  const noexcept;
+
+	void Bind(const Shader *shader, unsigned int texture_unit) const noexcept;
+
+	void Update() noexcept;
+};
+
+//==============================================================================
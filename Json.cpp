@@ -0,0 +1,397 @@
+
+#include "Json.h"
+
+#include <cstdlib>
+#include <cstring>
+
+//==============================================================================
+
+const unsigned int Json::MAX_DEPTH;
+
+//==============================================================================
+
+void Json::SkipSpace(const char *&cursor, const char *end) noexcept
+{
+	while (cursor < end && (*cursor == ' ' || *cursor == '\t' || *cursor == '\n' || *cursor == '\r'))
+	{
+		cursor++;
+	}
+}
+
+//==============================================================================
+
+bool Json::ParseValue(const char *&cursor, const char *end, Json &value, unsigned int depth) noexcept
+{
+	SkipSpace(cursor, end);
+	if (cursor == end || depth > MAX_DEPTH)
+	{
+		return false;
+	}
+
+	switch (*cursor)
+	{
+	case '{':
+		value.type = Type::OBJECT;
+		cursor++;
+		SkipSpace(cursor, end);
+		if (cursor < end && *cursor == '}')
+		{
+			cursor++;
+			return true;
+		}
+
+		for (;;)
+		{
+			SkipSpace(cursor, end);
+
+			std::string name;
+			if (!ParseString(cursor, end, name))
+			{
+				return false;
+			}
+
+			SkipSpace(cursor, end);
+			if (cursor == end || *cursor != ':')
+			{
+				return false;
+			}
+			cursor++;
+
+			value.members.emplace_back(std::move(name), Json());
+			if (!ParseValue(cursor, end, value.members.back().second, depth + 1))
+			{
+				return false;
+			}
+
+			SkipSpace(cursor, end);
+			if (cursor < end && *cursor == ',')
+			{
+				cursor++;
+				continue;
+			}
+
+			if (cursor < end && *cursor == '}')
+			{
+				cursor++;
+				return true;
+			}
+
+			return false;
+		}
+
+	case '[':
+		value.type = Type::ARRAY;
+		cursor++;
+		SkipSpace(cursor, end);
+		if (cursor < end && *cursor == ']')
+		{
+			cursor++;
+			return true;
+		}
+
+		for (;;)
+		{
+			value.elements.emplace_back();
+			if (!ParseValue(cursor, end, value.elements.back(), depth + 1))
+			{
+				return false;
+			}
+
+			SkipSpace(cursor, end);
+			if (cursor < end && *cursor == ',')
+			{
+				cursor++;
+				continue;
+			}
+
+			if (cursor < end && *cursor == ']')
+			{
+				cursor++;
+				return true;
+			}
+
+			return false;
+		}
+
+	case '"':
+		value.type = Type::STRING;
+		return ParseString(cursor, end, value.string);
+
+	case 't':
+		value.type = Type::BOOLEAN;
+		value.boolean = true;
+		return ParseLiteral(cursor, end, "true");
+
+	case 'f':
+		value.type = Type::BOOLEAN;
+		value.boolean = false;
+		return ParseLiteral(cursor, end, "false");
+
+	case 'n':
+		value.type = Type::NUL;
+		return ParseLiteral(cursor, end, "null");
+
+	default:
+		value.type = Type::NUMBER;
+		return ParseNumber(cursor, end, value.number);
+	}
+}
+
+//==============================================================================
+
+bool Json::ParseString(const char *&cursor, const char *end, std::string &string) noexcept
+{
+	if (cursor == end || *cursor != '"')
+	{
+		return false;
+	}
+	cursor++;
+
+	while (cursor < end)
+	{
+		const auto c = *cursor++;
+		if (c == '"')
+		{
+			return true;
+		}
+
+		if (c != '\\')
+		{
+			string += c;
+			continue;
+		}
+
+		if (cursor == end)
+		{
+			return false;
+		}
+
+		switch (*cursor++)
+		{
+		case '"':  string += '"';  break;
+		case '\\': string += '\\'; break;
+		case '/':  string += '/';  break;
+		case 'b':  string += '\b'; break;
+		case 'f':  string += '\f'; break;
+		case 'n':  string += '\n'; break;
+		case 'r':  string += '\r'; break;
+		case 't':  string += '\t'; break;
+		case 'u':
+		{
+			// a surrogate pair is two escapes in a row
+			unsigned int code = 0;
+			for (unsigned int unit = 0; ; unit++)
+			{
+				if (end - cursor < 4)
+				{
+					return false;
+				}
+
+				char digits[5] = { cursor[0], cursor[1], cursor[2], cursor[3], '\0' };
+				char *last = nullptr;
+				const auto value = static_cast<unsigned int>(std::strtoul(digits, &last, 16));
+				if (last != digits + 4)
+				{
+					return false;
+				}
+				cursor += 4;
+
+				if (unit == 0 && value >= 0xD800 && value < 0xDC00 && end - cursor >= 2 && cursor[0] == '\\' && cursor[1] == 'u')
+				{
+					code = value;
+					cursor += 2;
+					continue;
+				}
+
+				code = unit == 0 ? value : 0x10000 + ((code - 0xD800) << 10) + (value - 0xDC00);
+				break;
+			}
+
+			AppendUTF8(code, string);
+			break;
+		}
+		default:
+			return false;
+		}
+	}
+
+	return false;
+}
+
+//==============================================================================
+
+bool Json::ParseNumber(const char *&cursor, const char *end, double &number) noexcept
+{
+	// strtod needs a terminated string and numbers are short
+	char digits[64];
+	size_t length = 0;
+	while (cursor + length < end && length < sizeof(digits) - 1 && std::strchr("+-0123456789.eE", cursor[length]))
+	{
+		digits[length] = cursor[length];
+		length++;
+	}
+	digits[length] = '\0';
+
+	char *last = nullptr;
+	number = std::strtod(digits, &last);
+	if (length == 0 || last != digits + length)
+	{
+		return false;
+	}
+
+	cursor += length;
+	return true;
+}
+
+//==============================================================================
+
+bool Json::ParseLiteral(const char *&cursor, const char *end, const char *literal) noexcept
+{
+	const auto length = std::strlen(literal);
+	if (static_cast<size_t>(end - cursor) < length || std::memcmp(cursor, literal, length) != 0)
+	{
+		return false;
+	}
+
+	cursor += length;
+	return true;
+}
+
+//==============================================================================
+
+void Json::AppendUTF8(unsigned int code, std::string &string) noexcept
+{
+	if (code < 0x80)
+	{
+		string += static_cast<char>(code);
+	}
+	else
+	if (code < 0x800)
+	{
+		string += static_cast<char>(0xC0 | (code >> 6));
+		string += static_cast<char>(0x80 | (code & 0x3F));
+	}
+	else
+	if (code < 0x10000)
+	{
+		string += static_cast<char>(0xE0 | (code >> 12));
+		string += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+		string += static_cast<char>(0x80 | (code & 0x3F));
+	}
+	else
+	{
+		string += static_cast<char>(0xF0 | (code >> 18));
+		string += static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+		string += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+		string += static_cast<char>(0x80 | (code & 0x3F));
+	}
+}
+
+//==============================================================================
+
+Json::Json() noexcept :
+	type(Type::NUL),
+	boolean(false),
+	number(0.0)
+{
+}
+
+//==============================================================================
+
+bool Json::Parse(const char *begin, const char *end) noexcept
+{
+	*this = Json();
+
+	auto cursor = begin;
+	if (!ParseValue(cursor, end, *this, 0))
+	{
+		*this = Json();
+		return false;
+	}
+
+	SkipSpace(cursor, end);
+	return cursor == end;
+}
+
+//==============================================================================
+
+Json::Type Json::GetType() const noexcept
+{
+	return type;
+}
+
+//==============================================================================
+
+bool Json::IsNull() const noexcept
+{
+	return type == Type::NUL;
+}
+
+//==============================================================================
+
+bool Json::GetBoolean(bool fallback) const noexcept
+{
+	return type == Type::BOOLEAN ? boolean : fallback;
+}
+
+//==============================================================================
+
+double Json::GetNumber(double fallback) const noexcept
+{
+	return type == Type::NUMBER ? number : fallback;
+}
+
+//==============================================================================
+
+const std::string &Json::GetString() const noexcept
+{
+	return string;
+}
+
+//==============================================================================
+
+size_t Json::GetSize() const noexcept
+{
+	return type == Type::ARRAY ? elements.size() : type == Type::OBJECT ? members.size() : 0;
+}
+
+//==============================================================================
+
+const Json &Json::Get(size_t index) const noexcept
+{
+	static const Json null;
+	return type == Type::ARRAY && index < elements.size() ? elements[index] : null;
+}
+
+//==============================================================================
+
+const Json &Json::Get(const std::string &name) const noexcept
+{
+	static const Json null;
+	for (const auto &member : members)
+	{
+		if (member.first == name)
+		{
+			return member.second;
+		}
+	}
+
+	return null;
+}
+
+//==============================================================================
+
+bool Json::Has(const std::string &name) const noexcept
+{
+	for (const auto &member : members)
+	{
+		if (member.first == name)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+//==============================================================================
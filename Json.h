@@ -0,0 +1,60 @@
+
+#pragma once
+
+//==============================================================================
+
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+//==============================================================================
+
+// a parsed JSON document, e.g. a glTF chunk; read-only after Parse(), and a
+// lookup that misses returns a null value instead of failing, so optional
+// members are read as Get("a").Get("b").GetNumber(default)
+class Json
+{
+public:
+	enum class Type { NUL, BOOLEAN, NUMBER, STRING, ARRAY, OBJECT };
+
+private:
+	// nesting past this is rejected rather than recursed into
+	static const unsigned int MAX_DEPTH = 64;
+
+	Type type;
+	bool boolean;
+	double number;
+	std::string string;
+	std::vector<Json> elements;
+	std::vector<std::pair<std::string, Json>> members;
+
+private:
+	static void SkipSpace(const char *&cursor, const char *end) noexcept;
+	static bool ParseValue(const char *&cursor, const char *end, Json &value, unsigned int depth) noexcept;
+	static bool ParseString(const char *&cursor, const char *end, std::string &string) noexcept;
+	static bool ParseNumber(const char *&cursor, const char *end, double &number) noexcept;
+	static bool ParseLiteral(const char *&cursor, const char *end, const char *literal) noexcept;
+	static void AppendUTF8(unsigned int code, std::string &string) noexcept;
+
+public:
+	Json() noexcept;
+
+	// the whole range has to be one value, surrounded by white space at most
+	bool Parse(const char *begin, const char *end) noexcept;
+
+	Type GetType() const noexcept;
+	bool IsNull() const noexcept;
+
+	bool GetBoolean(bool fallback = false) const noexcept;
+	double GetNumber(double fallback = 0.0) const noexcept;
+	const std::string &GetString() const noexcept;
+
+	// elements of an array, members of an object, zero otherwise
+	size_t GetSize() const noexcept;
+	const Json &Get(size_t index) const noexcept;
+	const Json &Get(const std::string &name) const noexcept;
+	bool Has(const std::string &name) const noexcept;
+};
+
+//==============================================================================
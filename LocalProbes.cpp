@@ -0,0 +1,225 @@
+
+#include "LocalProbes.h"
+
+#include "Cubemap.h"
+#include "ReflectionProbe.h"
+#include "Scene.h"
+
+#include <algorithm>
+#include <iostream>
+#include <utility>
+
+#include "GLAD/glad.h"
+
+//==============================================================================
+
+const unsigned int LocalProbes::MAX_PROBES;
+const unsigned int LocalProbes::MAX_SELECTED;
+
+//==============================================================================
+
+unsigned int LocalProbes::CreateArray(unsigned int size, unsigned int levels, HDRFormat format) const noexcept
+{
+	unsigned int array = 0;
+	glGenTextures(1, &array);
+	glBindTexture(GL_TEXTURE_CUBE_MAP_ARRAY, array);
+
+	const auto layers = static_cast<unsigned int>(6 * probes.size());
+	for (unsigned int mip = 0; mip < levels; mip++)
+	{
+		glTexImage3D(GL_TEXTURE_CUBE_MAP_ARRAY, mip, GetInternalFormat(format), size >> mip, size >> mip, layers, 0, GL_RGB, GL_FLOAT, nullptr);
+	}
+
+	glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_MIN_FILTER, levels > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_MAX_LEVEL, levels - 1);
+
+	glBindTexture(GL_TEXTURE_CUBE_MAP_ARRAY, 0);
+
+	return array;
+}
+
+//==============================================================================
+
+LocalProbes::LocalProbes() noexcept :
+	irradiance_array(0),
+	prefilter_array(0),
+	UBO(0),
+	ready(false)
+{
+	// std140: two vec4 per probe, see Bake()
+	const std::vector<glm::vec4> zero(2 * MAX_PROBES, glm::vec4(0.0f));
+
+	glGenBuffers(1, &UBO);
+	glBindBuffer(GL_UNIFORM_BUFFER, UBO);
+	glBufferData(GL_UNIFORM_BUFFER, zero.size() * sizeof(glm::vec4), zero.data(), GL_STATIC_DRAW);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+//==============================================================================
+
+LocalProbes::~LocalProbes() noexcept
+{
+	glDeleteTextures(1, &irradiance_array);
+	glDeleteTextures(1, &prefilter_array);
+	glDeleteBuffers(1, &UBO);
+}
+
+//==============================================================================
+
+unsigned int LocalProbes::Add(const glm::vec3 &position, Shape shape, const glm::vec3 &extents, float blend, const Drawable *owner) noexcept
+{
+	if (probes.size() == MAX_PROBES)
+	{
+		std::cout << "error: local probe limit of " << MAX_PROBES << " is reached" << std::endl;
+		return MAX_PROBES;
+	}
+
+	probes.push_back({ position, shape, extents, blend, owner });
+	ready = false;
+
+	return static_cast<unsigned int>(probes.size() - 1);
+}
+
+//==============================================================================
+
+unsigned int LocalProbes::GetCount() const noexcept
+{
+	return static_cast<unsigned int>(probes.size());
+}
+
+//==============================================================================
+
+bool LocalProbes::IsReady() const noexcept
+{
+	return ready;
+}
+
+//==============================================================================
+
+void LocalProbes::Bake(const Scene &scene) noexcept
+{
+	ready = false;
+
+	glDeleteTextures(1, &irradiance_array);
+	glDeleteTextures(1, &prefilter_array);
+	irradiance_array = 0;
+	prefilter_array  = 0;
+
+	if (probes.empty())
+	{
+		return;
+	}
+
+	const auto &quality = scene.GetQuality();
+	const auto irradiance_size = quality.irradiance_size;
+	const auto prefilter_size  = quality.prefilter_size;
+	const auto mip_levels      = quality.prefilter_mips;
+
+	// the same renderable format as the capture probe, glCopyImageSubData needs it
+	const auto format = GetRenderableFormat(quality.format);
+
+	irradiance_array = CreateArray(irradiance_size, 1, format);
+	prefilter_array  = CreateArray(prefilter_size, mip_levels, format);
+
+	// every probe is captured by one reusable probe and copied into its layers
+	ReflectionProbe capture(probes[0].position, quality);
+	capture.SetSchedule(capture.GetStepCount(), 0);
+
+	for (unsigned int i = 0; i < probes.size(); i++)
+	{
+		capture.SetPosition(probes[i].position);
+		capture.SetOwner(probes[i].owner);
+		capture.Update(scene);
+
+		glCopyImageSubData(
+			capture.GetIrradianceMap()->GetID(), GL_TEXTURE_CUBE_MAP, 0, 0, 0, 0,
+			irradiance_array, GL_TEXTURE_CUBE_MAP_ARRAY, 0, 0, 0, 6 * i,
+			irradiance_size, irradiance_size, 6);
+
+		for (unsigned int mip = 0; mip < mip_levels; mip++)
+		{
+			glCopyImageSubData(
+				capture.GetPrefilterMap()->GetID(), GL_TEXTURE_CUBE_MAP, mip, 0, 0, 0,
+				prefilter_array, GL_TEXTURE_CUBE_MAP_ARRAY, mip, 0, 0, 6 * i,
+				prefilter_size >> mip, prefilter_size >> mip, 6);
+		}
+	}
+
+	// std140: position.xyz + shape, extents.xyz + blend distance
+	std::vector<glm::vec4> data;
+	for (const auto &probe : probes)
+	{
+		data.emplace_back(probe.position, probe.shape == Shape::BOX ? 0.0f : 1.0f);
+		data.emplace_back(probe.extents, probe.blend);
+	}
+
+	glBindBuffer(GL_UNIFORM_BUFFER, UBO);
+	glBufferSubData(GL_UNIFORM_BUFFER, 0, data.size() * sizeof(glm::vec4), &data[0]);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+	ready = true;
+}
+
+//==============================================================================
+
+unsigned int LocalProbes::Select(const glm::vec4 &bounds, glm::ivec4 &indices) const noexcept
+{
+	const glm::vec3 center(bounds);
+	const auto radius = bounds.w;
+
+	// candidates overlapping the bounding sphere, smallest volume first
+	std::vector<std::pair<float, int>> candidates;
+
+	for (unsigned int i = 0; i < probes.size(); i++)
+	{
+		const auto &probe = probes[i];
+		const auto local = center - probe.position;
+
+		float distance = 0.0f;
+		float volume   = 0.0f;
+
+		if (probe.shape == Shape::BOX)
+		{
+			distance = glm::length(local - glm::clamp(local, -probe.extents, probe.extents));
+			volume   = probe.extents.x * probe.extents.y * probe.extents.z;
+		}
+		else
+		{
+			distance = std::max(0.0f, glm::length(local) - probe.extents.x);
+			volume   = probe.extents.x * probe.extents.x * probe.extents.x;
+		}
+
+		if (distance < radius)
+		{
+			candidates.emplace_back(volume, i);
+		}
+	}
+
+	std::sort(candidates.begin(), candidates.end());
+
+	const auto count = std::min(static_cast<unsigned int>(candidates.size()), MAX_SELECTED);
+	for (unsigned int i = 0; i < count; i++)
+	{
+		indices[i] = candidates[i].second;
+	}
+
+	return count;
+}
+
+//==============================================================================
+
+void LocalProbes::Bind(unsigned int irradiance_unit, unsigned int prefilter_unit, unsigned int binding) const noexcept
+{
+	glActiveTexture(GL_TEXTURE0 + irradiance_unit);
+	glBindTexture(GL_TEXTURE_CUBE_MAP_ARRAY, irradiance_array);
+	glActiveTexture(GL_TEXTURE0 + prefilter_unit);
+	glBindTexture(GL_TEXTURE_CUBE_MAP_ARRAY, prefilter_array);
+
+	glBindBufferBase(GL_UNIFORM_BUFFER, binding, UBO);
+}
+
+//==============================================================================
@@ -0,0 +1,69 @@
+
+#pragma once
+
+//==============================================================================
+
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "HDRFormat.h"
+
+//==============================================================================
+
+class Drawable;
+class Scene;
+
+//==============================================================================
+
+class LocalProbes
+{
+public:
+	enum class Shape { BOX, SPHERE };
+
+	static const unsigned int MAX_PROBES = 64;
+	static const unsigned int MAX_SELECTED = 4;
+
+private:
+	struct Probe
+	{
+		glm::vec3 position;
+		Shape shape;
+		glm::vec3 extents;
+		float blend;
+		const Drawable *owner;
+	};
+
+private:
+	std::vector<Probe> probes;
+
+	unsigned int irradiance_array;
+	unsigned int prefilter_array;
+	unsigned int UBO; // MAX_PROBES entries from the start, zero until baked
+
+	bool ready;
+
+private:
+	unsigned int CreateArray(unsigned int size, unsigned int levels, HDRFormat format) const noexcept;
+
+public:
+	LocalProbes() noexcept;
+	~LocalProbes() noexcept;
+
+	// owner is an object the probe sits inside, left out of its capture, see
+	// ReflectionProbe::SetOwner()
+	unsigned int Add(const glm::vec3 &position, Shape shape, const glm::vec3 &extents, float blend, const Drawable *owner = nullptr) noexcept;
+
+	unsigned int GetCount() const noexcept;
+	bool IsReady()          const noexcept;
+
+	void Bake(const Scene &scene) noexcept;
+
+	unsigned int Select(const glm::vec4 &bounds, glm::ivec4 &indices) const noexcept;
+
+	// valid before the bake and without probes too, the uniform block every IBL
+	// variant declares is then zero
+	void Bind(unsigned int irradiance_unit, unsigned int prefilter_unit, unsigned int binding) const noexcept;
+};
+
+//==============================================================================
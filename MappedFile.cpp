@@ -0,0 +1,117 @@
+
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+//==============================================================================
+
+MappedFile::MappedFile() noexcept :
+	data(nullptr),
+	size(0)
+{
+}
+
+//==============================================================================
+
+MappedFile::~MappedFile() noexcept
+{
+	Close();
+}
+
+//==============================================================================
+
+bool MappedFile::Open(const std::string &path) noexcept
+{
+	Close();
+
+	// the view keeps the file and the mapping alive, their handles are not needed
+#ifdef _WIN32
+	const auto file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_RANDOM_ACCESS, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+
+	LARGE_INTEGER file_size;
+	GetFileSizeEx(file, &file_size);
+
+	const auto mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	CloseHandle(file);
+
+	if (mapping)
+	{
+		data = static_cast<const unsigned char *>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+		size = data ? static_cast<size_t>(file_size.QuadPart) : 0;
+		CloseHandle(mapping);
+	}
+#else
+	const auto file = open(path.c_str(), O_RDONLY);
+	if (file < 0)
+	{
+		return false;
+	}
+
+	struct stat info;
+	if (fstat(file, &info) == 0 && info.st_size > 0)
+	{
+		const auto view = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_SHARED, file, 0);
+		if (view != MAP_FAILED)
+		{
+			data = static_cast<const unsigned char *>(view);
+			size = static_cast<size_t>(info.st_size);
+		}
+	}
+	close(file);
+#endif
+
+	return data != nullptr;
+}
+
+//==============================================================================
+
+void MappedFile::Close() noexcept
+{
+	if (data)
+	{
+#ifdef _WIN32
+		UnmapViewOfFile(data);
+#else
+		munmap(const_cast<unsigned char *>(data), size);
+#endif
+	}
+
+	data = nullptr;
+	size = 0;
+}
+
+//==============================================================================
+
+bool MappedFile::IsOpen() const noexcept
+{
+	return data != nullptr;
+}
+
+//==============================================================================
+
+const unsigned char *MappedFile::GetData() const noexcept
+{
+	return data;
+}
+
+//==============================================================================
+
+size_t MappedFile::GetSize() const noexcept
+{
+	return size;
+}
+
+//==============================================================================
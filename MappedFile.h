@@ -0,0 +1,33 @@
+
+#pragma once
+
+//==============================================================================
+
+#include <cstddef>
+#include <string>
+
+//==============================================================================
+
+// a whole file mapped read-only; the pages are read in on first touch, so
+// several threads reading disjoint ranges load it at disk speed
+class MappedFile
+{
+private:
+	const unsigned char *data;
+	size_t size;
+
+public:
+	MappedFile() noexcept;
+	~MappedFile() noexcept;
+
+	// a missing file fails quietly, the caller decides whether it is an error
+	bool Open(const std::string &path) noexcept;
+	void Close() noexcept;
+
+	bool IsOpen() const noexcept;
+
+	const unsigned char *GetData() const noexcept;
+	size_t GetSize() const noexcept;
+};
+
+//==============================================================================
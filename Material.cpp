@@ -1,6 +1,8 @@
 
 #include "Material.h"
 
+#include "Texture.h"
+
 //==============================================================================
 
 Material::Material() noexcept :
@@ -8,7 +10,8 @@ Material::Material() noexcept :
 	normal(nullptr),
 	metallic(nullptr),
 	roughness(nullptr),
-	ao(nullptr)
+	ao(nullptr),
+	orm(nullptr)
 {
 }
 
@@ -49,6 +52,29 @@ Texture *Material::GetAO() const noexcept
 
 //==============================================================================
 
+Texture *Material::GetORM() const noexcept
+{
+	return orm;
+}
+
+//==============================================================================
+
+glm::vec2 Material::GetRoughnessRange() const noexcept
+{
+	// the range covers the first channel only, which is the occlusion of a packed map
+	return roughness && !orm ? roughness->GetRange() : glm::vec2(0.0f, 1.0f);
+}
+
+//==============================================================================
+
+glm::vec3 Material::GetAverageAlbedo() const noexcept
+{
+	// linear, like the albedo lookup in pbr.fs
+	return albedo ? glm::pow(albedo->GetAverage(), glm::vec3(2.2f)) : glm::vec3(0.5f);
+}
+
+//==============================================================================
+
 void Material::SetAlbedo(Texture *albedo) noexcept
 {
 	this->albedo = albedo;
@@ -83,3 +109,10 @@ void Material::SetAO(Texture *ao) noexcept
 }
 
 //==============================================================================
+
+void Material::SetORM(Texture *orm) noexcept
+{
+	this->orm = orm;
+}
+
+//==============================================================================
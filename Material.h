@@ -5,6 +5,8 @@
 
 #include <string>
 
+#include <glm/glm.hpp>
+
 //==============================================================================
 
 class Texture;
@@ -20,6 +22,9 @@ private:
 	Texture *roughness;
 	Texture *ao;
 
+	// occlusion, roughness and metallic in r, g and b, replaces the three maps above
+	Texture *orm;
+
 public:
 	Material() noexcept;
 
@@ -28,12 +33,17 @@ public:
 	Texture *GetMetallic()  const noexcept;
 	Texture *GetRoughness() const noexcept;
 	Texture *GetAO()        const noexcept;
+	Texture *GetORM()       const noexcept;
+
+	glm::vec2 GetRoughnessRange() const noexcept;
+	glm::vec3 GetAverageAlbedo()  const noexcept;
 
 	void SetAlbedo    (Texture *albedo)    noexcept;
 	void SetNormal    (Texture *normal)    noexcept;
 	void SetMetallic  (Texture *metallic)  noexcept;
 	void SetRoughness (Texture *roughness) noexcept;
 	void SetAO        (Texture *ao)        noexcept;
+	void SetORM       (Texture *orm)       noexcept;
 };
 
 //==============================================================================
@@ -0,0 +1,350 @@
+
+#include "Mesh.h"
+
+#include <iostream>
+#include <utility>
+
+#include "GLAD/glad.h"
+
+//==============================================================================
+
+Mesh::Mesh() noexcept :
+	vertex_count(0),
+	index_capacity(0),
+	normals(false),
+	uvs(false),
+	tangents(false),
+	double_sided(false),
+	shared(false),
+	simplify(false),
+	vertices(nullptr),
+	indices(nullptr),
+	meshlet_count(0),
+	meshlet_buffer(0),
+	visibility_buffer(0),
+	command_buffers(),
+	commands(0)
+{
+	glGenBuffers(1, &EBO);
+}
+
+//==============================================================================
+
+Mesh::~Mesh() noexcept
+{
+	// the names stay the source's, Drawable must not delete them
+	if (shared)
+	{
+		VBO = 0;
+		EBO = 0;
+	}
+
+	glDeleteBuffers(1, &meshlet_buffer);
+	glDeleteBuffers(1, &visibility_buffer);
+	glDeleteBuffers(COMMAND_BUFFERS, command_buffers);
+}
+
+//==============================================================================
+
+bool Mesh::Map(size_t vertex_count, size_t index_count, bool normals, bool uvs, bool levels) noexcept
+{
+	this->vertex_count = vertex_count;
+	this->normals      = normals;
+	this->uvs          = uvs;
+	tangents           = normals && uvs;
+	simplify           = levels;
+	index_capacity     = index_count;
+
+	const auto vertex_size = GetVertexSize(vertex_count, normals, uvs, tangents, VertexFormat::Position::FLOAT);
+	const auto index_size  = GetIndexSize((levels ? 2 : 1) * index_count, vertex_count);
+	if (vertex_size == 0 || index_size == 0)
+	{
+		return false;
+	}
+
+	// the copy target binds a buffer without touching the VAO's element buffer
+	const auto flags = GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT;
+
+	glBindBuffer(GL_COPY_WRITE_BUFFER, VBO);
+	glBufferData(GL_COPY_WRITE_BUFFER, vertex_size, nullptr, GL_STATIC_DRAW);
+	vertices = static_cast<unsigned char *>(glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, vertex_size, flags));
+
+	glBindBuffer(GL_COPY_WRITE_BUFFER, EBO);
+	glBufferData(GL_COPY_WRITE_BUFFER, index_size, nullptr, GL_STATIC_DRAW);
+	indices = static_cast<unsigned char *>(glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, index_size, flags));
+
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+	vertex_memory = vertex_size;
+	index_memory  = index_size;
+
+	return vertices && indices;
+}
+
+//==============================================================================
+
+bool Mesh::Fill(const std::vector<glm::vec3> &positions, const std::vector<glm::vec3> &normals,
+	const std::vector<glm::vec2> &uvs, const std::vector<glm::vec4> &tangents, const std::vector<unsigned int> &indices) noexcept
+{
+	if (!vertices || !this->indices || positions.size() != vertex_count || indices.size() > index_capacity ||
+		normals.empty() == this->normals || uvs.empty() == this->uvs || (!tangents.empty() && (!this->tangents || tangents.size() != vertex_count)))
+	{
+		return false;
+	}
+
+	// every level from the one before it, so the errors add up
+	std::vector<std::vector<unsigned int>> levels(1, indices);
+	std::vector<float> errors(1, 0.0f);
+	while (simplify && levels.size() < MAX_LEVELS && levels.back().size() / 3 >= 2 * LEVEL_MIN_TRIANGLES)
+	{
+		const auto target = levels.back().size() / 6 * 3;
+
+		auto error = 0.0f;
+		auto simplified = MeshOptimizer::Simplify(levels.back(), positions, target, error);
+		if (simplified.size() > target)
+		{
+			break;
+		}
+
+		MeshOptimizer::OptimizeVertexCache(simplified, positions.size());
+		errors.push_back(errors.back() + error);
+		levels.push_back(std::move(simplified));
+	}
+
+	if (this->tangents && tangents.empty())
+	{
+		PackVertices(positions, normals, uvs, MeshOptimizer::GenerateTangents(indices, positions, normals, uvs), VertexFormat::Position::FLOAT, vertices);
+	}
+	else
+	{
+		PackVertices(positions, normals, uvs, tangents, VertexFormat::Position::FLOAT, vertices);
+	}
+	PackLevels(levels, errors, GL_TRIANGLES, vertex_count, this->indices);
+
+	if (indices.size() / 3 >= MESHLET_MIN_TRIANGLES)
+	{
+		meshlets = MeshOptimizer::BuildMeshlets(indices, positions);
+	}
+
+	return true;
+}
+
+
+//==============================================================================
+
+bool Mesh::Unmap() noexcept
+{
+	// the contents are undefined when the driver lost them, e.g. on a mode switch
+	auto intact = true;
+
+	if (vertices)
+	{
+		glBindBuffer(GL_COPY_WRITE_BUFFER, VBO);
+		intact = glUnmapBuffer(GL_COPY_WRITE_BUFFER) == GL_TRUE && intact;
+		vertices = nullptr;
+	}
+
+	if (indices)
+	{
+		glBindBuffer(GL_COPY_WRITE_BUFFER, EBO);
+		intact = glUnmapBuffer(GL_COPY_WRITE_BUFFER) == GL_TRUE && intact;
+		indices = nullptr;
+	}
+
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+	if (!intact)
+	{
+		std::cout << "error: mesh buffers were lost while mapped" << std::endl;
+		return false;
+	}
+
+	SetLayout(vertex_count, normals, uvs, tangents, VertexFormat::Position::FLOAT);
+
+	glBindVertexArray(VAO);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+	glBindVertexArray(0);
+
+	if (!meshlets.empty())
+	{
+		meshlet_count = static_cast<unsigned int>(meshlets.size());
+
+		glGenBuffers(1, &meshlet_buffer);
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, meshlet_buffer);
+		glBufferData(GL_SHADER_STORAGE_BUFFER, meshlets.size() * sizeof(MeshOptimizer::Meshlet), meshlets.data(), GL_STATIC_DRAW);
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+		CreateCullBuffers();
+		std::vector<MeshOptimizer::Meshlet>().swap(meshlets);
+	}
+
+	return true;
+}
+
+//==============================================================================
+
+bool Mesh::Share(const Mesh &source) noexcept
+{
+	if (vertices || indices || source.vertices || source.indices || source.shared || shared)
+	{
+		return false;
+	}
+
+	vertex_count    = source.vertex_count;
+	normals         = source.normals;
+	uvs             = source.uvs;
+	tangents        = source.tangents;
+	position_decode = source.position_decode;
+	radius          = source.radius;
+	index_count     = source.index_count;
+	index_type      = source.index_type;
+	mode            = source.mode;
+	statistics      = source.statistics;
+	levels          = source.levels;
+
+	glDeleteBuffers(1, &VBO);
+	glDeleteBuffers(1, &EBO);
+	VBO = source.VBO;
+	EBO = source.EBO;
+	shared = true;
+
+	SetLayout(vertex_count, normals, uvs, tangents, VertexFormat::Position::FLOAT);
+
+	glBindVertexArray(VAO);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+	glBindVertexArray(0);
+
+	// counted once, with the source
+	vertex_memory = 0;
+	index_memory  = 0;
+
+	// a copy of the meshlets, so the source may go first here as well
+	if (source.meshlet_count)
+	{
+		meshlet_count = source.meshlet_count;
+
+		const auto size = meshlet_count * sizeof(MeshOptimizer::Meshlet);
+		glGenBuffers(1, &meshlet_buffer);
+		glBindBuffer(GL_COPY_READ_BUFFER, source.meshlet_buffer);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, meshlet_buffer);
+		glBufferData(GL_COPY_WRITE_BUFFER, size, nullptr, GL_STATIC_DRAW);
+		glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, size);
+		glBindBuffer(GL_COPY_READ_BUFFER, 0);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+		CreateCullBuffers();
+	}
+
+	return true;
+}
+
+//==============================================================================
+
+void Mesh::CreateCullBuffers() noexcept
+{
+	// nothing was visible last frame
+	glGenBuffers(1, &visibility_buffer);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, visibility_buffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, meshlet_count * sizeof(unsigned int), nullptr, GL_DYNAMIC_COPY);
+	glClearBufferData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+
+	// count, instance count, first index, base vertex and base instance
+	glGenBuffers(COMMAND_BUFFERS, command_buffers);
+	for (const auto buffer : command_buffers)
+	{
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffer);
+		glBufferData(GL_SHADER_STORAGE_BUFFER, meshlet_count * 5 * sizeof(unsigned int), nullptr, GL_DYNAMIC_COPY);
+		glClearBufferData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+	}
+
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+//==============================================================================
+
+void Mesh::SetDoubleSided(bool double_sided) noexcept
+{
+	this->double_sided = double_sided;
+}
+
+//==============================================================================
+
+bool Mesh::IsDoubleSided() const noexcept
+{
+	return double_sided;
+}
+
+//==============================================================================
+
+unsigned int Mesh::GetMeshletCount() const noexcept
+{
+	return meshlet_count;
+}
+
+//==============================================================================
+
+unsigned int Mesh::GetMeshletBuffer() const noexcept
+{
+	return meshlet_buffer;
+}
+
+//==============================================================================
+
+unsigned int Mesh::GetVisibilityBuffer() const noexcept
+{
+	return visibility_buffer;
+}
+
+//==============================================================================
+
+unsigned int Mesh::GetCommandBuffer(unsigned int i) const noexcept
+{
+	return i < COMMAND_BUFFERS ? command_buffers[i] : 0;
+}
+
+//==============================================================================
+
+void Mesh::SetCommands(unsigned int buffer) noexcept
+{
+	commands = buffer;
+}
+
+//==============================================================================
+
+void Mesh::DrawTriangles() const noexcept
+{
+	if (!commands)
+	{
+		DrawElements();
+		return;
+	}
+
+	// the culled meshlets are commands of no indices
+	glBindVertexArray(VAO);
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commands);
+	glMultiDrawElementsIndirect(mode, index_type, nullptr, meshlet_count, 0);
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+	glBindVertexArray(0);
+}
+
+//==============================================================================
+
+void Mesh::Draw() const noexcept
+{
+	if (double_sided)
+	{
+		DrawTriangles();
+		return;
+	}
+
+	// a mirroring model turns the winding around
+	glEnable(GL_CULL_FACE);
+	glCullFace(glm::determinant(glm::mat3(model)) < 0.0f ? GL_FRONT : GL_BACK);
+
+	DrawTriangles();
+
+	glCullFace(GL_BACK);
+	glDisable(GL_CULL_FACE);
+}
+
+//==============================================================================
@@ -0,0 +1,103 @@
+
+#pragma once
+
+//==============================================================================
+
+#include <cstddef>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "Drawable.h"
+
+//==============================================================================
+
+// an indexed triangle list read from a file, see GltfLoader; Map() allocates
+// and maps its buffers on the GL thread, any thread may Fill() them, and
+// Unmap() hands them back to GL before the first draw
+//
+// Fill() also simplifies the mesh into levels of detail when Map() was asked
+// for them, see MeshOptimizer::Simplify(), and splits large meshes into meshlets, see
+// MeshOptimizer::BuildMeshlets(), which ClusterCuller culls on the GPU into
+// indirect draw commands; the meshlets cover the finest level only
+class Mesh : public Drawable
+{
+public:
+	// meshes with fewer triangles are drawn whole, culling them in pieces costs
+	// more than it saves
+	static const size_t MESHLET_MIN_TRIANGLES = 4096;
+
+	// each level of detail has at most half the triangles of the one before,
+	// down to about this many
+	static const size_t LEVEL_MIN_TRIANGLES = 32;
+
+	// command buffers per mesh, one for each pass of the culler
+	static const unsigned int COMMAND_BUFFERS = 2;
+
+private:
+	size_t vertex_count;
+	size_t index_capacity;
+	bool normals;
+	bool uvs;
+	bool tangents; // with both normals and uvs
+	bool double_sided;
+	bool shared; // VBO and EBO are another instance's, see Share()
+	bool simplify;
+
+	unsigned char *vertices;
+	unsigned char *indices;
+
+	// until Unmap() uploads them
+	std::vector<MeshOptimizer::Meshlet> meshlets;
+
+	unsigned int meshlet_count;
+	unsigned int meshlet_buffer;
+	unsigned int visibility_buffer; // one uint per meshlet for the culler, 0 at first
+	unsigned int command_buffers[COMMAND_BUFFERS];
+	unsigned int commands;
+
+private:
+	// the visibility and command buffers for meshlet_count meshlets, cleared
+	void CreateCullBuffers() noexcept;
+
+	void DrawTriangles() const noexcept;
+
+public:
+	Mesh() noexcept;
+	~Mesh() noexcept;
+
+	// index_count is an upper bound on the finest level, the filled indices
+	// may be fewer; with levels the levels of detail take at most as many again
+	bool Map(size_t vertex_count, size_t index_count, bool normals, bool uvs, bool levels) noexcept;
+
+	// positions stay float: neighbouring meshes quantized to bounds of their own
+	// would open cracks along the edges they share; tangents may be left empty,
+	// they are then generated, see MeshOptimizer::GenerateTangents()
+	bool Fill(const std::vector<glm::vec3> &positions, const std::vector<glm::vec3> &normals,
+		const std::vector<glm::vec2> &uvs, const std::vector<glm::vec4> &tangents, const std::vector<unsigned int> &indices) noexcept;
+
+	bool Unmap() noexcept;
+
+	// draws the buffers of another instance after its Unmap(), only the model,
+	// material and culling state are this mesh's own; the VAO keeps the buffers
+	// alive in GL, so the source may be deleted first
+	bool Share(const Mesh &source) noexcept;
+
+	void SetDoubleSided(bool double_sided) noexcept;
+	bool IsDoubleSided() const noexcept;
+
+	// 0 without meshlets; the buffers are GL_SHADER_STORAGE_BUFFER sized for them,
+	// each command buffer holds one DrawElementsIndirectCommand per meshlet
+	unsigned int GetMeshletCount() const                 noexcept;
+	unsigned int GetMeshletBuffer() const                noexcept;
+	unsigned int GetVisibilityBuffer() const             noexcept;
+	unsigned int GetCommandBuffer(unsigned int i) const  noexcept;
+
+	// draws the commands of one of the command buffers instead of every
+	// triangle, until it is set back to 0
+	void SetCommands(unsigned int buffer) noexcept;
+
+	void Draw() const noexcept override;
+};
+
+//==============================================================================
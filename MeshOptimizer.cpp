@@ -0,0 +1,886 @@
+
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+//==============================================================================
+
+float MeshOptimizer::GetVertexScore(int cache_position, unsigned int remaining) noexcept
+{
+	// nothing left to draw with it
+	if (remaining == 0)
+	{
+		return -1.0f;
+	}
+
+	auto score = 0.0f;
+	if (cache_position >= 0)
+	{
+		// the last triangle's vertices get a fixed score, so that the next
+		// triangle does not simply share an edge with the last one
+		if (cache_position < 3)
+		{
+			score = 0.75f;
+		}
+		else
+		{
+			const auto scale = 1.0f / (SCORING_CACHE_SIZE - 3);
+			score = std::pow(1.0f - (cache_position - 3) * scale, 1.5f);
+		}
+	}
+
+	// vertices with few triangles left are finished first, no dangling triangles
+	return score + 2.0f / std::sqrt(static_cast<float>(remaining));
+}
+
+//==============================================================================
+
+unsigned int MeshOptimizer::CountMisses(const unsigned int *triangle, std::vector<unsigned int> &timestamps, unsigned int &timestamp) noexcept
+{
+	unsigned int misses = 0;
+	for (unsigned int k = 0; k < 3; k++)
+	{
+		auto &cached = timestamps[triangle[k]];
+		if (timestamp - cached > CACHE_SIZE)
+		{
+			cached = timestamp++;
+			misses++;
+		}
+	}
+
+	return misses;
+}
+
+//==============================================================================
+
+std::vector<unsigned int> MeshOptimizer::StripToList(const std::vector<unsigned int> &strip) noexcept
+{
+	std::vector<unsigned int> indices;
+	for (size_t i = 2; i < strip.size(); i++)
+	{
+		const auto a = strip[i - 2];
+		const auto b = strip[i - 1];
+		const auto c = strip[i];
+
+		if (a == b || b == c || a == c)
+		{
+			continue;
+		}
+
+		if (i % 2 == 0)
+		{
+			indices.insert(indices.end(), { a, b, c });
+		}
+		else
+		{
+			indices.insert(indices.end(), { b, a, c });
+		}
+	}
+
+	return indices;
+}
+
+//==============================================================================
+
+MeshOptimizer::Statistics MeshOptimizer::Analyze(const std::vector<unsigned int> &indices, size_t vertex_count) noexcept
+{
+	std::vector<unsigned int> timestamps(vertex_count, 0);
+	auto timestamp = CACHE_SIZE + 1;
+
+	std::vector<bool> used(vertex_count, false);
+	size_t used_count = 0;
+
+	size_t misses = 0;
+	for (size_t i = 0; i + 2 < indices.size(); i += 3)
+	{
+		misses += CountMisses(&indices[i], timestamps, timestamp);
+
+		for (size_t k = i; k < i + 3; k++)
+		{
+			if (!used[indices[k]])
+			{
+				used[indices[k]] = true;
+				used_count++;
+			}
+		}
+	}
+
+	const auto triangle_count = indices.size() / 3;
+
+	Statistics statistics;
+	statistics.acmr = triangle_count ? static_cast<float>(misses) / triangle_count : 0.0f;
+	statistics.atvr = used_count ? static_cast<float>(misses) / used_count : 0.0f;
+	return statistics;
+}
+
+//==============================================================================
+
+void MeshOptimizer::OptimizeVertexCache(std::vector<unsigned int> &indices, size_t vertex_count) noexcept
+{
+	const auto triangle_count = indices.size() / 3;
+	if (triangle_count == 0)
+	{
+		return;
+	}
+
+	// the triangles around each vertex not drawn yet, packed into one array
+	std::vector<unsigned int> remaining(vertex_count, 0);
+	for (auto index : indices)
+	{
+		remaining[index]++;
+	}
+
+	std::vector<unsigned int> offsets(vertex_count + 1, 0);
+	for (size_t v = 0; v < vertex_count; v++)
+	{
+		offsets[v + 1] = offsets[v] + remaining[v];
+	}
+
+	std::vector<unsigned int> adjacency(indices.size());
+	std::vector<unsigned int> fill(offsets.begin(), offsets.end() - 1);
+	for (size_t i = 0; i < indices.size(); i++)
+	{
+		adjacency[fill[indices[i]]++] = static_cast<unsigned int>(i / 3);
+	}
+
+	std::vector<int> cache_position(vertex_count, -1);
+	std::vector<float> vertex_score(vertex_count);
+	for (size_t v = 0; v < vertex_count; v++)
+	{
+		vertex_score[v] = GetVertexScore(-1, remaining[v]);
+	}
+
+	std::vector<float> triangle_score(triangle_count);
+	for (size_t t = 0; t < triangle_count; t++)
+	{
+		triangle_score[t] = vertex_score[indices[3 * t]] + vertex_score[indices[3 * t + 1]] + vertex_score[indices[3 * t + 2]];
+	}
+
+	std::vector<bool> emitted(triangle_count, false);
+
+	std::vector<unsigned int> cache;
+	std::vector<unsigned int> next_cache;
+	cache.reserve(SCORING_CACHE_SIZE + 3);
+	next_cache.reserve(SCORING_CACHE_SIZE + 3);
+
+	std::vector<unsigned int> result;
+	result.reserve(indices.size());
+
+	// at a dead end, the first triangle not drawn yet
+	size_t cursor = 0;
+	auto best = static_cast<long long>(std::max_element(triangle_score.begin(), triangle_score.end()) - triangle_score.begin());
+
+	while (result.size() < triangle_count * 3)
+	{
+		if (best < 0)
+		{
+			while (emitted[cursor])
+			{
+				cursor++;
+			}
+			best = static_cast<long long>(cursor);
+		}
+
+		const auto triangle = &indices[3 * best];
+		emitted[best] = true;
+		result.insert(result.end(), triangle, triangle + 3);
+
+		for (unsigned int k = 0; k < 3; k++)
+		{
+			const auto v = triangle[k];
+			const auto begin = adjacency.begin() + offsets[v];
+			const auto end   = begin + remaining[v];
+			*std::find(begin, end, static_cast<unsigned int>(best)) = *(end - 1);
+			remaining[v]--;
+		}
+
+		// most recently used first, the overflow falls out of the cache
+		next_cache.assign(triangle, triangle + 3);
+		for (auto v : cache)
+		{
+			if (v != triangle[0] && v != triangle[1] && v != triangle[2])
+			{
+				next_cache.push_back(v);
+			}
+		}
+
+		for (size_t i = 0; i < next_cache.size(); i++)
+		{
+			const auto v = next_cache[i];
+			const auto position = i < SCORING_CACHE_SIZE ? static_cast<int>(i) : -1;
+			const auto score = GetVertexScore(position, remaining[v]);
+			const auto delta = score - vertex_score[v];
+
+			cache_position[v] = position;
+			vertex_score[v]   = score;
+
+			for (auto a = offsets[v]; a < offsets[v] + remaining[v]; a++)
+			{
+				triangle_score[adjacency[a]] += delta;
+			}
+		}
+
+		if (next_cache.size() > SCORING_CACHE_SIZE)
+		{
+			next_cache.resize(SCORING_CACHE_SIZE);
+		}
+		cache.swap(next_cache);
+
+		// the best triangle that touches the cache, none at a dead end
+		best = -1;
+		auto best_score = -1.0f;
+		for (auto v : cache)
+		{
+			for (auto a = offsets[v]; a < offsets[v] + remaining[v]; a++)
+			{
+				if (triangle_score[adjacency[a]] > best_score)
+				{
+					best_score = triangle_score[adjacency[a]];
+					best = adjacency[a];
+				}
+			}
+		}
+	}
+
+	indices.swap(result);
+}
+
+//==============================================================================
+
+void MeshOptimizer::OptimizeOverdraw(std::vector<unsigned int> &indices, const std::vector<glm::vec3> &positions, float threshold) noexcept
+{
+	const auto triangle_count = indices.size() / 3;
+	if (triangle_count == 0)
+	{
+		return;
+	}
+
+	std::vector<unsigned int> timestamps(positions.size(), 0);
+	auto timestamp = CACHE_SIZE + 1;
+
+	// hard boundaries, where the cache order starts over with three misses anyway
+	std::vector<size_t> hard;
+	for (size_t t = 0; t < triangle_count; t++)
+	{
+		if (CountMisses(&indices[3 * t], timestamps, timestamp) == 3)
+		{
+			hard.push_back(t);
+		}
+	}
+	hard.push_back(triangle_count);
+
+	// soft boundaries inside each run, once a cluster started cold costs
+	// no more than threshold times what the whole run does
+	std::vector<size_t> clusters;
+	for (size_t h = 0; h + 1 < hard.size(); h++)
+	{
+		const auto start = hard[h];
+		const auto end   = hard[h + 1];
+
+		timestamp += CACHE_SIZE + 1;
+		size_t run_misses = 0;
+		for (auto t = start; t < end; t++)
+		{
+			run_misses += CountMisses(&indices[3 * t], timestamps, timestamp);
+		}
+		const auto run_acmr = static_cast<float>(run_misses) / (end - start);
+
+		timestamp += CACHE_SIZE + 1;
+		auto cluster_start = start;
+		size_t misses = 0;
+		for (auto t = start; t < end; t++)
+		{
+			misses += CountMisses(&indices[3 * t], timestamps, timestamp);
+
+			if (t + 1 < end && misses <= threshold * run_acmr * (t + 1 - cluster_start))
+			{
+				clusters.push_back(cluster_start);
+				cluster_start = t + 1;
+				misses = 0;
+				timestamp += CACHE_SIZE + 1;
+			}
+		}
+		clusters.push_back(cluster_start);
+	}
+	clusters.push_back(triangle_count);
+
+	// area weighted centroid and normal of the mesh and of every cluster
+	const auto cluster_count = clusters.size() - 1;
+	std::vector<glm::vec3> centroids(cluster_count, glm::vec3(0.0f));
+	std::vector<glm::vec3> normals(cluster_count, glm::vec3(0.0f));
+	std::vector<float> areas(cluster_count, 0.0f);
+
+	auto mesh_centroid = glm::vec3(0.0f);
+	auto mesh_area = 0.0f;
+
+	for (size_t c = 0; c < cluster_count; c++)
+	{
+		for (auto t = clusters[c]; t < clusters[c + 1]; t++)
+		{
+			const auto &a = positions[indices[3 * t]];
+			const auto &b = positions[indices[3 * t + 1]];
+			const auto &d = positions[indices[3 * t + 2]];
+
+			const auto normal = glm::cross(b - a, d - a);
+			const auto area = glm::length(normal);
+
+			centroids[c] += (a + b + d) * (area / 3.0f);
+			normals[c]   += normal;
+			areas[c]     += area;
+		}
+
+		mesh_centroid += centroids[c];
+		mesh_area     += areas[c];
+	}
+
+	if (mesh_area > 0.0f)
+	{
+		mesh_centroid /= mesh_area;
+	}
+
+	// clusters facing away from the centre occlude the rest, so they go first
+	std::vector<std::pair<float, size_t>> order(cluster_count);
+	for (size_t c = 0; c < cluster_count; c++)
+	{
+		const auto length = glm::length(normals[c]);
+		const auto centroid = areas[c] > 0.0f ? centroids[c] / areas[c] : mesh_centroid;
+		const auto key = length > 0.0f ? glm::dot(centroid - mesh_centroid, normals[c] / length) : 0.0f;
+		order[c] = std::make_pair(-key, c);
+	}
+	std::sort(order.begin(), order.end());
+
+	std::vector<unsigned int> result;
+	result.reserve(indices.size());
+	for (auto &cluster : order)
+	{
+		result.insert(result.end(), indices.begin() + 3 * clusters[cluster.second], indices.begin() + 3 * clusters[cluster.second + 1]);
+	}
+
+	indices.swap(result);
+}
+
+//==============================================================================
+
+std::vector<unsigned int> MeshOptimizer::OptimizeVertexFetch(std::vector<unsigned int> &indices, size_t vertex_count) noexcept
+{
+	const auto unused = ~0u;
+
+	std::vector<unsigned int> remap(vertex_count, unused);
+	unsigned int next = 0;
+
+	for (auto &index : indices)
+	{
+		if (remap[index] == unused)
+		{
+			remap[index] = next++;
+		}
+		index = remap[index];
+	}
+
+	for (auto &index : remap)
+	{
+		if (index == unused)
+		{
+			index = next++;
+		}
+	}
+
+	return remap;
+}
+
+//==============================================================================
+
+void MeshOptimizer::Remap(std::vector<glm::vec3> &attribute, const std::vector<unsigned int> &remap) noexcept
+{
+	if (attribute.empty())
+	{
+		return;
+	}
+
+	std::vector<glm::vec3> result(attribute.size());
+	for (size_t i = 0; i < attribute.size(); i++)
+	{
+		result[remap[i]] = attribute[i];
+	}
+	attribute.swap(result);
+}
+
+//==============================================================================
+
+void MeshOptimizer::Remap(std::vector<glm::vec2> &attribute, const std::vector<unsigned int> &remap) noexcept
+{
+	if (attribute.empty())
+	{
+		return;
+	}
+
+	std::vector<glm::vec2> result(attribute.size());
+	for (size_t i = 0; i < attribute.size(); i++)
+	{
+		result[remap[i]] = attribute[i];
+	}
+	attribute.swap(result);
+}
+
+//==============================================================================
+
+void MeshOptimizer::Remap(std::vector<glm::vec4> &attribute, const std::vector<unsigned int> &remap) noexcept
+{
+	if (attribute.empty())
+	{
+		return;
+	}
+
+	std::vector<glm::vec4> result(attribute.size());
+	for (size_t i = 0; i < attribute.size(); i++)
+	{
+		result[remap[i]] = attribute[i];
+	}
+	attribute.swap(result);
+}
+
+//==============================================================================
+
+std::vector<unsigned int> MeshOptimizer::Optimize(std::vector<unsigned int> &indices, std::vector<glm::vec3> &positions,
+	std::vector<glm::vec3> &normals, std::vector<glm::vec2> &uvs) noexcept
+{
+	OptimizeVertexCache(indices, positions.size());
+	OptimizeOverdraw(indices, positions);
+
+	const auto remap = OptimizeVertexFetch(indices, positions.size());
+	Remap(positions, remap);
+	Remap(normals, remap);
+	Remap(uvs, remap);
+
+	return remap;
+}
+
+//==============================================================================
+
+void MeshOptimizer::AddPlane(Quadric &quadric, const glm::vec3 &normal, float distance) noexcept
+{
+	const double plane[4] = { normal.x, normal.y, normal.z, distance };
+
+	auto m = quadric.m;
+	for (int i = 0; i < 4; i++)
+	{
+		for (int j = i; j < 4; j++)
+		{
+			*m++ += plane[i] * plane[j];
+		}
+	}
+}
+
+//==============================================================================
+
+void MeshOptimizer::AddQuadric(Quadric &target, const Quadric &source) noexcept
+{
+	for (int i = 0; i < 10; i++)
+	{
+		target.m[i] += source.m[i];
+	}
+}
+
+//==============================================================================
+
+double MeshOptimizer::Evaluate(const Quadric &a, const Quadric &b, const glm::vec3 &position) noexcept
+{
+	const double v[4] = { position.x, position.y, position.z, 1.0 };
+
+	// the off diagonal terms appear twice in the full matrix
+	auto error = 0.0;
+	auto k = 0;
+	for (int i = 0; i < 4; i++)
+	{
+		for (int j = i; j < 4; j++, k++)
+		{
+			error += (a.m[k] + b.m[k]) * v[i] * v[j] * (i == j ? 1.0 : 2.0);
+		}
+	}
+
+	return std::max(error, 0.0);
+}
+
+//==============================================================================
+
+bool MeshOptimizer::Flips(unsigned int from, unsigned int to, const std::vector<unsigned int> &indices, const std::vector<glm::vec3> &positions,
+	const std::vector<unsigned int> &offsets, const std::vector<unsigned int> &triangles) noexcept
+{
+	for (auto i = offsets[from]; i < offsets[from + 1]; i++)
+	{
+		const auto triangle = &indices[triangles[i]];
+		if (triangle[0] == to || triangle[1] == to || triangle[2] == to)
+		{
+			continue;
+		}
+
+		glm::vec3 corners[3];
+		for (int k = 0; k < 3; k++)
+		{
+			corners[k] = positions[triangle[k]];
+		}
+		const auto before = glm::cross(corners[1] - corners[0], corners[2] - corners[0]);
+
+		for (int k = 0; k < 3; k++)
+		{
+			corners[k] = positions[triangle[k] == from ? to : triangle[k]];
+		}
+		const auto after = glm::cross(corners[1] - corners[0], corners[2] - corners[0]);
+
+		if (glm::dot(before, after) <= 0.0f)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+//==============================================================================
+
+std::vector<unsigned int> MeshOptimizer::Simplify(const std::vector<unsigned int> &indices, const std::vector<glm::vec3> &positions,
+	size_t target_count, float &error) noexcept
+{
+	const auto vertex_count = positions.size();
+	std::vector<unsigned int> result(indices.begin(), indices.begin() + indices.size() / 3 * 3);
+
+	// the planes of the triangles around each vertex
+	std::vector<Quadric> quadrics(vertex_count, Quadric());
+	for (size_t t = 0; t < result.size(); t += 3)
+	{
+		const auto &a = positions[result[t]];
+		auto normal = glm::cross(positions[result[t + 1]] - a, positions[result[t + 2]] - a);
+		const auto length = glm::length(normal);
+		if (length > 0.0f)
+		{
+			normal /= length;
+			for (size_t k = 0; k < 3; k++)
+			{
+				AddPlane(quadrics[result[t + k]], normal, -glm::dot(normal, a));
+			}
+		}
+	}
+
+	// an edge without its twin in the opposite direction is on a border
+	std::vector<std::pair<unsigned int, unsigned int>> edges;
+	edges.reserve(result.size());
+	for (size_t t = 0; t < result.size(); t += 3)
+	{
+		for (size_t k = 0; k < 3; k++)
+		{
+			edges.push_back(std::make_pair(result[t + k], result[t + (k + 1) % 3]));
+		}
+	}
+	std::sort(edges.begin(), edges.end());
+
+	std::vector<bool> locked(vertex_count, false);
+	for (const auto &edge : edges)
+	{
+		if (!std::binary_search(edges.begin(), edges.end(), std::make_pair(edge.second, edge.first)))
+		{
+			locked[edge.first]  = true;
+			locked[edge.second] = true;
+		}
+	}
+	std::vector<std::pair<unsigned int, unsigned int>>().swap(edges);
+
+	std::vector<unsigned int> offsets;
+	std::vector<unsigned int> triangles;
+	std::vector<unsigned int> remap(vertex_count);
+	std::vector<bool> touched(vertex_count);
+	std::vector<std::pair<double, std::pair<unsigned int, unsigned int>>> collapses;
+
+	auto max_error = 0.0;
+	while (result.size() > target_count)
+	{
+		// the triangles around every vertex
+		offsets.assign(vertex_count + 1, 0);
+		for (const auto index : result)
+		{
+			offsets[index + 1]++;
+		}
+		for (size_t i = 0; i < vertex_count; i++)
+		{
+			offsets[i + 1] += offsets[i];
+		}
+
+		triangles.resize(result.size());
+		remap.assign(offsets.begin(), offsets.end() - 1);
+		for (size_t t = 0; t < result.size(); t += 3)
+		{
+			for (size_t k = 0; k < 3; k++)
+			{
+				triangles[remap[result[t + k]]++] = static_cast<unsigned int>(t);
+			}
+		}
+
+		// each directed edge once, the twin covers the other way
+		collapses.clear();
+		for (size_t t = 0; t < result.size(); t += 3)
+		{
+			for (size_t k = 0; k < 3; k++)
+			{
+				const auto from = result[t + k];
+				const auto to   = result[t + (k + 1) % 3];
+				if (!locked[from])
+				{
+					collapses.push_back(std::make_pair(Evaluate(quadrics[from], quadrics[to], positions[to]), std::make_pair(from, to)));
+				}
+			}
+		}
+		std::sort(collapses.begin(), collapses.end());
+
+		// the cheapest collapses whose neighbourhoods do not overlap, one pass at a time
+		for (size_t i = 0; i < vertex_count; i++)
+		{
+			remap[i] = static_cast<unsigned int>(i);
+		}
+		touched.assign(vertex_count, false);
+
+		auto remaining = result.size() / 3;
+		size_t collapsed = 0;
+		for (const auto &collapse : collapses)
+		{
+			const auto from = collapse.second.first;
+			const auto to   = collapse.second.second;
+			if (remaining <= target_count / 3)
+			{
+				break;
+			}
+
+			if (touched[from] || touched[to] || Flips(from, to, result, positions, offsets, triangles))
+			{
+				continue;
+			}
+
+			for (auto i = offsets[from]; i < offsets[from + 1]; i++)
+			{
+				const auto triangle = &result[triangles[i]];
+				for (size_t k = 0; k < 3; k++)
+				{
+					touched[triangle[k]] = true;
+				}
+				if (triangle[0] == to || triangle[1] == to || triangle[2] == to)
+				{
+					remaining--;
+				}
+			}
+
+			remap[from] = to;
+			AddQuadric(quadrics[to], quadrics[from]);
+			max_error = std::max(max_error, collapse.first);
+			collapsed++;
+		}
+
+		if (collapsed == 0)
+		{
+			break;
+		}
+
+		// without the triangles that lost a corner
+		size_t count = 0;
+		for (size_t t = 0; t < result.size(); t += 3)
+		{
+			const auto a = remap[result[t]];
+			const auto b = remap[result[t + 1]];
+			const auto c = remap[result[t + 2]];
+			if (a != b && b != c && c != a)
+			{
+				result[count++] = a;
+				result[count++] = b;
+				result[count++] = c;
+			}
+		}
+		result.resize(count);
+	}
+
+	error = static_cast<float>(std::sqrt(max_error));
+	return result;
+}
+
+//==============================================================================
+
+std::vector<MeshOptimizer::Meshlet> MeshOptimizer::BuildMeshlets(const std::vector<unsigned int> &indices, const std::vector<glm::vec3> &positions) noexcept
+{
+	std::vector<Meshlet> meshlets;
+
+	// the meshlet each vertex was last counted in
+	std::vector<size_t> stamps(positions.size(), static_cast<size_t>(-1));
+
+	size_t first = 0;
+	unsigned int vertices = 0;
+	const auto count = indices.size() / 3 * 3;
+	for (size_t i = 0; i < count; i += 3)
+	{
+		auto added = 0u;
+		for (size_t j = 0; j < 3; j++)
+		{
+			added += stamps[indices[i + j]] != meshlets.size() ? 1 : 0;
+		}
+
+		// the triangle starts the next meshlet
+		if (vertices + added > MESHLET_VERTICES || i - first >= 3 * MESHLET_TRIANGLES)
+		{
+			meshlets.push_back(Meshlet());
+			meshlets.back().first = static_cast<unsigned int>(first);
+			meshlets.back().count = static_cast<unsigned int>(i - first);
+
+			first = i;
+			vertices = 0;
+			added = 3;
+		}
+
+		vertices += added;
+		for (size_t j = 0; j < 3; j++)
+		{
+			stamps[indices[i + j]] = meshlets.size();
+		}
+	}
+
+	if (count > first)
+	{
+		meshlets.push_back(Meshlet());
+		meshlets.back().first = static_cast<unsigned int>(first);
+		meshlets.back().count = static_cast<unsigned int>(count - first);
+	}
+
+	std::vector<glm::vec3> normals;
+	for (auto &meshlet : meshlets)
+	{
+		const auto begin = indices.begin() + meshlet.first;
+		const auto end = begin + meshlet.count;
+
+		// the center of the bounding box, close enough to the smallest sphere
+		auto lower = positions[*begin];
+		auto upper = lower;
+		for (auto index = begin; index != end; ++index)
+		{
+			lower = glm::min(lower, positions[*index]);
+			upper = glm::max(upper, positions[*index]);
+		}
+
+		const auto center = 0.5f * (lower + upper);
+		auto radius = 0.0f;
+		for (auto index = begin; index != end; ++index)
+		{
+			radius = std::max(radius, glm::length(positions[*index] - center));
+		}
+
+		// the widest triangle normal around the mean one; degenerate triangles face nowhere
+		normals.clear();
+		auto axis = glm::vec3(0.0f);
+		for (auto index = begin; index != end; index += 3)
+		{
+			const auto &a = positions[index[0]];
+			const auto normal = glm::cross(positions[index[1]] - a, positions[index[2]] - a);
+			const auto length = glm::length(normal);
+			if (length > 0.0f)
+			{
+				normals.push_back(normal / length);
+				axis += normals.back();
+			}
+		}
+
+		auto spread = -1.0f;
+		const auto length = glm::length(axis);
+		if (length > 1e-6f)
+		{
+			axis /= length;
+			spread = 1.0f;
+			for (const auto &normal : normals)
+			{
+				spread = std::min(spread, glm::dot(axis, normal));
+			}
+		}
+
+		meshlet.sphere = glm::vec4(center, radius);
+		meshlet.cone = glm::vec4(axis, spread > 0.0f ? std::acos(std::min(spread, 1.0f)) : 4.0f);
+		meshlet.padding[0] = 0;
+		meshlet.padding[1] = 0;
+	}
+
+	return meshlets;
+}
+
+//==============================================================================
+
+std::vector<glm::vec4> MeshOptimizer::GenerateTangents(const std::vector<unsigned int> &indices, const std::vector<glm::vec3> &positions,
+	const std::vector<glm::vec3> &normals, const std::vector<glm::vec2> &uvs) noexcept
+{
+	std::vector<glm::vec3> tangents(positions.size(), glm::vec3(0.0f));
+	std::vector<glm::vec3> bitangents(positions.size(), glm::vec3(0.0f));
+
+	for (size_t i = 0; i + 2 < indices.size(); i += 3)
+	{
+		const auto triangle = &indices[i];
+
+		const auto e1 = positions[triangle[1]] - positions[triangle[0]];
+		const auto e2 = positions[triangle[2]] - positions[triangle[0]];
+		const auto d1 = uvs[triangle[1]] - uvs[triangle[0]];
+		const auto d2 = uvs[triangle[2]] - uvs[triangle[0]];
+
+		// the derivatives of the position by u and by v over the triangle; one
+		// without area in uv space has none
+		const auto area = d1.x * d2.y - d2.x * d1.y;
+		if (std::abs(area) < 1e-20f)
+		{
+			continue;
+		}
+
+		const auto u = (e1 * d2.y - e2 * d1.y) / area;
+		const auto v = (e2 * d1.x - e1 * d2.x) / area;
+
+		for (unsigned int k = 0; k < 3; k++)
+		{
+			const auto vertex = triangle[k];
+			const auto &normal = normals[vertex];
+
+			const auto a = positions[triangle[(k + 1) % 3]] - positions[vertex];
+			const auto b = positions[triangle[(k + 2) % 3]] - positions[vertex];
+			const auto length = glm::length(a) * glm::length(b);
+			if (length <= 0.0f)
+			{
+				continue;
+			}
+
+			const auto angle = std::acos(glm::clamp(glm::dot(a, b) / length, -1.0f, 1.0f));
+
+			const auto t = u - normal * glm::dot(normal, u);
+			const auto s = v - normal * glm::dot(normal, v);
+			const auto t_length = glm::length(t);
+			const auto s_length = glm::length(s);
+
+			if (t_length > 0.0f)
+			{
+				tangents[vertex] += t * (angle / t_length);
+			}
+			if (s_length > 0.0f)
+			{
+				bitangents[vertex] += s * (angle / s_length);
+			}
+		}
+	}
+
+	std::vector<glm::vec4> result(positions.size());
+	for (size_t i = 0; i < positions.size(); i++)
+	{
+		const auto &normal = normals[i];
+
+		// any direction in the plane where the texture does not vary
+		auto tangent = tangents[i] - normal * glm::dot(normal, tangents[i]);
+		if (glm::dot(tangent, tangent) < 1e-12f)
+		{
+			tangent = glm::cross(normal, std::abs(normal.x) < 0.9f ? glm::vec3(1.0f, 0.0f, 0.0f) : glm::vec3(0.0f, 1.0f, 0.0f));
+		}
+		tangent = glm::normalize(tangent);
+
+		const auto sign = glm::dot(glm::cross(normal, tangent), bitangents[i]) > 0.0f ? -1.0f : 1.0f;
+		result[i] = glm::vec4(tangent, sign);
+	}
+
+	return result;
+}
+
+//==============================================================================
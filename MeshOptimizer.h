@@ -0,0 +1,117 @@
+
+#pragma once
+
+//==============================================================================
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+//==============================================================================
+
+// reorders indexed triangle lists for the post transform vertex cache, then
+// for overdraw, then the vertices for fetch locality; the triangles and their
+// winding are kept, only their order and the vertex numbering change
+class MeshOptimizer
+{
+public:
+	struct Statistics
+	{
+		float acmr; // cache misses per triangle, about 0.5 at best on a regular grid
+		float atvr; // cache misses per referenced vertex, 1 at best
+	};
+
+	// a run of the index list with few enough vertices to be culled on the GPU as
+	// one; laid out as cull.cs reads it (std430)
+	struct Meshlet
+	{
+		glm::vec4 sphere;   // center and radius
+		glm::vec4 cone;     // mean normal and half angle, past pi / 2 when it cannot face away as a whole
+		unsigned int first; // index
+		unsigned int count; // indices
+		unsigned int padding[2];
+	};
+
+	// a FIFO of this size is what Analyze() simulates, typical of current GPUs
+	static const unsigned int CACHE_SIZE = 16;
+
+	static const unsigned int MESHLET_VERTICES  = 64;
+	static const unsigned int MESHLET_TRIANGLES = 124;
+
+private:
+	// the LRU model of the cache order optimization, Forsyth's scoring
+	static const unsigned int SCORING_CACHE_SIZE = 32;
+
+	static float GetVertexScore(int cache_position, unsigned int remaining) noexcept;
+
+	// one triangle through the FIFO; a vertex is cached while fewer than CACHE_SIZE
+	// misses came after its own, so adding CACHE_SIZE + 1 to timestamp empties it
+	static unsigned int CountMisses(const unsigned int *triangle, std::vector<unsigned int> &timestamps, unsigned int &timestamp) noexcept;
+
+	// the sum of squared distances to a set of planes, a symmetric 4x4 matrix
+	// stored as its upper triangle row by row
+	struct Quadric
+	{
+		double m[10];
+	};
+
+	static void AddPlane(Quadric &quadric, const glm::vec3 &normal, float distance) noexcept;
+	static void AddQuadric(Quadric &target, const Quadric &source) noexcept;
+	static double Evaluate(const Quadric &a, const Quadric &b, const glm::vec3 &position) noexcept;
+
+	// whether moving from onto to turns one of the triangles around from over,
+	// the ones that contain both collapse and do not count
+	static bool Flips(unsigned int from, unsigned int to, const std::vector<unsigned int> &indices, const std::vector<glm::vec3> &positions,
+		const std::vector<unsigned int> &offsets, const std::vector<unsigned int> &triangles) noexcept;
+
+public:
+	// without the degenerate triangles, odd triangles flipped back to the strip's winding
+	static std::vector<unsigned int> StripToList(const std::vector<unsigned int> &strip) noexcept;
+
+	static Statistics Analyze(const std::vector<unsigned int> &indices, size_t vertex_count) noexcept;
+
+	static void OptimizeVertexCache(std::vector<unsigned int> &indices, size_t vertex_count) noexcept;
+
+	// splits the cache order into clusters that cost at most threshold times its
+	// ACMR and draws the outward facing clusters first; run after the cache pass
+	static void OptimizeOverdraw(std::vector<unsigned int> &indices, const std::vector<glm::vec3> &positions, float threshold = 1.05f) noexcept;
+
+	// renumbers the vertices in order of first use, returns the new index of
+	// each old vertex; unreferenced vertices go last
+	static std::vector<unsigned int> OptimizeVertexFetch(std::vector<unsigned int> &indices, size_t vertex_count) noexcept;
+
+	static void Remap(std::vector<glm::vec3> &attribute, const std::vector<unsigned int> &remap) noexcept;
+	static void Remap(std::vector<glm::vec2> &attribute, const std::vector<unsigned int> &remap) noexcept;
+	static void Remap(std::vector<glm::vec4> &attribute, const std::vector<unsigned int> &remap) noexcept;
+
+	// every pass above in order; empty attributes are left empty; returns the
+	// new index of each old vertex for other index lists of the same vertices
+	static std::vector<unsigned int> Optimize(std::vector<unsigned int> &indices, std::vector<glm::vec3> &positions,
+		std::vector<glm::vec3> &normals, std::vector<glm::vec2> &uvs) noexcept;
+
+	// collapses edges in order of their quadric error (Garland and Heckbert) until
+	// at most target_count indices are left, or nothing more can go; vertices only
+	// move onto others, so the result indexes the same vertices; a border edge, and
+	// so a seam between split vertices, keeps its ends in place; error is about
+	// the farthest the surface moved, in the units of the positions
+	static std::vector<unsigned int> Simplify(const std::vector<unsigned int> &indices, const std::vector<glm::vec3> &positions,
+		size_t target_count, float &error) noexcept;
+
+	// splits the triangle list into consecutive runs of at most MESHLET_VERTICES
+	// vertices and MESHLET_TRIANGLES triangles, so the indices stay as they are;
+	// the cache order keeps the runs compact
+	static std::vector<Meshlet> BuildMeshlets(const std::vector<unsigned int> &indices, const std::vector<glm::vec3> &positions) noexcept;
+
+	// the direction of increasing u in each vertex's tangent plane, and in w the
+	// sign that turns cross(normal, tangent) towards decreasing v, up in the
+	// image, as glTF stores them for pbr.fs GetNormalFromMap(); as MikkTSpace,
+	// each triangle adds its own directions projected onto the plane, normalized
+	// and weighted by its angle at the vertex, but a vertex shared by triangles
+	// of opposite winding in uv space is not split, the files split them already
+	static std::vector<glm::vec4> GenerateTangents(const std::vector<unsigned int> &indices, const std::vector<glm::vec3> &positions,
+		const std::vector<glm::vec3> &normals, const std::vector<glm::vec2> &uvs) noexcept;
+};
+
+//==============================================================================
@@ -0,0 +1,306 @@
+
+#include "OctahedralImpostor.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "GLAD/glad.h"
+
+#include "Material.h"
+#include "Scene.h"
+#include "Shader.h"
+
+//==============================================================================
+
+OctahedralImpostor::OctahedralImpostor(Drawable *source, const std::vector<glm::vec4> &instances, unsigned int frame_size) noexcept :
+	frame_size(frame_size),
+	mip_levels(1),
+	source(source),
+	albedo_atlas(0),
+	normal_atlas(0),
+	orm_atlas(0),
+	count(0),
+	source_radius(source->GetRadius())
+{
+	while ((frame_size >> mip_levels) >= MIN_FRAME_SIZE)
+	{
+		mip_levels++;
+	}
+
+	albedo_atlas = CreateAtlas(GL_RGBA8);
+	normal_atlas = CreateAtlas(GL_RGBA16F);
+	orm_atlas    = CreateAtlas(GL_RGBA8);
+
+	// the quads are built around the unit sphere of the bounds
+	position_decode = glm::scale(glm::mat4(1.0f), glm::vec3(source_radius));
+	material = source->GetMaterial();
+
+	SetInstances(instances);
+}
+
+//==============================================================================
+
+OctahedralImpostor::~OctahedralImpostor() noexcept
+{
+	glDeleteTextures(1, &albedo_atlas);
+	glDeleteTextures(1, &normal_atlas);
+	glDeleteTextures(1, &orm_atlas);
+
+	delete source;
+}
+
+//==============================================================================
+
+unsigned int OctahedralImpostor::CreateAtlas(unsigned int format) const noexcept
+{
+	const auto size = FRAMES * frame_size;
+
+	unsigned int atlas;
+	glGenTextures(1, &atlas);
+	glBindTexture(GL_TEXTURE_2D, atlas);
+	glTexStorage2D(GL_TEXTURE_2D, mip_levels, format, size, size);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	return atlas;
+}
+
+//==============================================================================
+
+glm::vec3 OctahedralImpostor::GetFrameDirection(unsigned int x, unsigned int y) noexcept
+{
+	const auto e = (glm::vec2(x, y) + 0.5f) / static_cast<float>(FRAMES) * 2.0f - 1.0f;
+	const auto p = glm::vec2(e.x + e.y, e.x - e.y) * 0.5f;
+
+	return glm::normalize(glm::vec3(p.x, 1.0f - std::abs(p.x) - std::abs(p.y), p.y));
+}
+
+//==============================================================================
+
+void OctahedralImpostor::Bake(const Scene &scene) noexcept
+{
+	const auto size = FRAMES * frame_size;
+
+	unsigned int FBO;
+	unsigned int RBO;
+	glGenFramebuffers(1, &FBO);
+	glGenRenderbuffers(1, &RBO);
+
+	glBindFramebuffer(GL_FRAMEBUFFER, FBO);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, albedo_atlas, 0);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, normal_atlas, 0);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT2, GL_TEXTURE_2D, orm_atlas, 0);
+
+	glBindRenderbuffer(GL_RENDERBUFFER, RBO);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, size, size);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, RBO);
+
+	const GLenum buffers[] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1, GL_COLOR_ATTACHMENT2 };
+	glDrawBuffers(3, buffers);
+
+	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+	{
+		std::cout << "error: impostor atlases of " << size << " texels are not renderable" << std::endl;
+	}
+
+	// no coverage where the object is not
+	const float zero[] = { 0.0f, 0.0f, 0.0f, 0.0f };
+	const float one = 1.0f;
+	for (int i = 0; i < 3; i++)
+	{
+		glClearBufferfv(GL_COLOR, i, zero);
+	}
+	glClearBufferfv(GL_DEPTH, 0, &one);
+
+	const auto material = source->GetMaterial();
+
+	auto bake_shader = scene.GetShader("impostor_bake");
+	bake_shader->Use();
+	bake_shader->SetMat4("model", source->GetPositionDecode());
+	bake_shader->SetFloat("radius", source_radius);
+	bake_shader->SetBool("use_normal_map", material->GetNormal() != nullptr);
+	bake_shader->SetBool("use_orm_map", material->GetORM() != nullptr);
+	scene.SetMaterial(material);
+
+	// the finest level of detail, the camera is at the center
+	source->SelectLevel(glm::vec3(source->GetModel()[3]), 1.0f, 0.0f);
+
+	// the bounds fill each view, from their surface to the far side
+	const auto projection = glm::ortho(-source_radius, source_radius, -source_radius, source_radius, 0.0f, 2.0f * source_radius);
+	bake_shader->SetMat4("projection", projection);
+
+	for (unsigned int y = 0; y < FRAMES; y++)
+	{
+		for (unsigned int x = 0; x < FRAMES; x++)
+		{
+			const auto direction = GetFrameDirection(x, y);
+			const auto reference = std::abs(direction.y) < 0.999f ? glm::vec3(0.0f, 1.0f, 0.0f) : glm::vec3(0.0f, 0.0f, 1.0f);
+
+			bake_shader->SetMat4("view", glm::lookAt(direction * source_radius, glm::vec3(0.0f), reference));
+			bake_shader->SetVec3("direction", direction);
+
+			glViewport(x * frame_size, y * frame_size, frame_size, frame_size);
+			source->Draw();
+		}
+	}
+
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	glDeleteFramebuffers(1, &FBO);
+	glDeleteRenderbuffers(1, &RBO);
+
+	for (auto atlas : { albedo_atlas, normal_atlas, orm_atlas })
+	{
+		glBindTexture(GL_TEXTURE_2D, atlas);
+		glGenerateMipmap(GL_TEXTURE_2D);
+	}
+	glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+//==============================================================================
+
+void OctahedralImpostor::SetInstances(const std::vector<glm::vec4> &instances) noexcept
+{
+	this->instances = instances;
+	close.assign(instances.size(), false);
+	source_models.clear();
+
+	radius = 0.0f;
+	for (const auto &instance : instances)
+	{
+		radius = std::max(radius, glm::length(glm::vec3(instance)) + instance.w * source_radius);
+	}
+
+	UploadInstances();
+}
+
+//==============================================================================
+
+void OctahedralImpostor::UploadInstances() noexcept
+{
+	// positions in units of the bounds, see position_decode
+	std::vector<glm::vec4> data;
+	data.reserve(instances.size());
+	for (size_t i = 0; i < instances.size(); i++)
+	{
+		if (!close[i])
+		{
+			data.push_back(glm::vec4(glm::vec3(instances[i]) / source_radius, instances[i].w));
+		}
+	}
+
+	count = static_cast<unsigned int>(data.size());
+
+	glBindVertexArray(VAO);
+	glBindBuffer(GL_ARRAY_BUFFER, VBO);
+	glBufferData(GL_ARRAY_BUFFER, data.size() * sizeof(glm::vec4), data.data(), GL_DYNAMIC_DRAW);
+
+	// one instance per quad in place of the position, the corners come from gl_VertexID
+	glEnableVertexAttribArray(VertexFormat::POSITION);
+	glVertexAttribPointer(VertexFormat::POSITION, 4, GL_FLOAT, GL_FALSE, sizeof(glm::vec4), (void*)0);
+	glVertexAttribDivisor(VertexFormat::POSITION, 1);
+
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glBindVertexArray(0);
+
+	vertex_memory = data.size() * sizeof(glm::vec4);
+}
+
+//==============================================================================
+
+unsigned int OctahedralImpostor::GetCount() const noexcept
+{
+	return count;
+}
+
+//==============================================================================
+
+void OctahedralImpostor::SelectInstances(const glm::vec3 &camera, float pixel_scale, float threshold) noexcept
+{
+	const auto limit = static_cast<float>(frame_size);
+
+	// the source holds the model of the nearest instance it is drawn for
+	auto nearest = -1.0f;
+	source->SetModel(model);
+
+	auto changed = false;
+	source_models.clear();
+	for (size_t i = 0; i < instances.size(); i++)
+	{
+		const auto instance_model = glm::scale(glm::translate(model, glm::vec3(instances[i])), glm::vec3(instances[i].w));
+		const auto bounds   = GetBoundingSphere(instance_model, source_radius);
+		const auto distance = glm::length(camera - glm::vec3(bounds));
+
+		// the quad is not drawn with the camera inside the bounds
+		const auto pixels = 2.0f * bounds.w * pixel_scale / glm::max(distance, 1e-3f);
+		const auto detailed = distance <= bounds.w || pixels > (close[i] ? limit * LEVEL_HYSTERESIS : limit);
+
+		changed = changed || detailed != close[i];
+		close[i] = detailed;
+
+		if (detailed)
+		{
+			source_models.push_back(instance_model);
+
+			if (nearest < 0.0f || distance < nearest)
+			{
+				nearest = distance;
+				source->SetModel(instance_model);
+			}
+		}
+	}
+
+	// one level for all of them, fine enough for the nearest
+	if (nearest >= 0.0f)
+	{
+		source->SelectLevel(camera, pixel_scale, threshold);
+	}
+
+	if (changed)
+	{
+		UploadInstances();
+	}
+}
+
+//==============================================================================
+
+const Drawable *OctahedralImpostor::GetSource() const noexcept
+{
+	return source;
+}
+
+//==============================================================================
+
+const std::vector<glm::mat4> &OctahedralImpostor::GetSourceModels() const noexcept
+{
+	return source_models;
+}
+
+//==============================================================================
+
+void OctahedralImpostor::Draw() const noexcept
+{
+	if (count == 0)
+	{
+		return;
+	}
+
+	// in place of the source's maps Scene::SetMaterial() bound
+	glActiveTexture(GL_TEXTURE3);
+	glBindTexture(GL_TEXTURE_2D, albedo_atlas);
+	glActiveTexture(GL_TEXTURE4);
+	glBindTexture(GL_TEXTURE_2D, normal_atlas);
+	glActiveTexture(GL_TEXTURE5);
+	glBindTexture(GL_TEXTURE_2D, orm_atlas);
+
+	glBindVertexArray(VAO);
+	glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, count);
+	glBindVertexArray(0);
+}
+
+//==============================================================================
@@ -0,0 +1,89 @@
+
+#pragma once
+
+//==============================================================================
+
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "Drawable.h"
+
+//==============================================================================
+
+class Scene;
+
+//==============================================================================
+
+// instances of one detailed object, each drawn as a single quad: the object is
+// baked from FRAMES x FRAMES views into atlases of albedo, normal and depth,
+// and occlusion, roughness and metallic, and pbr.fs (OCT_IMPOSTOR) lights the
+// blend of the three views nearest to the camera's like the object itself
+//
+// the views cover the upper hemisphere, see impostor_frames.glsl, the ones
+// from below take the horizon; instances are moved and scaled uniformly but
+// not rotated; the impostor owns the source and draws it in place of the
+// instances that come closer than the views hold detail for, see SelectInstances()
+class OctahedralImpostor : public Drawable
+{
+public:
+	// views per side of the atlases, FRAMES in impostor_frames.glsl
+	static const unsigned int FRAMES = 8;
+
+private:
+	// the last mip level still has this many texels per view
+	static const unsigned int MIN_FRAME_SIZE = 8;
+
+	unsigned int frame_size;
+	unsigned int mip_levels;
+
+	Drawable *source;
+	std::vector<glm::vec4> instances;
+	std::vector<bool> close; // drawn as the source
+	std::vector<glm::mat4> source_models;
+
+	unsigned int albedo_atlas; // as the source's albedo map, a the coverage
+	unsigned int normal_atlas; // the source's own space, w the depth along the view
+	unsigned int orm_atlas;
+
+	unsigned int count;
+	float source_radius;
+
+private:
+	unsigned int CreateAtlas(unsigned int format) const noexcept;
+
+	// the instances not drawn as the source, into VBO
+	void UploadInstances() noexcept;
+
+	// towards the camera of a view, as FrameDirection() in impostor_frames.glsl
+	static glm::vec3 GetFrameDirection(unsigned int x, unsigned int y) noexcept;
+
+public:
+	// frame_size is the texels per side of one view, a power of two; takes
+	// over source
+	OctahedralImpostor(Drawable *source, const std::vector<glm::vec4> &instances, unsigned int frame_size = 128) noexcept;
+	~OctahedralImpostor() noexcept;
+
+	// every view of the source in its own space, without its model, with its
+	// material through the scene's impostor_bake shader
+	void Bake(const Scene &scene) noexcept;
+
+	// xyz the position, w the scale, both before the model
+	void SetInstances(const std::vector<glm::vec4> &instances) noexcept;
+	// the quads drawn, without the instances drawn as the source
+	unsigned int GetCount() const noexcept;
+
+	// an instance whose bounds cover more pixels than frame_size, seen from
+	// camera, is drawn as the source until it covers fewer than
+	// LEVEL_HYSTERESIS of that; pixel_scale and threshold as in SelectLevel(),
+	// which picks the source's level for the nearest of them
+	void SelectInstances(const glm::vec3 &camera, float pixel_scale, float threshold) noexcept;
+
+	// the source and a model for each instance it is drawn for, before its position_decode
+	const Drawable *GetSource() const noexcept;
+	const std::vector<glm::mat4> &GetSourceModels() const noexcept;
+
+	void Draw() const noexcept override;
+};
+
+//==============================================================================
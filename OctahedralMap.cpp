@@ -0,0 +1,141 @@
+
+#include "OctahedralMap.h"
+
+#include <cmath>
+
+#include "GLAD/glad.h"
+
+//==============================================================================
+
+void OctahedralMap::SetParameters() noexcept
+{
+	// the folded edges have no simple wrap mode, clamping keeps them close
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+}
+
+//==============================================================================
+
+OctahedralMap::OctahedralMap(unsigned int size, unsigned int base_level, unsigned int max_level, HDRFormat format) noexcept :
+	texture(0),
+	format(format)
+{
+	glGenTextures(1, &texture);
+
+	glBindTexture(GL_TEXTURE_2D, texture);
+
+	// storage only for the requested part of the mip chain
+	for (unsigned int mip = base_level; mip <= max_level; mip++)
+	{
+		glTexImage2D(GL_TEXTURE_2D, mip, GetInternalFormat(format), size >> mip, size >> mip, 0, GL_RGB, GL_FLOAT, nullptr);
+	}
+
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, base_level);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL,  max_level);
+
+	SetParameters();
+
+	glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+//==============================================================================
+
+OctahedralMap::~OctahedralMap() noexcept
+{
+	glDeleteTextures(1, &texture);
+}
+
+//==============================================================================
+
+unsigned int OctahedralMap::GetID() const noexcept
+{
+	return texture;
+}
+
+//==============================================================================
+
+HDRFormat OctahedralMap::GetFormat() const noexcept
+{
+	return format;
+}
+
+//==============================================================================
+
+std::vector<float> OctahedralMap::Read(unsigned int mip) const noexcept
+{
+	glBindTexture(GL_TEXTURE_2D, texture);
+
+	int size = 0;
+	glGetTexLevelParameteriv(GL_TEXTURE_2D, mip, GL_TEXTURE_WIDTH, &size);
+
+	std::vector<float> data(static_cast<size_t>(3) * size * size);
+
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+	if (size > 0)
+	{
+		glGetTexImage(GL_TEXTURE_2D, mip, GL_RGB, GL_FLOAT, data.data());
+	}
+
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	return data;
+}
+
+//==============================================================================
+
+void OctahedralMap::Convert(HDRFormat format) noexcept
+{
+	if (format == this->format)
+	{
+		return;
+	}
+
+	int base_level = 0;
+	int max_level = 0;
+
+	glBindTexture(GL_TEXTURE_2D, texture);
+	glGetTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, &base_level);
+	glGetTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL,  &max_level);
+
+	// a round trip through the CPU, the driver encodes the new format on upload
+	std::vector<std::vector<float>> levels;
+	for (auto mip = base_level; mip <= max_level; mip++)
+	{
+		int size = 0;
+		glGetTexLevelParameteriv(GL_TEXTURE_2D, mip, GL_TEXTURE_WIDTH, &size);
+		if (size == 0)
+		{
+			break;
+		}
+
+		levels.push_back(Read(mip));
+	}
+
+	glBindTexture(GL_TEXTURE_2D, texture);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+	for (size_t level = 0; level < levels.size(); level++)
+	{
+		const auto mip = base_level + static_cast<int>(level);
+		const auto size = static_cast<int>(std::sqrt(levels[level].size() / 3));
+
+		glTexImage2D(GL_TEXTURE_2D, mip, GetInternalFormat(format), size, size, 0, GL_RGB, GL_FLOAT, levels[level].data());
+	}
+
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	this->format = format;
+}
+
+//==============================================================================
+
+void OctahedralMap::Bind(unsigned int texture_unit) const noexcept
+{
+	glActiveTexture(GL_TEXTURE0 + texture_unit);
+	glBindTexture(GL_TEXTURE_2D, texture);
+}
+
+//==============================================================================
@@ -0,0 +1,39 @@
+
+#pragma once
+
+//==============================================================================
+
+#include <vector>
+
+#include "HDRFormat.h"
+
+//==============================================================================
+
+// a sphere of directions unfolded onto one 2D texture through an octahedron,
+// rendered by octahedral.vs and looked up with OctEncode() in pbr.fs
+class OctahedralMap
+{
+private:
+	unsigned int texture;
+	HDRFormat format;
+
+public:
+	void SetParameters() noexcept;
+
+public:
+	OctahedralMap(unsigned int size, unsigned int base_level, unsigned int max_level, HDRFormat format = HDRFormat::RGB16F) noexcept;
+	~OctahedralMap() noexcept;
+
+	unsigned int GetID() const noexcept;
+	HDRFormat GetFormat() const noexcept;
+
+	// one mip level as RGB floats
+	std::vector<float> Read(unsigned int mip) const noexcept;
+
+	// re-stores every level, e.g. into RGB9E5 once rendering is done
+	void Convert(HDRFormat format) noexcept;
+
+	void Bind(unsigned int texture_unit = 0) const noexcept;
+};
+
+//==============================================================================
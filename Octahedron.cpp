@@ -0,0 +1,45 @@
+
+#include "Octahedron.h"
+
+#include <vector>
+
+#include "GLAD/glad.h"
+
+//==============================================================================
+
+Octahedron::Octahedron() noexcept
+{
+	// the centre is the +z pole, the corners all fold onto the -z pole
+	const std::vector<glm::vec3> positions =
+	{
+		{  0.0f,  0.0f,  0.0f }, {  1.0f,  0.0f,  0.0f }, {  0.0f,  1.0f,  0.0f },
+		{  0.0f,  0.0f,  0.0f }, {  0.0f,  1.0f,  0.0f }, { -1.0f,  0.0f,  0.0f },
+		{  0.0f,  0.0f,  0.0f }, { -1.0f,  0.0f,  0.0f }, {  0.0f, -1.0f,  0.0f },
+		{  0.0f,  0.0f,  0.0f }, {  0.0f, -1.0f,  0.0f }, {  1.0f,  0.0f,  0.0f },
+
+		{  1.0f,  1.0f,  0.0f }, {  0.0f,  1.0f,  0.0f }, {  1.0f,  0.0f,  0.0f },
+		{ -1.0f,  1.0f,  0.0f }, { -1.0f,  0.0f,  0.0f }, {  0.0f,  1.0f,  0.0f },
+		{ -1.0f, -1.0f,  0.0f }, {  0.0f, -1.0f,  0.0f }, { -1.0f,  0.0f,  0.0f },
+		{  1.0f, -1.0f,  0.0f }, {  1.0f,  0.0f,  0.0f }, {  0.0f, -1.0f,  0.0f }
+	};
+
+	// the corners are exact in snorm, which the seams of the unfolded map rely on
+	SetVertices(positions, {}, {}, {}, VertexFormat::Position::SNORM16);
+}
+
+//==============================================================================
+
+Octahedron::~Octahedron() noexcept
+{
+}
+
+//==============================================================================
+
+void Octahedron::Draw() const noexcept
+{
+	glBindVertexArray(VAO);
+	glDrawArrays(GL_TRIANGLES, 0, 24);
+	glBindVertexArray(0);
+}
+
+//==============================================================================
@@ -0,0 +1,20 @@
+
+#pragma once
+
+//==============================================================================
+
+#include "Drawable.h"
+
+//==============================================================================
+
+// the unfolded octahedron filling clip space, eight triangles
+class Octahedron : public Drawable
+{
+public:
+	Octahedron()  noexcept;
+	~Octahedron() noexcept;
+
+	void Draw() const noexcept override;
+};
+
+//==============================================================================
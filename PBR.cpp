@@ -6,11 +6,14 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
+#include "Benchmark.h"
 #include "Camera.h"
 #include "Cubemap.h"
+#include "IBLQuality.h"
 #include "Light.h"
 #include "Material.h"
 #include "Quad.h"
+#include "ReflectionProbe.h"
 #include "Scene.h"
 #include "Shader.h"
 #include "Skybox.h"
@@ -31,6 +34,7 @@ void Prepare       (Scene *scene) noexcept;
 void LoadMaterials (Scene *scene) noexcept;
 void AddObjects    (Scene *scene) noexcept;
 void AddLights     (Scene *scene) noexcept;
+void AddProbes     (Scene *scene) noexcept;
 
 //==============================================================================
 
@@ -41,7 +45,7 @@ Scene *scene = nullptr;
 
 //==============================================================================
 
-int main()
+int main(int argc, char **argv)
 {
 	glfwInit();
 	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
@@ -58,13 +62,50 @@ int main()
 	glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
 
 	gladLoadGLLoader((GLADloadproc)glfwGetProcAddress);
+	Shader::EnableParallelCompile((GLADloadproc)glfwGetProcAddress);
 
 	scene = new Scene(width, height);
+
+	// PBR --benchmark-formats compares the IBL storage formats and exits
+	if (argc > 1 && std::string(argv[1]) == "--benchmark-formats")
+	{
+		{
+			Benchmark benchmark(*scene);
+			Benchmark::Print(benchmark.CompareFormats("textures\\hdr\\cubemap.hdr", scene->GetQuality()));
+		}
+
+		delete scene;
+		glfwTerminate();
+		return 0;
+	}
+
+	// PBR --benchmark-meshes compares the optimized sphere order with the generated strip
+	if (argc > 1 && std::string(argv[1]) == "--benchmark-meshes")
+	{
+		{
+			Benchmark benchmark(*scene);
+			Benchmark::Print(benchmark.CompareMeshes());
+		}
+
+		delete scene;
+		glfwTerminate();
+		return 0;
+	}
+
 	Prepare(scene);
 
+	// PBR model.glb adds a glTF model below the spheres
+	if (argc > 1 && argv[1][0] != '-')
+	{
+		const auto start = glfwGetTime();
+		const auto count = scene->AddModel("model", argv[1], glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, -1.5f, 0.0f)));
+		std::cout << count << " meshes of " << argv[1] << " loaded in " << (glfwGetTime() - start) * 1000.0 << " ms" << std::endl;
+	}
+
 	while (!glfwWindowShouldClose(window))
 	{
 		ProcessInput(window);
+		scene->Update();
 		scene->Render();
 
 		glfwSwapBuffers(window);
@@ -169,7 +210,10 @@ void Prepare(Scene *scene) noexcept
 	AddObjects(scene);
 	AddLights(scene);
 
+	scene->SetQuality(IBLQuality::Get(IBLQuality::Preset::HIGH));
 	scene->AddCubemap("textures\\hdr\\cubemap.hdr");
+
+	AddProbes(scene);
 }
 
 //==============================================================================
@@ -251,3 +295,19 @@ void AddLights(Scene *scene) noexcept
 }
 
 //==============================================================================
+
+void AddProbes(Scene *scene) noexcept
+{
+	// dynamic reflections around the central sphere, one step per frame; the
+	// sphere itself is left out, the probe sits at its center
+	auto probe = scene->AddProbe(glm::vec3(0.0f, 0.0f, 0.0f));
+	probe->SetOwner(scene->GetObject("gold_sphere"));
+	probe->SetSchedule(1, 0);
+
+	// baked local probes around the side spheres, at their centers as well
+	scene->AddLocalProbe(glm::vec3(-1.5f, 0.0f, 0.0f), LocalProbes::Shape::SPHERE, glm::vec3(1.0f), 0.5f, scene->GetObject("plastic_sphere"));
+	scene->AddLocalProbe(glm::vec3( 1.5f, 0.0f, 0.0f), LocalProbes::Shape::SPHERE, glm::vec3(1.0f), 0.5f, scene->GetObject("iron_sphere"));
+	scene->BakeLocalProbes();
+}
+
+//==============================================================================
@@ -1,34 +1,24 @@
 
 #include "Quad.h"
 
+#include <vector>
+
 #include "GLAD/glad.h"
 
 //==============================================================================
 
 Quad::Quad() noexcept
 {
-	float vertices[] =
+	// brdf.vs derives the texture coordinates from the corners
+	const std::vector<glm::vec3> positions =
 	{
-		//  x      y      z      tx    ty
-		-1.0f,  1.0f,  0.0f,   0.0f, 1.0f,
-		-1.0f, -1.0f,  0.0f,   0.0f, 0.0f,
-		 1.0f,  1.0f,  0.0f,   1.0f, 1.0f,
-		 1.0f, -1.0f,  0.0f,   1.0f, 0.0f
+		{ -1.0f,  1.0f,  0.0f },
+		{ -1.0f, -1.0f,  0.0f },
+		{  1.0f,  1.0f,  0.0f },
+		{  1.0f, -1.0f,  0.0f }
 	};
 
-	glBindVertexArray(VAO);
-	glBindBuffer(GL_ARRAY_BUFFER, VBO);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), &vertices[0], GL_STATIC_DRAW);
-
-	const auto stride = static_cast<unsigned int>((3 + 2) * sizeof(float));
-
-	glEnableVertexAttribArray(0);
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (void*)0);
-	glEnableVertexAttribArray(1);
-	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, stride, (void*)(3 * sizeof(float)));
-
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
-	glBindVertexArray(0);
+	SetVertices(positions, {}, {}, {}, VertexFormat::Position::SNORM16);
 }
 
 //==============================================================================
@@ -0,0 +1,201 @@
+
+#include "ReflectionProbe.h"
+
+#include "Cubemap.h"
+#include "Scene.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "GLAD/glad.h"
+
+//==============================================================================
+
+void ReflectionProbe::Step(const Scene &scene) noexcept
+{
+	const auto back = 1 - front;
+
+	if (step < 6)
+	{
+		// render one face of the scene around the probe, kept in linear HDR for the IBL filters
+		const auto view = scene.GetCaptureView(step) * glm::translate(glm::mat4(1.0f), -position);
+
+		glBindFramebuffer(GL_FRAMEBUFFER, FBO);
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_CUBE_MAP_POSITIVE_X + step, capture->GetID(), 0);
+		glViewport(0, 0, quality.probe_size, quality.probe_size);
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+		scene.RenderView(view, projection, position, nullptr, nullptr, false, owner);
+
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	}
+	else
+	if (step == 6)
+	{
+		capture->GenerateMipmap();
+		scene.CalculateIrradiance(capture, irradiance_map[back], quality.irradiance_size, quality.irradiance_delta);
+	}
+	else
+	{
+		const auto mip = step - 7;
+		scene.PrefilterEnvironmentMap(capture, quality.probe_size, prefilter_map[back], quality.prefilter_size, mip, quality.prefilter_mips, quality.sample_count);
+	}
+
+	step++;
+
+	// the finished set becomes visible only after its last prefilter mip
+	if (step == GetStepCount())
+	{
+		front = back;
+		ready = true;
+		step  = 0;
+		idle  = idle_frames;
+	}
+}
+
+//==============================================================================
+
+ReflectionProbe::ReflectionProbe(const glm::vec3 &position, const IBLQuality &quality) noexcept :
+	position(position),
+	quality(quality),
+	owner(nullptr),
+	steps_per_frame(1),
+	idle_frames(0),
+	step(0),
+	idle(0),
+	front(0),
+	ready(false),
+	FBO(0),
+	RBO(0),
+	capture(nullptr),
+	irradiance_map{nullptr, nullptr},
+	prefilter_map{nullptr, nullptr}
+{
+	projection = glm::perspective(glm::radians(90.0f), 1.0f, 0.1f, 100.0f);
+
+	const auto size = quality.probe_size;
+
+	const auto format = GetRenderableFormat(quality.format);
+
+	capture = new Cubemap(size, size, true, format);
+	capture->GenerateMipmap();
+
+	for (unsigned int i = 0; i < 2; i++)
+	{
+		irradiance_map[i] = new Cubemap(quality.irradiance_size, quality.irradiance_size, false, format);
+		prefilter_map[i]  = new Cubemap(quality.prefilter_size, 0, quality.prefilter_mips - 1, format);
+	}
+
+	glGenFramebuffers(1, &FBO);
+	glGenRenderbuffers(1, &RBO);
+
+	glBindFramebuffer(GL_FRAMEBUFFER, FBO);
+	glBindRenderbuffer(GL_RENDERBUFFER, RBO);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, size, size);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, RBO);
+	glBindRenderbuffer(GL_RENDERBUFFER, 0);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+//==============================================================================
+
+ReflectionProbe::~ReflectionProbe() noexcept
+{
+	glDeleteFramebuffers(1, &FBO);
+	glDeleteRenderbuffers(1, &RBO);
+
+	delete capture;
+
+	for (unsigned int i = 0; i < 2; i++)
+	{
+		delete irradiance_map[i];
+		delete prefilter_map[i];
+	}
+}
+
+//==============================================================================
+
+const glm::vec3 &ReflectionProbe::GetPosition() const noexcept
+{
+	return position;
+}
+
+//==============================================================================
+
+void ReflectionProbe::SetPosition(const glm::vec3 &position) noexcept
+{
+	this->position = position;
+}
+
+//==============================================================================
+
+const Drawable *ReflectionProbe::GetOwner() const noexcept
+{
+	return owner;
+}
+
+//==============================================================================
+
+void ReflectionProbe::SetOwner(const Drawable *owner) noexcept
+{
+	this->owner = owner;
+}
+
+//==============================================================================
+
+void ReflectionProbe::SetSchedule(unsigned int steps_per_frame, unsigned int idle_frames) noexcept
+{
+	this->steps_per_frame = steps_per_frame;
+	this->idle_frames     = idle_frames;
+}
+
+//==============================================================================
+
+unsigned int ReflectionProbe::GetStepCount() const noexcept
+{
+	// six faces, irradiance, then one step per prefilter mip
+	return 6 + 1 + quality.prefilter_mips;
+}
+
+//==============================================================================
+
+bool ReflectionProbe::IsReady() const noexcept
+{
+	return ready;
+}
+
+//==============================================================================
+
+const Cubemap *ReflectionProbe::GetIrradianceMap() const noexcept
+{
+	return irradiance_map[front];
+}
+
+//==============================================================================
+
+const Cubemap *ReflectionProbe::GetPrefilterMap() const noexcept
+{
+	return prefilter_map[front];
+}
+
+//==============================================================================
+
+void ReflectionProbe::Update(const Scene &scene) noexcept
+{
+	if (idle > 0)
+	{
+		idle--;
+		return;
+	}
+
+	for (unsigned int i = 0; i < steps_per_frame; i++)
+	{
+		Step(scene);
+
+		if (step == 0)
+		{
+			break;
+		}
+	}
+}
+
+//==============================================================================
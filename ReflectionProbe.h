@@ -0,0 +1,69 @@
+
+#pragma once
+
+//==============================================================================
+
+#include <glm/glm.hpp>
+
+#include "IBLQuality.h"
+
+//==============================================================================
+
+class Cubemap;
+class Drawable;
+class Scene;
+
+//==============================================================================
+
+class ReflectionProbe
+{
+private:
+	glm::vec3 position;
+	IBLQuality quality;
+
+	const Drawable *owner;
+
+	unsigned int steps_per_frame;
+	unsigned int idle_frames;
+
+	unsigned int step;
+	unsigned int idle;
+	unsigned int front;
+	bool ready;
+
+	unsigned int FBO;
+	unsigned int RBO;
+
+	glm::mat4 projection;
+
+	Cubemap *capture;
+	Cubemap *irradiance_map[2];
+	Cubemap *prefilter_map[2];
+
+private:
+	void Step(const Scene &scene) noexcept;
+
+public:
+	ReflectionProbe(const glm::vec3 &position, const IBLQuality &quality) noexcept;
+	~ReflectionProbe() noexcept;
+
+	const glm::vec3 &GetPosition() const        noexcept;
+	void SetPosition(const glm::vec3 &position) noexcept;
+
+	// the object the probe sits inside, left out of the captures so they see
+	// what is around it rather than its inside; nullptr captures everything
+	const Drawable *GetOwner() const     noexcept;
+	void SetOwner(const Drawable *owner) noexcept;
+
+	void SetSchedule(unsigned int steps_per_frame, unsigned int idle_frames) noexcept;
+
+	unsigned int GetStepCount() const noexcept;
+	bool IsReady()              const noexcept;
+
+	const Cubemap *GetIrradianceMap() const noexcept;
+	const Cubemap *GetPrefilterMap()  const noexcept;
+
+	void Update(const Scene &scene) noexcept;
+};
+
+//==============================================================================
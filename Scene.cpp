@@ -3,154 +3,496 @@
 
 #include "Debug.h"
 
+#include "AssetPack.h"
 #include "Camera.h"
+#include "ClusterCuller.h"
 #include "Cubemap.h"
+#include "Environment.h"
+#include "EnvironmentManager.h"
+#include "GltfLoader.h"
+#include "IrradianceVolume.h"
 #include "Light.h"
+#include "LocalProbes.h"
 #include "Material.h"
+#include "Mesh.h"
+#include "OctahedralImpostor.h"
+#include "OctahedralMap.h"
+#include "Octahedron.h"
 #include "Quad.h"
+#include "ReflectionProbe.h"
 #include "Shader.h"
+#include "ShaderCache.h"
 #include "Skybox.h"
+#include "Sky.h"
 #include "Sphere.h"
+#include "SphereImpostors.h"
 #include "Texture.h"
 
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
 #include <glm/gtc/matrix_transform.hpp>
 
 //==============================================================================
 
-void Scene::PrepareEnvironmentMap()
+void Scene::PrecomputeBRDF(unsigned int band) noexcept
 {
+	// the LUT is integrated in horizontal bands spread over several frames
+	const auto size = quality.brdf_size;
+	const auto band_height = size / BRDF_BANDS;
+
 	glBindFramebuffer(GL_FRAMEBUFFER, FBO);
-	glBindRenderbuffer(GL_RENDERBUFFER, RBO);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, brdfLUT_texture->GetID(), 0);
+	glViewport(0, 0, size, size);
 
-	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, 512, 512);
-	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, RBO);
+	glEnable(GL_SCISSOR_TEST);
+	glScissor(0, band * band_height, size, band_height);
 
-	hdr_texture = new Texture;
-	hdr_texture->LoadHDR(cubemap);
+	auto brdf_shader = GetShader("brdf");
+	brdf_shader->Use();
+	brdf_shader->SetInt("sample_count", quality.sample_count);
 
-	env_cubemap = new Cubemap(512, 512);
+	glClear(GL_COLOR_BUFFER_BIT);
 
-	auto rect2cubemap_shader = GetShader("rect2cubemap");
-	rect2cubemap_shader->Use();
-	rect2cubemap_shader->SetInt("rectangular_map", 0);
-	rect2cubemap_shader->SetMat4("projection", capture_projection);
+	quad->Draw();
 
-	hdr_texture->Bind(0);
+	glDisable(GL_SCISSOR_TEST);
 
-	glViewport(0, 0, 512, 512);
-	glBindFramebuffer(GL_FRAMEBUFFER, FBO);
-	for (unsigned int i = 0; i < 6; i++)
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+	glViewport(0, 0, width, height);
+}
+
+//==============================================================================
+
+void Scene::StartVolumeBake() noexcept
+{
+	// a snapshot of the scene for the CPU integrator
+	std::vector<IrradianceVolume::Occluder> occluders;
+	for (auto object : objects)
 	{
-		rect2cubemap_shader->SetMat4("view", capture_views[i]);
-		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, env_cubemap->GetID(), 0);
-		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		const auto material = object.second->GetMaterial();
+		occluders.push_back({ object.second->GetBoundingSphere(), material ? material->GetAverageAlbedo() : glm::vec3(0.5f) });
+	}
 
-		skybox->Draw();
+	std::vector<IrradianceVolume::Emitter> emitters;
+	for (auto light : lights)
+	{
+		emitters.push_back({ light.second->GetPosition(), light.second->GetColor() });
 	}
 
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
-	glBindRenderbuffer(GL_RENDERBUFFER, 0);
+	const auto environment = environments->GetCurrent();
+	const auto sky_sh = sky ? sky->GetRadianceSH() : environment->GetRadianceSH();
 
-	env_cubemap->GenerateMipmap();
+	volume->Bake(occluders, emitters, sky_sh);
 }
 
 //==============================================================================
 
-void Scene::CalculateIrradiance()
+bool Scene::AreShadersReady() const noexcept
 {
-	glBindFramebuffer(GL_FRAMEBUFFER, FBO);
-	glBindRenderbuffer(GL_RENDERBUFFER, RBO);
-	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, 32, 32);
+	for (auto shader : shaders)
+	{
+		if (!shader.second->IsReady())
+		{
+			return false;
+		}
+	}
 
-	irradiance_map = new Cubemap(32, 32, false);
+	return true;
+}
 
-	auto irradiance_shader = GetShader("irradiance");
-	irradiance_shader->Use();
-	irradiance_shader->SetInt("environment_map", 0);
-	irradiance_shader->SetMat4("projection", capture_projection);
+//==============================================================================
 
-	env_cubemap->Bind(0);
+void Scene::RemoveModel(const std::string &name) noexcept
+{
+	for (auto it = objects.begin(); it != objects.end();)
+	{
+		if (IsModelPart(it->first, name + "/mesh"))
+		{
+			delete it->second;
+			it = objects.erase(it);
+		}
+		else
+		{
+			++it;
+		}
+	}
 
-	glViewport(0, 0, 32, 32);
-	glBindFramebuffer(GL_FRAMEBUFFER, FBO);
-	for (unsigned int i = 0; i < 6; i++)
+	for (auto it = materials.begin(); it != materials.end();)
+	{
+		if (IsModelPart(it->first, name + "/material"))
+		{
+			delete it->second;
+			it = materials.erase(it);
+		}
+		else
+		{
+			++it;
+		}
+	}
+
+	for (auto it = textures.begin(); it != textures.end();)
 	{
-		irradiance_shader->SetMat4("view", capture_views[i]);
-		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, irradiance_map->GetID(), 0);
-		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		if (IsModelPart(it->first, name + "/texture"))
+		{
+			delete it->second;
+			it = textures.erase(it);
+		}
+		else
+		{
+			++it;
+		}
+	}
+}
 
-		skybox->Draw();
+//==============================================================================
+
+bool Scene::IsModelPart(const std::string &key, const std::string &prefix) noexcept
+{
+	// the prefix and an index, name/mesh1 but not name/mesh1/mesh0
+	if (key.size() <= prefix.size() || key.compare(0, prefix.size(), prefix) != 0)
+	{
+		return false;
 	}
 
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
-	glBindRenderbuffer(GL_RENDERBUFFER, 0);
+	return key.find_first_not_of("0123456789", prefix.size()) == std::string::npos;
 }
 
 //==============================================================================
 
-void Scene::PrefilterEnvironmentMap()
+void Scene::BindEnvironment(const Shader *pbr_shader, const Cubemap *irradiance, const Cubemap *prefilter) const noexcept
 {
-	prefilter_map = new Cubemap(128, 128);
-	prefilter_map->GenerateMipmap();
+	// the sky replaces the loaded environments while it is set
+	const auto environment = sky ? nullptr : environments->GetCurrent();
 
-	auto prefilter_shader = GetShader("prefilter");
-	prefilter_shader->Use();
-	prefilter_shader->SetInt("environment_map", 0);
-	prefilter_shader->SetMat4("projection", capture_projection);
+	const auto sh = sky ? sky->GetSH() : environment ? environment->GetSH() : nullptr;
+	for (unsigned int i = 0; i < 9; i++)
+	{
+		pbr_shader->SetVec3("sh[" + std::to_string(i) + "]", sh ? sh[i] : glm::vec3(0.0f));
+	}
 
-	env_cubemap->Bind(0);
+	const auto env_map  = sky ? sky->GetEnvironmentMap() : environment ? environment->GetEnvironmentMap() : nullptr;
+	const auto env_size = sky ? sky->GetSize() : environment ? environment->GetSize() : 1;
 
-	glBindFramebuffer(GL_FRAMEBUFFER, FBO);
-	unsigned int max_mip_levels = 5;
-	for (unsigned int mip = 0; mip < max_mip_levels; mip++)
-	{
-		const auto mip_width  = static_cast<unsigned int>(128 * pow(0.5, mip));
-		const auto mip_height = static_cast<unsigned int>(128 * pow(0.5, mip));
-		glBindRenderbuffer(GL_RENDERBUFFER, RBO);
-		glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, mip_width, mip_height);
-		glViewport(0, 0, mip_width, mip_height);
-
-		const auto roughness = static_cast<float>(mip) / static_cast<float>(max_mip_levels - 1);
-		prefilter_shader->SetFloat("roughness", roughness);
-		for (unsigned int i = 0; i < 6; i++)
+	// a lazily baked environment only holds the mips its materials can reach
+	const auto max_lod = quality.GetMaxReflectionLOD();
+	const auto lod_range = !prefilter && environment ? environment->GetPrefilterRange() : glm::vec2(0.0f, max_lod);
+	pbr_shader->SetFloat("max_reflection_lod", max_lod);
+	pbr_shader->SetVec2("prefilter_lod_range", lod_range);
+
+	// the outgoing environment fades out of the global maps only
+	const auto outgoing = !prefilter && !sky ? environments->GetPrevious() : nullptr;
+	const auto fading = outgoing && (outgoing->GetPrefilterMap() || outgoing->GetPrefilterOctahedral());
+	pbr_shader->SetFloat("fade", fading ? environments->GetFade() : 0.0f);
+	if (fading)
+	{
+		pbr_shader->SetVec2("fade_lod_range", outgoing->GetPrefilterRange());
+		if (outgoing->IsOctahedral())
+		{
+			outgoing->GetIrradianceOctahedral()->Bind(11);
+			outgoing->GetPrefilterOctahedral()->Bind(12);
+		}
+		else
 		{
-			prefilter_shader->SetMat4("view", capture_views[i]);
-			glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, prefilter_map->GetID(), mip);
-			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+			outgoing->GetIrradianceMap()->Bind(11);
+			outgoing->GetPrefilterMap()->Bind(12);
+		}
+	}
+
+	// an octahedral environment, unless the caller passes its own cubemaps,
+	// see GetEnvironmentVariant()
+	const auto octahedral = !irradiance && !prefilter && environment && environment->IsOctahedral();
+	const auto irradiance_oct = octahedral ? environment->GetIrradianceOctahedral() : nullptr;
+	const auto prefilter_oct  = octahedral ? environment->GetPrefilterOctahedral()  : nullptr;
+
+	// progressive fallbacks: SH, then mips of the environment map
+	if (!irradiance && environment)
+	{
+		irradiance = environment->GetIrradianceMap();
+	}
+
+	if (!prefilter && environment)
+	{
+		prefilter = environment->GetPrefilterMap();
+	}
+
+	if (!prefilter && sky)
+	{
+		prefilter = sky->GetPrefilterMap();
+	}
+
+	pbr_shader->SetBool("use_irradiance_map", irradiance || irradiance_oct);
+	if (irradiance)
+	{
+		irradiance->Bind(0);
+	}
+	else
+	if (irradiance_oct)
+	{
+		irradiance_oct->Bind(0);
+	}
+
+	if (prefilter)
+	{
+		pbr_shader->SetInt("specular_source", 2);
+		prefilter->Bind(1);
+	}
+	else
+	if (prefilter_oct)
+	{
+		pbr_shader->SetInt("specular_source", 2);
+		prefilter_oct->Bind(1);
+	}
+	else
+	if (env_map)
+	{
+		pbr_shader->SetInt("specular_source", 1);
+		pbr_shader->SetFloat("environment_lod", std::log2(static_cast<float>(env_size)));
+		env_map->Bind(10);
+	}
+	else
+	{
+		pbr_shader->SetInt("specular_source", 0);
+	}
+
+	// spatially varying diffuse from the baked grid replaces the global irradiance
+	const auto use_volume = volume && volume->IsReady();
+	pbr_shader->SetBool("use_irradiance_volume", use_volume);
+	if (use_volume)
+	{
+		volume->Bind(pbr_shader, 13);
+	}
+
+	const auto brdf_ready = brdf_bands == BRDF_BANDS;
+	pbr_shader->SetBool("use_brdfLUT", brdf_ready);
+	if (brdf_ready)
+	{
+		brdfLUT_texture->Bind(2);
+	}
+}
+
+//==============================================================================
+
+bool Scene::ReadShader(const std::string &vpath, const std::string &gpath, const std::string &fpath,
+	std::string &vcode, std::string &gcode, std::string &fcode) const noexcept
+{
+	const auto vertex   = pack->Find(vpath);
+	const auto geometry = gpath.empty() ? nullptr : pack->Find(gpath);
+	const auto fragment = pack->Find(fpath);
 
-			skybox->Draw();
+	if (vertex && fragment && (gpath.empty() || geometry))
+	{
+		vcode.assign(reinterpret_cast<const char *>(pack->GetData(*vertex)), static_cast<size_t>(vertex->size));
+		fcode.assign(reinterpret_cast<const char *>(pack->GetData(*fragment)), static_cast<size_t>(fragment->size));
+		if (geometry)
+		{
+			gcode.assign(reinterpret_cast<const char *>(pack->GetData(*geometry)), static_cast<size_t>(geometry->size));
 		}
+		return true;
 	}
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+	return Shader::Read(vpath, vcode) && (gpath.empty() || Shader::Read(gpath, gcode)) && Shader::Read(fpath, fcode);
 }
 
 //==============================================================================
 
-void Scene::PrecomputeBRDF()
+bool Scene::ReadShader(const std::string &path, std::string &code) const noexcept
 {
-	brdfLUT_texture = new Texture;
+	const auto entry = pack->Find(path);
+	if (entry)
+	{
+		code.assign(reinterpret_cast<const char *>(pack->GetData(*entry)), static_cast<size_t>(entry->size));
+		return true;
+	}
 
-	brdfLUT_texture->Bind(0);
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_RG16F, 512, 512, 0, GL_RG, GL_FLOAT, nullptr);
-	brdfLUT_texture->SetParametersHDR();
+	return Shader::Read(path, code);
+}
 
-	glBindFramebuffer(GL_FRAMEBUFFER, FBO);
-	glBindRenderbuffer(GL_RENDERBUFFER, RBO);
-	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, 512, 512);
-	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, brdfLUT_texture->GetID(), 0);
-	glViewport(0, 0, 512, 512);
+//==============================================================================
 
-	auto brdf_shader = GetShader("brdf");
-	brdf_shader->Use();
+unsigned int Scene::GetPBRVariant(const Drawable *object, bool ibl, bool tonemap) const noexcept
+{
+	const auto material = object->GetMaterial();
 
-	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+	auto variant = static_cast<unsigned int>(lights.size() < MAX_LIGHTS ? lights.size() : MAX_LIGHTS);
 
-	quad->Draw();
+	if (material->GetNormal())
+	{
+		variant |= PBR_NORMAL_MAP;
+	}
 
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
-	glBindRenderbuffer(GL_RENDERBUFFER, 0);
+	if (material->GetORM())
+	{
+		variant |= PBR_ORM_MAP;
+	}
 
-	glViewport(0, 0, width, height);
+	if (ibl)
+	{
+		variant |= PBR_IBL;
+	}
+
+	if (tonemap)
+	{
+		variant |= PBR_TONEMAP;
+	}
+
+	if (dynamic_cast<const SphereImpostors*>(object))
+	{
+		variant |= PBR_IMPOSTOR;
+	}
+
+	// the atlases always hold a normal and packed ORM
+	if (dynamic_cast<const OctahedralImpostor*>(object))
+	{
+		variant |= PBR_OCT_IMPOSTOR | PBR_NORMAL_MAP | PBR_ORM_MAP;
+	}
+
+	return variant;
+}
+
+//==============================================================================
+
+unsigned int Scene::GetEnvironmentVariant(const Cubemap *irradiance, const Cubemap *prefilter) const noexcept
+{
+	const auto environment = sky ? nullptr : environments->GetCurrent();
+	const auto outgoing = !prefilter && !sky ? environments->GetPrevious() : nullptr;
+
+	unsigned int variant = 0;
+	if (!irradiance && !prefilter && environment && environment->IsOctahedral())
+	{
+		variant |= PBR_OCTAHEDRAL;
+	}
+
+	if (outgoing && outgoing->IsOctahedral() && outgoing->GetPrefilterOctahedral())
+	{
+		variant |= PBR_FADE_OCTAHEDRAL;
+	}
+
+	return variant;
+}
+
+//==============================================================================
+
+Shader *Scene::GetPBRShader(unsigned int variant) const noexcept
+{
+	const auto it = pbr_shaders.find(variant);
+	if (it != pbr_shaders.end())
+	{
+		return it->second;
+	}
+
+	const auto light_count = variant & PBR_LIGHT_COUNT;
+
+	std::string defines = "#define LIGHT_COUNT " + std::to_string(light_count) + "\n";
+	defines += "#define MAX_PROBES " + std::to_string(LocalProbes::MAX_PROBES) + "\n";
+	if (variant & PBR_NORMAL_MAP)
+	{
+		defines += "#define NORMAL_MAP\n";
+	}
+	if (variant & PBR_ORM_MAP)
+	{
+		defines += "#define ORM_MAP\n";
+	}
+	if (variant & PBR_IBL)
+	{
+		defines += "#define IBL\n";
+	}
+	if (variant & PBR_TONEMAP)
+	{
+		defines += "#define TONEMAP\n";
+	}
+	if (variant & PBR_IMPOSTOR)
+	{
+		defines += "#define IMPOSTOR\n";
+	}
+	if (variant & PBR_OCT_IMPOSTOR)
+	{
+		defines += "#define OCT_IMPOSTOR\n";
+	}
+	if (variant & PBR_OCTAHEDRAL)
+	{
+		defines += "#define OCTAHEDRAL\n";
+	}
+	if (variant & PBR_FADE_OCTAHEDRAL)
+	{
+		defines += "#define FADE_OCTAHEDRAL\n";
+	}
+
+	const auto &vcode = (variant & PBR_IMPOSTOR) ? impostor_vcode : (variant & PBR_OCT_IMPOSTOR) ? oct_impostor_vcode : pbr_vcode;
+
+	auto shader = new Shader;
+	shader->Init(vcode, Shader::AddDefines(pbr_fcode, defines), shader_cache);
+	shader->Use();
+
+	// only what the variant samples is active, the rest would not be found
+	if (light_count > 0 || (variant & PBR_IBL))
+	{
+		shader->SetInt("material.albedo", 3);
+		if (variant & PBR_NORMAL_MAP)
+		{
+			shader->SetInt("material.normal", 4);
+		}
+		if (variant & PBR_ORM_MAP)
+		{
+			shader->SetInt("material.orm", 5);
+		}
+		else
+		{
+			shader->SetInt("material.metallic",  5);
+			shader->SetInt("material.roughness", 6);
+		}
+	}
+
+	if (variant & PBR_IBL)
+	{
+		if (!(variant & PBR_ORM_MAP))
+		{
+			shader->SetInt("material.ao", 7);
+		}
+
+		shader->SetInt("irradiance_map",      0);
+		shader->SetInt("prefilter_map",       1);
+		shader->SetInt("brdfLUT",             2);
+		shader->SetInt("probe_irradiance",    8);
+		shader->SetInt("probe_prefilter",     9);
+		shader->SetInt("environment_map",     10);
+		shader->SetInt("fade_irradiance_map", 11);
+		shader->SetInt("fade_prefilter_map",  12);
+		shader->SetInt("irradiance_volume",   13);
+		shader->SetUniformBlock("Probes", 1);
+	}
+
+	SetLights(shader, light_count);
+
+	pbr_shaders[variant] = shader;
+	return shader;
+}
+
+//==============================================================================
+
+void Scene::SetLights(const Shader *pbr_shader, unsigned int count) const noexcept
+{
+	unsigned int i = 0;
+	for (auto &light : lights)
+	{
+		if (i == count)
+		{
+			break;
+		}
+
+		pbr_shader->SetVec3("lights[" + std::to_string(i) + "].position", light.second->GetPosition());
+		pbr_shader->SetVec3("lights[" + std::to_string(i) + "].color",    light.second->GetColor());
+		i++;
+	}
+}
+
+//==============================================================================
+
+bool Scene::CompareVariant(const DrawItem &a, const DrawItem &b) noexcept
+{
+	return a.variant < b.variant;
 }
 
 //==============================================================================
@@ -159,13 +501,24 @@ Scene::Scene(unsigned int width, unsigned int height) noexcept :
 	width(width),
 	height(height),
 	camera(nullptr),
-	hdr_texture(nullptr),
-	env_cubemap(nullptr),
-	irradiance_map(nullptr),
-	prefilter_map(nullptr),
+	quality(IBLQuality::Get(IBLQuality::Preset::HIGH)),
+	pack(nullptr),
+	shader_cache(nullptr),
+	environments(nullptr),
+	sky(nullptr),
 	brdfLUT_texture(nullptr),
+	brdf_bands(0),
+	skybox(nullptr),
 	quad(nullptr),
-	skybox(nullptr)
+	octahedron(nullptr),
+	probe(nullptr),
+	local_probes(nullptr),
+	local_probes_pending(false),
+	volume(nullptr),
+	volume_pending(false),
+	culler(nullptr),
+	meshlet_culling(true),
+	level_threshold(1.0f)
 {
 	#ifdef _DEBUG
 	glEnable(GL_DEBUG_OUTPUT);
@@ -181,12 +534,25 @@ Scene::Scene(unsigned int width, unsigned int height) noexcept :
 	glEnable(GL_TEXTURE_CUBE_MAP_SEAMLESS);
 
 	glGenFramebuffers(1, &FBO);
-	glGenRenderbuffers(1, &RBO);
+	glGenBuffers(1, &capture_UBO);
 
 	camera = new Camera(glm::vec3(0.0f, 0.0f, 3.0f));
 
 	skybox = new Skybox;
 	quad   = new Quad;
+	octahedron = new Octahedron;
+
+	pack = new AssetPack;
+	pack->Open("assets.pak");
+
+	shader_cache = new ShaderCache("shader_cache");
+
+	environments = new EnvironmentManager;
+	environments->SetAssetPack(pack);
+	local_probes = new LocalProbes;
+	culler = new ClusterCuller;
+
+	SetQuality(quality);
 
 	capture_projection = glm::perspective(glm::radians(90.0f), 1.0f, 0.1f, 10.0f);
 
@@ -197,28 +563,55 @@ Scene::Scene(unsigned int width, unsigned int height) noexcept :
 	capture_views[4] = glm::lookAt(glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3( 0.0f,  0.0f,  1.0f), glm::vec3(0.0f, -1.0f,  0.0f));
 	capture_views[5] = glm::lookAt(glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3( 0.0f,  0.0f, -1.0f), glm::vec3(0.0f, -1.0f,  0.0f));
 
-	AddShader("pbr",          "shaders\\pbr.vs",        "shaders\\pbr.fs");
+	// std140: projection followed by the six face views
+	glBindBuffer(GL_UNIFORM_BUFFER, capture_UBO);
+	glBufferData(GL_UNIFORM_BUFFER, 7 * sizeof(glm::mat4), nullptr, GL_STATIC_DRAW);
+	glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(glm::mat4), &capture_projection[0][0]);
+	glBufferSubData(GL_UNIFORM_BUFFER, sizeof(glm::mat4), 6 * sizeof(glm::mat4), &capture_views[0][0][0]);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	glBindBufferBase(GL_UNIFORM_BUFFER, 0, capture_UBO);
+
 	AddShader("background",   "shaders\\background.vs", "shaders\\background.fs");
-	AddShader("rect2cubemap", "shaders\\cubemap.vs",    "shaders\\rect2cubemap.fs");
-	AddShader("irradiance",   "shaders\\cubemap.vs",    "shaders\\irradiance.fs");
-	AddShader("prefilter",    "shaders\\cubemap.vs",    "shaders\\prefilter.fs");
+	AddShader("rect2cubemap", "shaders\\cubemap.vs",    "shaders\\cubemap.gs", "shaders\\rect2cubemap.fs");
+	AddShader("irradiance",   "shaders\\cubemap.vs",    "shaders\\cubemap.gs", "shaders\\irradiance.fs");
+	AddShader("prefilter",    "shaders\\cubemap.vs",    "shaders\\cubemap.gs", "shaders\\prefilter.fs");
+	AddShader("irradiance_oct", "shaders\\octahedral.vs", "shaders\\irradiance.fs");
+	AddShader("prefilter_oct",  "shaders\\octahedral.vs", "shaders\\prefilter.fs");
 	AddShader("brdf",         "shaders\\brdf.vs",       "shaders\\brdf.fs");
-
-	auto pbr_shader = GetShader("pbr");
-	pbr_shader->Use();
-
-	pbr_shader->SetInt("irradiance_map",     0);
-	pbr_shader->SetInt("prefilter_map",      1);
-	pbr_shader->SetInt("brdfLUT",            2);
-	pbr_shader->SetInt("material.albedo",    3);
-	pbr_shader->SetInt("material.normal",    4);
-	pbr_shader->SetInt("material.metallic",  5);
-	pbr_shader->SetInt("material.roughness", 6);
-	pbr_shader->SetInt("material.ao",        7);
+	AddShader("sky",          "shaders\\background.vs", "shaders\\sky.fs");
+	AddShader("sky_capture",  "shaders\\cubemap.vs",    "shaders\\cubemap.gs", "shaders\\sky.fs");
+	AddShader("impostor_bake", "shaders\\impostor_bake.vs", "shaders\\impostor_bake.fs");
+
+	AddComputeShader("cull",          "shaders\\cull.cs");
+	AddComputeShader("depth_pyramid", "shaders\\depth_pyramid.cs");
+
+	// pbr.fs is only compiled per variant, see GetPBRShader()
+	std::string pbr_gcode;
+	ReadShader("shaders\\pbr.vs", std::string(), "shaders\\pbr.fs", pbr_vcode, pbr_gcode, pbr_fcode);
+	ReadShader("shaders\\impostor.vs", impostor_vcode);
+	ReadShader("shaders\\octahedral_impostor.vs", oct_impostor_vcode);
+
+	// every program is submitted before the first one is used,
+	// so the driver can compile them side by side
+	for (auto name : { "rect2cubemap", "irradiance", "prefilter", "sky_capture" })
+	{
+		GetShader(name)->SetUniformBlock("Capture", 0);
+	}
 
 	auto background_shader = GetShader("background");
 	background_shader->Use();
 	background_shader->SetInt("environment_map", 0);
+	background_shader->SetInt("fade_environment_map", 1);
+
+	// the units SetMaterial() binds
+	auto bake_shader = GetShader("impostor_bake");
+	bake_shader->Use();
+	bake_shader->SetInt("albedo_map",    3);
+	bake_shader->SetInt("normal_map",    4);
+	bake_shader->SetInt("orm_map",       5);
+	bake_shader->SetInt("metallic_map",  5);
+	bake_shader->SetInt("roughness_map", 6);
+	bake_shader->SetInt("ao_map",        7);
 }
 
 //==============================================================================
@@ -226,14 +619,12 @@ Scene::Scene(unsigned int width, unsigned int height) noexcept :
 Scene::~Scene() noexcept
 {
 	glDeleteFramebuffers(1, &FBO);
-	glDeleteRenderbuffers(1, &RBO);
+	glDeleteBuffers(1, &capture_UBO);
 
 	delete camera;
 
-	delete hdr_texture;
-	delete env_cubemap;
-	delete irradiance_map;
-	delete prefilter_map;
+	delete environments;
+	delete sky;
 	delete brdfLUT_texture;
 
 	for (auto shader : shaders)
@@ -241,6 +632,11 @@ Scene::~Scene() noexcept
 		delete shader.second;
 	}
 
+	for (auto shader : pbr_shaders)
+	{
+		delete shader.second;
+	}
+
 	for (auto texture : textures)
 	{
 		delete texture.second;
@@ -263,6 +659,16 @@ Scene::~Scene() noexcept
 
 	delete skybox;
 	delete quad;
+	delete octahedron;
+
+	delete probe;
+	delete local_probes;
+	delete volume;
+	delete culler;
+
+	// environments and textures may still point into the mapped pack
+	delete pack;
+	delete shader_cache;
 }
 
 //==============================================================================
@@ -277,6 +683,13 @@ void Scene::SetSize(unsigned int width, unsigned int height) noexcept
 //==============================================================================
 
 Shader *Scene::AddShader(const std::string &name, const std::string &vpath, const std::string &fpath) noexcept
+{
+	return AddShader(name, vpath, std::string(), fpath);
+}
+
+//==============================================================================
+
+Shader *Scene::AddShader(const std::string &name, const std::string &vpath, const std::string &gpath, const std::string &fpath) noexcept
 {
 	auto it = shaders.find(name);
 	if (it != shaders.end())
@@ -285,24 +698,65 @@ Shader *Scene::AddShader(const std::string &name, const std::string &vpath, cons
 	}
 
 	auto shader = new Shader;
-	shader->Load(vpath, fpath);
+
+	std::string vcode;
+	std::string gcode;
+	std::string fcode;
+
+	if (ReadShader(vpath, gpath, fpath, vcode, gcode, fcode))
+	{
+		shader->Init(vcode, gcode, fcode, shader_cache);
+	}
+
 	shaders[name] = shader;
 	return shader;
 }
 
 //==============================================================================
 
-Texture *Scene::AddTexture(const std::string &name, const std::string &path) noexcept
+Shader *Scene::AddComputeShader(const std::string &name, const std::string &cpath) noexcept
 {
-	const auto it = textures.find(name);
-	if (it != textures.end())
+	auto it = shaders.find(name);
+	if (it != shaders.end())
 	{
 		delete it->second;
 	}
 
-	auto texture = new Texture;
-	texture->Load(path);
-	textures[name] = texture;
+	auto shader = new Shader;
+
+	std::string ccode;
+	if (ReadShader(cpath, ccode))
+	{
+		shader->InitCompute(ccode, shader_cache);
+	}
+
+	shaders[name] = shader;
+	return shader;
+}
+
+//==============================================================================
+
+Texture *Scene::AddTexture(const std::string &name, const std::string &path) noexcept
+{
+	const auto it = textures.find(name);
+	if (it != textures.end())
+	{
+		delete it->second;
+	}
+
+	auto texture = new Texture;
+
+	const auto entry = pack->Find(path);
+	if (entry && entry->type == AssetPack::Type::TEXTURE)
+	{
+		texture->Load(*entry, pack->GetData(*entry));
+	}
+	else
+	{
+		texture->Load(path);
+	}
+
+	textures[name] = texture;
 	return texture;
 }
 
@@ -334,15 +788,16 @@ Light *Scene::AddLight(const std::string &name, const glm::vec3 &position, const
 	auto light = new Light(position, color);
 	lights[name] = light;
 
-	auto pbr_shader = GetShader("pbr");
-	pbr_shader->Use();
+	if (lights.size() > MAX_LIGHTS)
+	{
+		std::cout << "error: " << name << " is past the " << MAX_LIGHTS << " shaded lights" << std::endl;
+	}
 
-	unsigned int i = 0;
-	for (auto &light : lights)
+	// variants compiled so far; a new light count compiles its own
+	for (auto shader : pbr_shaders)
 	{
-		pbr_shader->SetVec3("lights[" + std::to_string(i) + "].position", light.second->GetPosition());
-		pbr_shader->SetVec3("lights[" + std::to_string(i) + "].color",    light.second->GetColor());
-		i++;
+		shader.second->Use();
+		SetLights(shader.second, shader.first & PBR_LIGHT_COUNT);
 	}
 
 	return light;
@@ -364,14 +819,190 @@ Drawable *Scene::AddObject(const std::string &name, Drawable *object) noexcept
 
 //==============================================================================
 
+size_t Scene::AddModel(const std::string &name, const std::string &path, const glm::mat4 &transform, bool optimize) noexcept
+{
+	GltfLoader loader;
+	if (!loader.Load(path, transform, optimize))
+	{
+		return 0;
+	}
+
+	// the old model may have had more of each, which would be left pointing at
+	// what is replaced
+	RemoveModel(name);
+
+	const auto &model_textures = loader.GetTextures();
+	for (size_t i = 0; i < model_textures.size(); i++)
+	{
+		textures[name + "/texture" + std::to_string(i)] = model_textures[i];
+	}
+
+	const auto &model_materials = loader.GetMaterials();
+	for (size_t i = 0; i < model_materials.size(); i++)
+	{
+		materials[name + "/material" + std::to_string(i)] = model_materials[i];
+	}
+
+	const auto &meshes = loader.GetMeshes();
+	for (size_t i = 0; i < meshes.size(); i++)
+	{
+		AddObject(name + "/mesh" + std::to_string(i), meshes[i]);
+	}
+
+	return meshes.size();
+}
+
+//==============================================================================
+
+OctahedralImpostor *Scene::AddImpostor(const std::string &name, const std::string &source, const std::vector<glm::vec4> &instances, unsigned int frame_size) noexcept
+{
+	const auto it = objects.find(source);
+	if (it == objects.end() || !it->second->GetMaterial())
+	{
+		std::cout << "error: impostor " << name << " has no source object " << source << " with a material" << std::endl;
+		return nullptr;
+	}
+
+	// the impostor takes over the source
+	auto impostor = new OctahedralImpostor(it->second, instances, frame_size);
+	objects.erase(it);
+	impostor->Bake(*this);
+
+	glViewport(0, 0, width, height);
+
+	AddObject(name, impostor);
+	return impostor;
+}
+
+//==============================================================================
+
+void Scene::SetQuality(const IBLQuality &quality) noexcept
+{
+	// applies to the environments and probes added afterwards
+	this->quality = quality;
+
+	delete brdfLUT_texture;
+
+	brdfLUT_texture = new Texture;
+	brdfLUT_texture->Bind(0);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RG16F, quality.brdf_size, quality.brdf_size, 0, GL_RG, GL_FLOAT, nullptr);
+	brdfLUT_texture->SetParametersHDR();
+	Texture::Unbind();
+
+	brdf_bands = 0;
+}
+
+//==============================================================================
+
+const IBLQuality &Scene::GetQuality() const noexcept
+{
+	return quality;
+}
+
+//==============================================================================
+
 void Scene::AddCubemap(const std::string &name) noexcept
 {
-	cubemap = name;
+	// loads in the background, Update() bakes it and crossfades to it
+	environments->Switch(name, quality);
+}
+
+//==============================================================================
+
+void Scene::LoadCubemap(const std::string &name) noexcept
+{
+	// makes a later AddCubemap() of the same name switch without a bake
+	environments->Load(name, quality);
+}
+
+//==============================================================================
+
+void Scene::SetEnvironmentBudget(size_t bytes) noexcept
+{
+	environments->SetBudget(bytes);
+}
+
+//==============================================================================
+
+void Scene::SetEnvironmentFadeDuration(float seconds) noexcept
+{
+	environments->SetFadeDuration(seconds);
+}
+
+//==============================================================================
+
+Sky *Scene::AddSky() noexcept
+{
+	// the IBL follows the sun through Update(), no full rebake
+	delete sky;
 
-	PrepareEnvironmentMap();
-	CalculateIrradiance();
-	PrefilterEnvironmentMap();
-	PrecomputeBRDF();
+	sky = new Sky(quality);
+	return sky;
+}
+
+//==============================================================================
+
+void Scene::RemoveSky() noexcept
+{
+	delete sky;
+	sky = nullptr;
+}
+
+//==============================================================================
+
+ReflectionProbe *Scene::AddProbe(const glm::vec3 &position) noexcept
+{
+	delete probe;
+
+	probe = new ReflectionProbe(position, quality);
+	return probe;
+}
+
+//==============================================================================
+
+unsigned int Scene::AddLocalProbe(const glm::vec3 &position, LocalProbes::Shape shape, const glm::vec3 &extents, float blend, const Drawable *owner) noexcept
+{
+	return local_probes->Add(position, shape, extents, blend, owner);
+}
+
+//==============================================================================
+
+void Scene::BakeLocalProbes() noexcept
+{
+	// deferred until the environment they are lit by is complete
+	local_probes_pending = true;
+}
+
+//==============================================================================
+
+void Scene::SetMeshletCulling(bool enabled) noexcept
+{
+	meshlet_culling = enabled;
+}
+
+//==============================================================================
+
+void Scene::SetLevelThreshold(float pixels) noexcept
+{
+	level_threshold = pixels;
+}
+
+//==============================================================================
+
+IrradianceVolume *Scene::AddIrradianceVolume(const glm::vec3 &min, const glm::vec3 &max, const glm::ivec3 &resolution) noexcept
+{
+	delete volume;
+
+	volume = new IrradianceVolume(min, max, resolution);
+	return volume;
+}
+
+//==============================================================================
+
+void Scene::BakeIrradianceVolume() noexcept
+{
+	// deferred like the local probes, the integrator needs the environment's SH
+	volume_pending = volume != nullptr;
 }
 
 //==============================================================================
@@ -389,6 +1020,19 @@ Shader *Scene::GetShader(const std::string &name) const noexcept
 
 //==============================================================================
 
+Drawable *Scene::GetObject(const std::string &name) const noexcept
+{
+	const auto it = objects.find(name);
+	if (it != objects.end())
+	{
+		return it->second;
+	}
+
+	return nullptr;
+}
+
+//==============================================================================
+
 Material *Scene::GetMaterial(const std::string &name) const noexcept
 {
 	const auto it = materials.find(name);
@@ -417,12 +1061,26 @@ void Scene::SetMaterial(Material *material) const noexcept
 	auto metallic  = material->GetMetallic();
 	auto roughness = material->GetRoughness();
 	auto ao        = material->GetAO();
+	auto orm       = material->GetORM();
 
-	albedo    ->Bind(3);
-	normal    ->Bind(4);
-	metallic  ->Bind(5);
-	roughness ->Bind(6);
-	ao        ->Bind(7);
+	// the maps GetPBRVariant() left out are not sampled
+	albedo->Bind(3);
+
+	if (normal)
+	{
+		normal->Bind(4);
+	}
+
+	if (orm)
+	{
+		orm->Bind(5);
+	}
+	else
+	{
+		metallic  ->Bind(5);
+		roughness ->Bind(6);
+		ao        ->Bind(7);
+	}
 }
 
 //==============================================================================
@@ -448,41 +1106,367 @@ void Scene::ZoomCamera(float scroll) noexcept
 
 //==============================================================================
 
-void Scene::Render() const noexcept
+const glm::mat4 &Scene::GetCaptureView(unsigned int face) const noexcept
 {
-	glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
-	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+	return capture_views[face];
+}
 
-	const auto aspect = static_cast<float>(width) / static_cast<float>(height);
+//==============================================================================
 
-	const auto model      = glm::scale(glm::mat4(1.0f), glm::vec3(0.5, 0.5, 0.5));
-	const auto view       = camera->GetView();
-	const auto projection = camera->GetProjection(aspect);
+bool Scene::IsEnvironmentReady() const noexcept
+{
+	if (sky)
+	{
+		return sky->IsReady() && brdf_bands == BRDF_BANDS;
+	}
+
+	const auto environment = environments->GetCurrent();
+	return environment && environment->IsReady() && brdf_bands == BRDF_BANDS;
+}
 
-	auto pbr_shader = GetShader("pbr");
-	pbr_shader->Use();
-	pbr_shader->SetMat4("view", view);
-	pbr_shader->SetMat4("projection", projection);
-	pbr_shader->SetVec3("camera", camera->GetPosition());
+//==============================================================================
 
-	irradiance_map  ->Bind(0);
-	prefilter_map   ->Bind(1);
-	brdfLUT_texture ->Bind(2);
+glm::vec2 Scene::GetRoughnessRange() const noexcept
+{
+	if (objects.empty())
+	{
+		return glm::vec2(0.0f, 1.0f);
+	}
 
+	glm::vec2 range(1.0f, 0.0f);
 	for (auto object : objects)
 	{
-		auto obj = object.second;
+		const auto material = object.second->GetMaterial();
+		if (!material)
+		{
+			continue;
+		}
+
+		const auto roughness = material->GetRoughnessRange();
+		range.x = std::min(range.x, roughness.x);
+		range.y = std::max(range.y, roughness.y);
+	}
+
+	// none of the objects has a material yet
+	if (range.x > range.y)
+	{
+		return glm::vec2(0.0f, 1.0f);
+	}
+
+	return range;
+}
+
+//==============================================================================
+
+void Scene::ConvertEquirectangular(const Texture *source, Cubemap *target, unsigned int size) const noexcept
+{
+	auto rect2cubemap_shader = GetShader("rect2cubemap");
+	rect2cubemap_shader->Use();
+	rect2cubemap_shader->SetInt("rectangular_map", 0);
+	rect2cubemap_shader->SetVec4("tile", glm::vec4(0.0f));
+
+	source->Bind(0);
+
+	glViewport(0, 0, size, size);
+	glBindFramebuffer(GL_FRAMEBUFFER, FBO);
+	glFramebufferTexture(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, target->GetID(), 0);
+	glClear(GL_COLOR_BUFFER_BIT);
+
+	skybox->Draw();
+
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+//==============================================================================
+
+void Scene::ConvertEquirectangular(const Texture *source, const glm::vec2 &map_size, const glm::vec4 &tile, const glm::vec4 &bounds, Cubemap *target, unsigned int size) const noexcept
+{
+	// one tile of a map too large to upload at once; the tiles own disjoint
+	// texels, so the target is not cleared and every texel is written once
+	auto rect2cubemap_shader = GetShader("rect2cubemap");
+	rect2cubemap_shader->Use();
+	rect2cubemap_shader->SetInt("rectangular_map", 0);
+	rect2cubemap_shader->SetVec2("map_size", map_size);
+	rect2cubemap_shader->SetVec4("tile", tile);
+	rect2cubemap_shader->SetVec4("tile_bounds", bounds);
+
+	source->Bind(0);
+
+	glViewport(0, 0, size, size);
+	glBindFramebuffer(GL_FRAMEBUFFER, FBO);
+	glFramebufferTexture(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, target->GetID(), 0);
+
+	skybox->Draw();
+
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+//==============================================================================
+
+void Scene::RenderSky(const Sky *sky, Cubemap *target, unsigned int size) const noexcept
+{
+	auto sky_shader = GetShader("sky_capture");
+	sky_shader->Use();
+	sky_shader->SetBool("tonemap", false);
+	sky->Bind(sky_shader);
+
+	glViewport(0, 0, size, size);
+	glBindFramebuffer(GL_FRAMEBUFFER, FBO);
+	glFramebufferTexture(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, target->GetID(), 0);
+	glClear(GL_COLOR_BUFFER_BIT);
+
+	skybox->Draw();
+
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+//==============================================================================
+
+void Scene::CalculateIrradiance(const Cubemap *source, Cubemap *target, unsigned int size, float sample_delta) const noexcept
+{
+	auto irradiance_shader = GetShader("irradiance");
+	irradiance_shader->Use();
+	irradiance_shader->SetInt("environment_map", 0);
+	irradiance_shader->SetFloat("sample_delta", sample_delta > 0.0f ? sample_delta : quality.irradiance_delta);
+
+	source->Bind(0);
+
+	glViewport(0, 0, size, size);
+	glBindFramebuffer(GL_FRAMEBUFFER, FBO);
+	glFramebufferTexture(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, target->GetID(), 0);
+	glClear(GL_COLOR_BUFFER_BIT);
+
+	skybox->Draw();
+
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+//==============================================================================
+
+void Scene::CalculateIrradiance(const Cubemap *source, OctahedralMap *target, unsigned int size, float sample_delta) const noexcept
+{
+	// a single pass over the unfolded octahedron, no geometry shader
+	auto irradiance_shader = GetShader("irradiance_oct");
+	irradiance_shader->Use();
+	irradiance_shader->SetInt("environment_map", 0);
+	irradiance_shader->SetFloat("sample_delta", sample_delta > 0.0f ? sample_delta : quality.irradiance_delta);
+
+	source->Bind(0);
+
+	glViewport(0, 0, size, size);
+	glBindFramebuffer(GL_FRAMEBUFFER, FBO);
+	glFramebufferTexture(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, target->GetID(), 0);
+	glClear(GL_COLOR_BUFFER_BIT);
+
+	octahedron->Draw();
+
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+//==============================================================================
+
+void Scene::PrefilterEnvironmentMap(const Cubemap *source, unsigned int source_size, Cubemap *target, unsigned int size, unsigned int mip, unsigned int mip_levels, unsigned int sample_count) const noexcept
+{
+	auto prefilter_shader = GetShader("prefilter");
+	prefilter_shader->Use();
+	prefilter_shader->SetInt("environment_map", 0);
+	prefilter_shader->SetFloat("resolution", static_cast<float>(source_size));
+	prefilter_shader->SetInt("sample_count", sample_count ? sample_count : quality.sample_count);
+
+	source->Bind(0);
+
+	const auto mip_width  = static_cast<unsigned int>(size * pow(0.5, mip));
+	const auto mip_height = static_cast<unsigned int>(size * pow(0.5, mip));
+	glViewport(0, 0, mip_width, mip_height);
+
+	const auto roughness = static_cast<float>(mip) / static_cast<float>(mip_levels - 1);
+	prefilter_shader->SetFloat("roughness", roughness);
+
+	glBindFramebuffer(GL_FRAMEBUFFER, FBO);
+	glFramebufferTexture(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, target->GetID(), mip);
+	glClear(GL_COLOR_BUFFER_BIT);
+
+	skybox->Draw();
+
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+//==============================================================================
+
+void Scene::PrefilterEnvironmentMap(const Cubemap *source, unsigned int source_size, OctahedralMap *target, unsigned int size, unsigned int mip, unsigned int mip_levels, unsigned int sample_count) const noexcept
+{
+	auto prefilter_shader = GetShader("prefilter_oct");
+	prefilter_shader->Use();
+	prefilter_shader->SetInt("environment_map", 0);
+	prefilter_shader->SetFloat("resolution", static_cast<float>(source_size));
+	prefilter_shader->SetInt("sample_count", sample_count ? sample_count : quality.sample_count);
+
+	source->Bind(0);
+
+	glViewport(0, 0, size >> mip, size >> mip);
+
+	const auto roughness = static_cast<float>(mip) / static_cast<float>(mip_levels - 1);
+	prefilter_shader->SetFloat("roughness", roughness);
+
+	glBindFramebuffer(GL_FRAMEBUFFER, FBO);
+	glFramebufferTexture(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, target->GetID(), mip);
+	glClear(GL_COLOR_BUFFER_BIT);
+
+	octahedron->Draw();
+
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+//==============================================================================
+
+std::vector<Mesh*> Scene::GetClusteredMeshes() const noexcept
+{
+	std::vector<Mesh*> meshes;
+	for (auto object : objects)
+	{
+		const auto mesh = dynamic_cast<Mesh*>(object.second);
+		if (mesh && mesh->GetMeshletCount() > 0 && mesh->GetLevel() == 0)
+		{
+			meshes.push_back(mesh);
+		}
+	}
+	return meshes;
+}
+
+//==============================================================================
+
+void Scene::RenderObjects(const std::vector<const Drawable*> &objects, const glm::mat4 &view, const glm::mat4 &projection, const glm::vec3 &position,
+	const Cubemap *irradiance, const Cubemap *prefilter, bool tonemap) const noexcept
+{
+	// the Probes block is read by every IBL variant, bound even when empty
+	const auto use_local_probes = local_probes->IsReady();
+	local_probes->Bind(8, 9, 1);
+
+	// with nothing to light it, the ambient term is left out of the shader
+	const auto ibl = sky || environments->GetCurrent() || irradiance || prefilter || use_local_probes || (volume && volume->IsReady());
+	const auto environment_variant = ibl ? GetEnvironmentVariant(irradiance, prefilter) : 0;
+
+	// grouped by variant, so each program is set up once per view
+	std::vector<DrawItem> batch;
+	batch.reserve(objects.size());
+	for (auto object : objects)
+	{
+		// the instances SelectInstances() took off the quads
+		const auto impostor = dynamic_cast<const OctahedralImpostor*>(object);
+		if (impostor)
+		{
+			const auto source = impostor->GetSource();
+			const auto source_variant = GetPBRVariant(source, ibl, tonemap) | environment_variant;
+			for (const auto &model : impostor->GetSourceModels())
+			{
+				batch.push_back({ source_variant, source, model });
+			}
+
+			if (impostor->GetCount() == 0)
+			{
+				continue;
+			}
+		}
+
+		batch.push_back({ GetPBRVariant(object, ibl, tonemap) | environment_variant, object, object->GetModel() });
+	}
+	std::stable_sort(batch.begin(), batch.end(), CompareVariant);
+
+	const Shader *pbr_shader = nullptr;
+	for (size_t i = 0; i < batch.size(); i++)
+	{
+		const auto variant = batch[i].variant;
+		const auto obj     = batch[i].object;
+		const auto &model  = batch[i].model;
+
+		if (i == 0 || variant != batch[i - 1].variant)
+		{
+			pbr_shader = GetPBRShader(variant);
+			pbr_shader->Use();
+			pbr_shader->SetMat4("view", view);
+			pbr_shader->SetMat4("projection", projection);
+
+			if (variant & (PBR_LIGHT_COUNT | PBR_IBL | PBR_IMPOSTOR | PBR_OCT_IMPOSTOR))
+			{
+				pbr_shader->SetVec3("camera", position);
+			}
+
+			if (variant & PBR_IBL)
+			{
+				BindEnvironment(pbr_shader, irradiance, prefilter);
+			}
+		}
+
 		SetMaterial(obj->GetMaterial());
-		pbr_shader->SetMat4("model", obj->GetModel());
+		pbr_shader->SetMat4("model", model * obj->GetPositionDecode());
+
+		if (variant & PBR_IBL)
+		{
+			glm::ivec4 probe_indices(0);
+			const auto bounds = Drawable::GetBoundingSphere(model, obj->GetRadius());
+			const auto probe_count = use_local_probes ? local_probes->Select(bounds, probe_indices) : 0;
+			pbr_shader->SetInt("probe_count", probe_count);
+			pbr_shader->SetIVec4("probe_indices", probe_indices);
+		}
+
 		obj->Draw();
 	}
+}
+
+//==============================================================================
+
+void Scene::RenderView(const glm::mat4 &view, const glm::mat4 &projection, const glm::vec3 &position,
+	const Cubemap *irradiance, const Cubemap *prefilter, bool tonemap, const Drawable *exclude) const noexcept
+{
+	std::vector<const Drawable*> drawables;
+	drawables.reserve(objects.size());
+	for (auto object : objects)
+	{
+		if (object.second != exclude)
+		{
+			drawables.push_back(object.second);
+		}
+	}
+
+	RenderObjects(drawables, view, projection, position, irradiance, prefilter, tonemap);
+
+	if (sky)
+	{
+		auto sky_shader = GetShader("sky");
+		sky_shader->Use();
+		sky_shader->SetMat4("view", view);
+		sky_shader->SetMat4("projection", projection);
+		sky_shader->SetBool("tonemap", tonemap);
+		sky->Bind(sky_shader);
+
+		glDepthFunc(GL_LEQUAL);
+		skybox->Draw();
+		glDepthFunc(GL_LESS);
+		return;
+	}
+
+	const auto environment = environments->GetCurrent();
+	const auto env_map = environment ? environment->GetEnvironmentMap() : nullptr;
+	if (!env_map)
+	{
+		return;
+	}
 
 	auto background_shader = GetShader("background");
 	background_shader->Use();
 	background_shader->SetMat4("view", view);
 	background_shader->SetMat4("projection", projection);
+	background_shader->SetBool("tonemap", tonemap);
+
+	env_map->Bind(0);
 
-	env_cubemap->Bind(0);
+	const auto outgoing = environments->GetPrevious();
+	const auto fading = outgoing && outgoing->GetEnvironmentMap();
+	background_shader->SetFloat("fade", fading ? environments->GetFade() : 0.0f);
+	if (fading)
+	{
+		outgoing->GetEnvironmentMap()->Bind(1);
+	}
 
 	glDepthFunc(GL_LEQUAL);
 	skybox->Draw();
@@ -490,3 +1474,104 @@ void Scene::Render() const noexcept
 }
 
 //==============================================================================
+
+void Scene::Update() noexcept
+{
+	// the bakes wait for their programs rather than block on a link the
+	// driver is still running on its own threads
+	if (!AreShadersReady())
+	{
+		glViewport(0, 0, width, height);
+		return;
+	}
+
+	// one bake step of each kind per frame keeps the frame time flat
+	environments->Update(*this);
+
+	if (sky)
+	{
+		sky->Update(*this);
+	}
+
+	if (brdf_bands < BRDF_BANDS)
+	{
+		PrecomputeBRDF(brdf_bands++);
+	}
+
+	if (local_probes_pending && IsEnvironmentReady())
+	{
+		local_probes->Bake(*this);
+		local_probes_pending = false;
+	}
+
+	if (volume_pending && IsEnvironmentReady())
+	{
+		StartVolumeBake();
+		volume_pending = false;
+	}
+
+	if (volume)
+	{
+		volume->Update();
+	}
+
+	if (probe)
+	{
+		probe->Update(*this);
+	}
+
+	glViewport(0, 0, width, height);
+}
+
+//==============================================================================
+
+void Scene::Render() const noexcept
+{
+	glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+	const auto aspect = static_cast<float>(width) / static_cast<float>(height);
+
+	const auto view       = camera->GetView();
+	const auto projection = camera->GetProjection(aspect);
+
+	const auto pixel_scale = projection[1][1] * 0.5f * static_cast<float>(height);
+	for (auto object : objects)
+	{
+		object.second->SelectLevel(camera->GetPosition(), pixel_scale, level_threshold);
+
+		const auto impostor = dynamic_cast<OctahedralImpostor*>(object.second);
+		if (impostor)
+		{
+			impostor->SelectInstances(camera->GetPosition(), pixel_scale, level_threshold);
+		}
+	}
+
+	const auto probe_ready = probe && probe->IsReady();
+	const auto irradiance  = probe_ready ? probe->GetIrradianceMap() : nullptr;
+	const auto prefilter   = probe_ready ? probe->GetPrefilterMap()  : nullptr;
+
+	// only the camera view culls meshlets, the captures draw the meshes whole
+	const auto meshes = meshlet_culling ? GetClusteredMeshes() : std::vector<Mesh*>();
+	if (meshes.empty())
+	{
+		RenderView(view, projection, camera->GetPosition(), irradiance, prefilter);
+		return;
+	}
+
+	const auto cull_shader = GetShader("cull");
+	culler->Cull(cull_shader, meshes, view, projection, ClusterCuller::Pass::EARLY);
+
+	RenderView(view, projection, camera->GetPosition(), irradiance, prefilter);
+
+	// what the early pass hid may have come into view since the last frame
+	culler->BuildDepthPyramid(GetShader("depth_pyramid"), width, height);
+	culler->Cull(cull_shader, meshes, view, projection, ClusterCuller::Pass::LATE);
+
+	const std::vector<const Drawable*> late(meshes.begin(), meshes.end());
+	RenderObjects(late, view, projection, camera->GetPosition(), irradiance, prefilter, true);
+
+	ClusterCuller::Reset(meshes);
+}
+
+//==============================================================================
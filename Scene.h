@@ -3,49 +3,96 @@
 
 //==============================================================================
 
+#include <cstddef>
 #include <map>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include <glm/glm.hpp>
 
 #include "Camera.h"
+#include "IBLQuality.h"
+#include "LocalProbes.h"
 
 //==============================================================================
 
+class AssetPack;
 class Camera;
+class ClusterCuller;
 class Cubemap;
 class Drawable;
+class EnvironmentManager;
+class IrradianceVolume;
 class Light;
 class Material;
+class Mesh;
+class Octahedron;
+class OctahedralImpostor;
+class OctahedralMap;
 class Shader;
+class ShaderCache;
 class Skybox;
+class Sky;
 class Sphere;
 class Quad;
+class ReflectionProbe;
 class Texture;
 
 //==============================================================================
 
 class Scene
 {
+private:
+	// one draw of RenderObjects(); an impostor's source is drawn once for each
+	// instance it stands in for, with that instance's model
+	struct DrawItem
+	{
+		unsigned int variant;
+		const Drawable *object;
+		glm::mat4 model;
+	};
+
 private:
 	unsigned int width;
 	unsigned int height;
 	Camera *camera;
 
 	unsigned int FBO;
-	unsigned int RBO;
+	unsigned int capture_UBO;
 
 	glm::mat4 capture_projection;
 	glm::mat4 capture_views[6];
 
-	std::string cubemap;
+	static const unsigned int BRDF_BANDS = 4;
+
+	// lights past the first MAX_LIGHTS are not shaded
+	static const unsigned int MAX_LIGHTS = 16;
+
+	// pbr.fs variant key: the light count in the low byte, then one bit per #define
+	static const unsigned int PBR_LIGHT_COUNT = 0xFF;
+	static const unsigned int PBR_NORMAL_MAP  = 1 << 8;
+	static const unsigned int PBR_ORM_MAP     = 1 << 9;
+	static const unsigned int PBR_IBL         = 1 << 10;
+	static const unsigned int PBR_TONEMAP     = 1 << 11;
+	static const unsigned int PBR_IMPOSTOR    = 1 << 12;
+	static const unsigned int PBR_OCT_IMPOSTOR = 1 << 13;
+
+	// the global (and outgoing) maps are octahedral and take the units of the
+	// cubemaps, so an IBL variant stays within the 16 texture units of GL 4.3
+	static const unsigned int PBR_OCTAHEDRAL      = 1 << 14;
+	static const unsigned int PBR_FADE_OCTAHEDRAL = 1 << 15;
 
-	Texture *hdr_texture;	
-	Cubemap *env_cubemap;
-	Cubemap *irradiance_map;
-	Cubemap *prefilter_map;
+	IBLQuality quality;
+
+	// cooked assets, preferred over the source files when present
+	AssetPack *pack;
+	ShaderCache *shader_cache;
+
+	EnvironmentManager *environments;
+	Sky *sky;
 	Texture *brdfLUT_texture;
+	unsigned int brdf_bands;
 
 	std::map<std::string, Shader*> shaders;
 	std::map<std::string, Texture*> textures;
@@ -53,14 +100,67 @@ private:
 	std::map<std::string, Light*> lights;
 	std::map<std::string, Drawable*> objects;
 
+	// pbr.fs variants by key, each compiled the first time an object needs it;
+	// the impostor variants pair it with impostor.vs or octahedral_impostor.vs
+	std::string pbr_vcode;
+	std::string pbr_fcode;
+	std::string impostor_vcode;
+	std::string oct_impostor_vcode;
+	mutable std::map<unsigned int, Shader*> pbr_shaders;
+
 	Skybox *skybox;
 	Quad   *quad;
+	Octahedron *octahedron;
+
+	ReflectionProbe *probe;
+	LocalProbes     *local_probes;
+	bool local_probes_pending;
+
+	IrradianceVolume *volume;
+	bool volume_pending;
+
+	ClusterCuller *culler;
+	bool meshlet_culling;
+
+	// how far in pixels a level of detail may stray from the finest one
+	float level_threshold;
 
 private:
-	void PrepareEnvironmentMap();
-	void CalculateIrradiance();
-	void PrefilterEnvironmentMap();
-	void PrecomputeBRDF();
+	void PrecomputeBRDF(unsigned int band) noexcept;
+
+	void StartVolumeBake() noexcept;
+
+	// false while the driver still links one of the named programs
+	bool AreShadersReady() const noexcept;
+
+	// everything AddModel() added under name, the meshes before the materials
+	// and textures they point at
+	void RemoveModel(const std::string &name) noexcept;
+	static bool IsModelPart(const std::string &key, const std::string &prefix) noexcept;
+
+	void BindEnvironment(const Shader *pbr_shader, const Cubemap *irradiance, const Cubemap *prefilter) const noexcept;
+
+	// cooked sources only when the pack has every stage, the loose files otherwise
+	bool ReadShader(const std::string &vpath, const std::string &gpath, const std::string &fpath,
+		std::string &vcode, std::string &gcode, std::string &fcode) const noexcept;
+	bool ReadShader(const std::string &path, std::string &code) const noexcept;
+
+	// the objects ClusterCuller works on, the meshes that have meshlets and
+	// draw their finest level
+	std::vector<Mesh*> GetClusteredMeshes() const noexcept;
+
+	// the objects of RenderView() without the background
+	void RenderObjects(const std::vector<const Drawable*> &objects, const glm::mat4 &view, const glm::mat4 &projection, const glm::vec3 &position,
+		const Cubemap *irradiance, const Cubemap *prefilter, bool tonemap) const noexcept;
+
+	// the cheapest variant that shades the object's material with the current lights
+	unsigned int GetPBRVariant(const Drawable *object, bool ibl, bool tonemap) const noexcept;
+	// the bits BindEnvironment() needs for the same maps
+	unsigned int GetEnvironmentVariant(const Cubemap *irradiance, const Cubemap *prefilter) const noexcept;
+	Shader *GetPBRShader(unsigned int variant) const noexcept;
+	void SetLights(const Shader *pbr_shader, unsigned int count) const noexcept;
+
+	static bool CompareVariant(const DrawItem &a, const DrawItem &b) noexcept;
 
 public:
 	Scene(unsigned int width, unsigned int height)  noexcept;
@@ -69,14 +169,54 @@ public:
 	void SetSize(unsigned int width, unsigned int height) noexcept;
 
 	Shader   *AddShader   (const std::string &name, const std::string &vpath, const std::string &fpath) noexcept;
+	Shader   *AddShader   (const std::string &name, const std::string &vpath, const std::string &gpath, const std::string &fpath) noexcept;
+	Shader   *AddComputeShader(const std::string &name, const std::string &cpath) noexcept;
 	Texture  *AddTexture  (const std::string &name, const std::string &path)                            noexcept;
 	Material *AddMaterial (const std::string &name)                                                     noexcept;
 	Light    *AddLight    (const std::string &name, const glm::vec3 &position, const glm::vec3 &color)  noexcept;
 	Drawable *AddObject   (const std::string &name, Drawable *object)                                   noexcept;
 
-	void AddCubemap(const std::string &name) noexcept;
+	// a binary glTF file, see GltfLoader; its textures, materials and meshes are
+	// added as name/texture0, name/material0 and name/mesh0 and so on, replacing
+	// all of a model loaded under the same name before; returns the number of meshes
+	size_t AddModel(const std::string &name, const std::string &path, const glm::mat4 &transform = glm::mat4(1.0f), bool optimize = false) noexcept;
+
+	// instances of the object named source, each a quad blending views baked
+	// now, see OctahedralImpostor; xyz the position, w the scale; the source
+	// leaves the scene's objects and is drawn by the impostor for the instances
+	// close to the camera
+	OctahedralImpostor *AddImpostor(const std::string &name, const std::string &source, const std::vector<glm::vec4> &instances, unsigned int frame_size = 128) noexcept;
+
+	void SetQuality(const IBLQuality &quality) noexcept;
+	const IBLQuality &GetQuality() const noexcept;
+
+	void AddCubemap(const std::string &name)  noexcept;
+	void LoadCubemap(const std::string &name) noexcept;
+
+	void SetEnvironmentBudget(size_t bytes)        noexcept;
+	void SetEnvironmentFadeDuration(float seconds) noexcept;
+
+	Sky *AddSky()    noexcept;
+	void RemoveSky() noexcept;
+
+	ReflectionProbe *AddProbe(const glm::vec3 &position) noexcept;
+
+	unsigned int AddLocalProbe(const glm::vec3 &position, LocalProbes::Shape shape, const glm::vec3 &extents, float blend, const Drawable *owner = nullptr) noexcept;
+	void BakeLocalProbes() noexcept;
+
+	// GPU culling of the meshlets of large meshes in the camera view, see
+	// ClusterCuller; on by default
+	void SetMeshletCulling(bool enabled) noexcept;
+
+	// every object picks its level of detail for the camera view each frame;
+	// the captures use the same levels; 0 keeps the finest
+	void SetLevelThreshold(float pixels) noexcept;
+
+	IrradianceVolume *AddIrradianceVolume(const glm::vec3 &min, const glm::vec3 &max, const glm::ivec3 &resolution) noexcept;
+	void BakeIrradianceVolume() noexcept;
 
 	Shader *GetShader     (const std::string &name) const noexcept;
+	Drawable *GetObject   (const std::string &name) const noexcept;
 	Material *GetMaterial (const std::string &name) const noexcept;
 	void SetMaterial      (const std::string &name) const noexcept;
 	void SetMaterial      (Material *material)      const noexcept;
@@ -85,6 +225,28 @@ public:
 	void RotateCamera(float dx, float dy)                  noexcept;
 	void ZoomCamera(float scroll)                          noexcept;
 
+	bool IsEnvironmentReady() const noexcept;
+
+	glm::vec2 GetRoughnessRange() const noexcept;
+
+	const glm::mat4 &GetCaptureView(unsigned int face) const noexcept;
+
+	void ConvertEquirectangular  (const Texture *source, Cubemap *target, unsigned int size) const noexcept;
+	void ConvertEquirectangular  (const Texture *source, const glm::vec2 &map_size, const glm::vec4 &tile, const glm::vec4 &bounds, Cubemap *target, unsigned int size) const noexcept;
+	void RenderSky               (const Sky *sky, Cubemap *target, unsigned int size)       const noexcept;
+	// a sample_delta or sample_count of 0 takes the scene's quality; an
+	// environment or probe passes its own, it may have been set up with another
+	void CalculateIrradiance     (const Cubemap *source, Cubemap *target, unsigned int size, float sample_delta = 0.0f) const noexcept;
+	void CalculateIrradiance     (const Cubemap *source, OctahedralMap *target, unsigned int size, float sample_delta = 0.0f) const noexcept;
+	void PrefilterEnvironmentMap (const Cubemap *source, unsigned int source_size, Cubemap *target, unsigned int size, unsigned int mip, unsigned int mip_levels, unsigned int sample_count = 0) const noexcept;
+	void PrefilterEnvironmentMap (const Cubemap *source, unsigned int source_size, OctahedralMap *target, unsigned int size, unsigned int mip, unsigned int mip_levels, unsigned int sample_count = 0) const noexcept;
+
+	// linear HDR output without tonemap, e.g. for a later post processing pass;
+	// exclude is left out, e.g. the object a probe capture is taken inside of
+	void RenderView(const glm::mat4 &view, const glm::mat4 &projection, const glm::vec3 &position,
+		const Cubemap *irradiance = nullptr, const Cubemap *prefilter = nullptr, bool tonemap = true, const Drawable *exclude = nullptr) const noexcept;
+
+	void Update() noexcept;
 	void Render() const noexcept;
 };
 
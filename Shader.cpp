@@ -1,13 +1,28 @@
 
 #include "Shader.h"
 
+#include "ShaderCache.h"
+
+#include <algorithm>
+#include <cstring>
 #include <iostream>
 #include <fstream>
-#include <sstream>
 
 //==============================================================================
 
-void Shader::CheckError(unsigned int shader, const std::string &type) const noexcept
+// from GL_KHR_parallel_shader_compile, which has the same values as the ARB extension
+#ifndef GL_MAX_SHADER_COMPILER_THREADS_KHR
+#define GL_MAX_SHADER_COMPILER_THREADS_KHR 0x91B0
+#define GL_COMPLETION_STATUS_KHR           0x91B1
+#endif
+
+//==============================================================================
+
+bool Shader::parallel_compile = false;
+
+//==============================================================================
+
+bool Shader::CheckError(unsigned int shader, const std::string &type) const noexcept
 {
 	int success;
 	char info[1024];
@@ -30,12 +45,16 @@ void Shader::CheckError(unsigned int shader, const std::string &type) const noex
 			std::cout << "error: program linking: " << info << std::endl;
 		}
 	}
+
+	return success != 0;
 }
 
 //==============================================================================
 
 int Shader::GetLocation(const std::string &name) const noexcept
 {
+	Resolve();
+
 	const auto location = glGetUniformLocation(program, name.c_str());
 	if (location < 0)
 	{
@@ -46,14 +65,162 @@ int Shader::GetLocation(const std::string &name) const noexcept
 
 //==============================================================================
 
+void Shader::Resolve() const noexcept
+{
+	if (!pending)
+	{
+		return;
+	}
+
+	pending = false;
+
+	int success;
+	glGetProgramiv(program, GL_LINK_STATUS, &success);
+
+	if (success)
+	{
+		if (cache)
+		{
+			cache->Store(key, program);
+		}
+	}
+	else
+	{
+		// the stage logs tell more than the link log
+		CheckError(stages[0], compute ? "compute" : "vertex");
+		if (stages[1])
+		{
+			CheckError(stages[1], "geometry");
+		}
+		if (stages[2])
+		{
+			CheckError(stages[2], "fragment");
+		}
+		CheckError(program, "program");
+	}
+
+	for (auto &stage : stages)
+	{
+		glDeleteShader(stage);
+		stage = 0;
+	}
+}
+
+//==============================================================================
+
+void Shader::EnableParallelCompile(GLADloadproc load) noexcept
+{
+	int count = 0;
+	glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+
+	for (int i = 0; i < count && !parallel_compile; i++)
+	{
+		const auto name = reinterpret_cast<const char *>(glGetStringi(GL_EXTENSIONS, i));
+		parallel_compile = std::strcmp(name, "GL_KHR_parallel_shader_compile") == 0 || std::strcmp(name, "GL_ARB_parallel_shader_compile") == 0;
+	}
+
+	if (!parallel_compile)
+	{
+		return;
+	}
+
+	// as many threads as the driver likes
+	typedef void (APIENTRYP MaxShaderCompilerThreads)(GLuint count);
+
+	auto max_threads = reinterpret_cast<MaxShaderCompilerThreads>(load("glMaxShaderCompilerThreadsKHR"));
+	if (!max_threads)
+	{
+		max_threads = reinterpret_cast<MaxShaderCompilerThreads>(load("glMaxShaderCompilerThreadsARB"));
+	}
+
+	if (max_threads)
+	{
+		max_threads(0xFFFFFFFF);
+	}
+}
+
+//==============================================================================
+
+bool Shader::Read(const std::string &path, std::string &code, unsigned int depth) noexcept
+{
+	if (depth > 16)
+	{
+		std::cout << "error: shader " << path << " is included recursively" << std::endl;
+		return false;
+	}
+
+	std::ifstream file(path);
+	if (!file)
+	{
+		std::cout << "error: shader file " << path << " is not found" << std::endl;
+		return false;
+	}
+
+	// the same expansion as AssetCooker::Preprocess, so cooked and loose sources match
+	const auto directory = path.substr(0, path.find_last_of("\\/") + 1);
+
+	std::string line;
+	while (std::getline(file, line))
+	{
+		const auto start = line.find_first_not_of(" \t");
+		if (start != std::string::npos && line.compare(start, 8, "#include") == 0)
+		{
+			const auto open  = line.find('"', start);
+			const auto close = open == std::string::npos ? open : line.find('"', open + 1);
+			if (close == std::string::npos)
+			{
+				std::cout << "error: shader " << path << " has a malformed #include" << std::endl;
+				return false;
+			}
+
+			auto include = directory + line.substr(open + 1, close - open - 1);
+			std::replace(include.begin(), include.end(), '/', '\\');
+
+			if (!Read(include, code, depth + 1))
+			{
+				return false;
+			}
+			continue;
+		}
+
+		code += line;
+		code += '\n';
+	}
+
+	return true;
+}
+
+//==============================================================================
+
+std::string Shader::AddDefines(const std::string &code, const std::string &defines) noexcept
+{
+	// #version has to stay the first statement
+	const auto version = code.find("#version");
+	const auto end = version == std::string::npos ? version : code.find('\n', version);
+	if (end == std::string::npos)
+	{
+		return defines + code;
+	}
+
+	return code.substr(0, end + 1) + defines + code.substr(end + 1);
+}
+
+//==============================================================================
+
 Shader::Shader() noexcept :
-	program(0)
+	program(0),
+	stages{ 0, 0, 0 },
+	pending(false),
+	compute(false),
+	cache(nullptr),
+	key(0)
 {
 }
 
 //==============================================================================
 
-Shader::Shader(const std::string &vpath, const std::string &fpath) noexcept
+Shader::Shader(const std::string &vpath, const std::string &fpath) noexcept :
+	Shader()
 {
 	Load(vpath, fpath);
 }
@@ -62,77 +229,174 @@ Shader::Shader(const std::string &vpath, const std::string &fpath) noexcept
 
 Shader::~Shader() noexcept
 {
+	for (auto stage : stages)
+	{
+		glDeleteShader(stage);
+	}
+
 	glDeleteProgram(program);
 }
 
 //==============================================================================
 
-void Shader::Init(const std::string &vcode, const std::string &fcode) noexcept
+void Shader::Init(const std::string &vcode, const std::string &fcode, ShaderCache *cache) noexcept
+{
+	Init(vcode, std::string(), fcode, cache);
+}
+
+//==============================================================================
+
+void Shader::Init(const std::string &vcode, const std::string &gcode, const std::string &fcode, ShaderCache *cache) noexcept
 {
+	program = glCreateProgram();
+
+	this->cache = cache;
+	key = cache ? cache->GetKey(vcode, gcode, fcode) : 0;
+
+	if (cache && cache->Load(key, program))
+	{
+		return;
+	}
+
 	const auto vs = vcode.c_str();
+	const auto gs = gcode.c_str();
 	const auto fs = fcode.c_str();
 
-	auto vertex = glCreateShader(GL_VERTEX_SHADER);
-	glShaderSource(vertex, 1, &vs, nullptr);
-	glCompileShader(vertex);
-	CheckError(vertex, "vertex");
+	// nothing is queried here, so the driver can work on several programs at once
+	stages[0] = glCreateShader(GL_VERTEX_SHADER);
+	glShaderSource(stages[0], 1, &vs, nullptr);
+	glCompileShader(stages[0]);
 
-	auto fragment = glCreateShader(GL_FRAGMENT_SHADER);
-	glShaderSource(fragment, 1, &fs, nullptr);
-	glCompileShader(fragment);
-	CheckError(vertex, "fragment");
+	if (!gcode.empty())
+	{
+		stages[1] = glCreateShader(GL_GEOMETRY_SHADER);
+		glShaderSource(stages[1], 1, &gs, nullptr);
+		glCompileShader(stages[1]);
+	}
+
+	stages[2] = glCreateShader(GL_FRAGMENT_SHADER);
+	glShaderSource(stages[2], 1, &fs, nullptr);
+	glCompileShader(stages[2]);
+
+	for (auto stage : stages)
+	{
+		if (stage)
+		{
+			glAttachShader(program, stage);
+		}
+	}
+
+	if (cache)
+	{
+		glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+	}
 
-	program = glCreateProgram();
-	glAttachShader(program, vertex);
-	glAttachShader(program, fragment);
 	glLinkProgram(program);
-	CheckError(program, "program");
+	pending = true;
+}
 
-	glDeleteShader(vertex);
-	glDeleteShader(fragment);
+//==============================================================================
+
+void Shader::Load(const std::string &vpath, const std::string &fpath, ShaderCache *cache) noexcept
+{
+	Load(vpath, std::string(), fpath, cache);
 }
 
 //==============================================================================
 
-void Shader::Load(const std::string &vpath, const std::string &fpath) noexcept
+void Shader::Load(const std::string &vpath, const std::string &gpath, const std::string &fpath, ShaderCache *cache) noexcept
 {
 	std::string vcode;
+	std::string gcode;
 	std::string fcode;
 
-	try
+	if (Read(vpath, vcode) && (gpath.empty() || Read(gpath, gcode)) && Read(fpath, fcode))
 	{
-		std::ifstream vsfile(vpath);
-		std::ifstream fsfile(fpath);
+		Init(vcode, gcode, fcode, cache);
+	}
+}
 
-		vsfile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-		fsfile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
+//==============================================================================
 
-		std::stringstream vstream;
-		std::stringstream fstream;
+void Shader::InitCompute(const std::string &ccode, ShaderCache *cache) noexcept
+{
+	program = glCreateProgram();
+	compute = true;
 
-		vstream << vsfile.rdbuf();
-		fstream << fsfile.rdbuf();
+	this->cache = cache;
+	key = cache ? cache->GetKey(ccode, std::string(), std::string()) : 0;
 
-		const auto vcode = vstream.str();
-		const auto fcode = fstream.str();
+	if (cache && cache->Load(key, program))
+	{
+		return;
+	}
+
+	const auto cs = ccode.c_str();
+
+	stages[0] = glCreateShader(GL_COMPUTE_SHADER);
+	glShaderSource(stages[0], 1, &cs, nullptr);
+	glCompileShader(stages[0]);
+	glAttachShader(program, stages[0]);
 
-		Init(vcode, fcode);
+	if (cache)
+	{
+		glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
 	}
-	catch (const std::ifstream::failure &)
+
+	glLinkProgram(program);
+	pending = true;
+}
+
+//==============================================================================
+
+void Shader::LoadCompute(const std::string &cpath, ShaderCache *cache) noexcept
+{
+	std::string ccode;
+	if (Read(cpath, ccode))
 	{
-		std::cout << "error: shader file is not found" << std::endl;
+		InitCompute(ccode, cache);
 	}
 }
 
 //==============================================================================
 
+bool Shader::IsReady() const noexcept
+{
+	if (!pending || !parallel_compile)
+	{
+		return true;
+	}
+
+	int done;
+	glGetProgramiv(program, GL_COMPLETION_STATUS_KHR, &done);
+	return done != 0;
+}
+
+//==============================================================================
+
 void Shader::Use() const noexcept
 {
+	Resolve();
 	glUseProgram(program);
 }
 
 //==============================================================================
 
+void Shader::SetUniformBlock(const std::string &name, unsigned int binding) const noexcept
+{
+	Resolve();
+
+	const auto index = glGetUniformBlockIndex(program, name.c_str());
+	if (index == GL_INVALID_INDEX)
+	{
+		std::cout << "error: " << name << " uniform block index" << std::endl;
+		return;
+	}
+	glUniformBlockBinding(program, index, binding);
+}
+
+//==============================================================================
+
 void Shader::SetBool(const std::string &name, bool value) const noexcept
 {
 	glUniform1i(GetLocation(name), static_cast<int>(value));
@@ -196,6 +460,20 @@ void Shader::SetVec4(const std::string &name, const glm::vec4 &value) const noex
 
 //==============================================================================
 
+void Shader::SetIVec3(const std::string &name, const glm::ivec3 &value) const noexcept
+{
+	glUniform3iv(GetLocation(name), 1, &value[0]);
+}
+
+//==============================================================================
+
+void Shader::SetIVec4(const std::string &name, const glm::ivec4 &value) const noexcept
+{
+	glUniform4iv(GetLocation(name), 1, &value[0]);
+}
+
+//==============================================================================
+
 void Shader::SetMat2(const std::string& name, const glm::mat2& value) const noexcept
 {
 	glUniformMatrix2fv(GetLocation(name), 1, GL_FALSE, &value[0][0]);
@@ -3,6 +3,7 @@
 
 //==============================================================================
 
+#include <cstdint>
 #include <string>
 
 #include <glm/glm.hpp>
@@ -10,25 +11,66 @@
 
 //==============================================================================
 
+class ShaderCache;
+
+//==============================================================================
+
 class Shader
 {
 private:
+	// GL_KHR_parallel_shader_compile or the ARB variant, see EnableParallelCompile
+	static bool parallel_compile;
+
 	unsigned int program;
 
+	// the stages of a link that has been submitted but not checked yet
+	mutable unsigned int stages[3];
+	mutable bool pending;
+	bool compute;
+	ShaderCache *cache;
+	uint64_t key;
+
 private:
-	void CheckError(unsigned int shader, const std::string &type) const noexcept;
+	bool CheckError(unsigned int shader, const std::string &type) const noexcept;
 	int GetLocation(const std::string &name) const noexcept;
 
+	// blocks only if the driver has not finished the link yet
+	void Resolve() const noexcept;
+
+public:
+	// lets the driver compile on its own threads; GLAD does not load the extension
+	static void EnableParallelCompile(GLADloadproc load) noexcept;
+
+	// the source with every #include "file" expanded, relative to the including file
+	static bool Read(const std::string &path, std::string &code, unsigned int depth = 0) noexcept;
+
+	// variant switches go right after the #version line, e.g. "#define IBL\n"
+	static std::string AddDefines(const std::string &code, const std::string &defines) noexcept;
+
 public:
 	Shader()  noexcept;
 	Shader(const std::string &vpath, const std::string &fpath) noexcept;
 	~Shader() noexcept;
 
-	void Init (const std::string &vcode, const std::string &fcode) noexcept;
-	void Load (const std::string &vpath, const std::string &fpath) noexcept;
+	// compiling and linking are only submitted, errors are reported on first use;
+	// with a cache the linked program is reused across runs
+	void Init (const std::string &vcode, const std::string &fcode, ShaderCache *cache = nullptr) noexcept;
+	void Init (const std::string &vcode, const std::string &gcode, const std::string &fcode, ShaderCache *cache = nullptr) noexcept;
+	void Load (const std::string &vpath, const std::string &fpath, ShaderCache *cache = nullptr) noexcept;
+	void Load (const std::string &vpath, const std::string &gpath, const std::string &fpath, ShaderCache *cache = nullptr) noexcept;
+
+	// a compute program, submitted the same way
+	void InitCompute (const std::string &ccode, ShaderCache *cache = nullptr) noexcept;
+	void LoadCompute (const std::string &cpath, ShaderCache *cache = nullptr) noexcept;
+
+	// false while the driver still links in the background; without the
+	// extension there is nothing to ask, so it is always true
+	bool IsReady() const noexcept;
 
 	void Use() const noexcept;
 
+	void SetUniformBlock(const std::string &name, unsigned int binding) const noexcept;
+
 	void SetBool  (const std::string &name, bool  value) const noexcept;
 	void SetInt   (const std::string &name, int   value) const noexcept;
 	void SetFloat (const std::string &name, float value) const noexcept;
@@ -41,6 +83,9 @@ public:
 	void SetVec3  (const std::string &name, const glm::vec3 &value) const noexcept;
 	void SetVec4  (const std::string &name, const glm::vec4 &value) const noexcept;
 
+	void SetIVec3 (const std::string &name, const glm::ivec3 &value) const noexcept;
+	void SetIVec4 (const std::string &name, const glm::ivec4 &value) const noexcept;
+
 	void SetMat2  (const std::string &name, const glm::mat2 &value) const noexcept;
 	void SetMat3  (const std::string &name, const glm::mat3 &value) const noexcept;
 	void SetMat4  (const std::string &name, const glm::mat4 &value) const noexcept;
@@ -0,0 +1,169 @@
+
+#include "ShaderCache.h"
+
+#include <cstdio>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/stat.h>
+#endif
+
+#include "GLAD/glad.h"
+
+//==============================================================================
+
+uint64_t ShaderCache::Hash(const std::string &text, uint64_t hash) noexcept
+{
+	// 64 bit FNV-1a, the terminator keeps "ab" + "c" apart from "a" + "bc"
+	for (size_t i = 0; i <= text.size(); i++)
+	{
+		hash = (hash ^ static_cast<unsigned char>(text.c_str()[i])) * 1099511628211ull;
+	}
+
+	return hash;
+}
+
+//==============================================================================
+
+std::string ShaderCache::GetPath(uint64_t key) const noexcept
+{
+	char name[32];
+	std::snprintf(name, sizeof(name), "%016llx.bin", static_cast<unsigned long long>(key));
+
+	return directory + "\\" + name;
+}
+
+//==============================================================================
+
+ShaderCache::ShaderCache(const std::string &directory) noexcept :
+	directory(directory)
+{
+	int count = 0;
+	glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &count);
+	if (count > 0)
+	{
+		formats.resize(count);
+		glGetIntegerv(GL_PROGRAM_BINARY_FORMATS, formats.data());
+	}
+
+	// binaries are only valid for the driver that made them
+	for (auto name : { GL_VENDOR, GL_RENDERER, GL_VERSION })
+	{
+		const auto text = reinterpret_cast<const char *>(glGetString(name));
+		driver += text ? text : "";
+		driver += '\n';
+	}
+
+	if (IsSupported())
+	{
+#ifdef _WIN32
+		CreateDirectoryA(directory.c_str(), nullptr);
+#else
+		mkdir(directory.c_str(), 0755);
+#endif
+	}
+}
+
+//==============================================================================
+
+bool ShaderCache::IsSupported() const noexcept
+{
+	return !formats.empty();
+}
+
+//==============================================================================
+
+uint64_t ShaderCache::GetKey(const std::string &vcode, const std::string &gcode, const std::string &fcode) const noexcept
+{
+	auto key = Hash(driver, 14695981039346656037ull);
+	key = Hash(vcode, key);
+	key = Hash(gcode, key);
+	key = Hash(fcode, key);
+	return key;
+}
+
+//==============================================================================
+
+bool ShaderCache::Load(uint64_t key, unsigned int program) const noexcept
+{
+	if (!IsSupported())
+	{
+		return false;
+	}
+
+	std::ifstream file(GetPath(key), std::ios::binary);
+	if (!file)
+	{
+		return false;
+	}
+
+	Header header;
+	file.read(reinterpret_cast<char *>(&header), sizeof(header));
+
+	// an unknown format would only raise a GL error
+	const auto valid = file && std::memcmp(header.magic, "PGMB", 4) == 0 &&
+		std::find(formats.begin(), formats.end(), static_cast<int>(header.format)) != formats.end();
+
+	std::vector<char> binary(valid ? header.length : 0);
+	file.read(binary.data(), binary.size());
+
+	if (!file || binary.empty())
+	{
+		return false;
+	}
+
+	glProgramBinary(program, header.format, binary.data(), static_cast<int>(binary.size()));
+
+	int success;
+	glGetProgramiv(program, GL_LINK_STATUS, &success);
+	if (!success)
+	{
+		// stale, e.g. the driver changed its format without a version bump
+		file.close();
+		std::remove(GetPath(key).c_str());
+		return false;
+	}
+
+	return true;
+}
+
+//==============================================================================
+
+void ShaderCache::Store(uint64_t key, unsigned int program) const noexcept
+{
+	if (!IsSupported())
+	{
+		return;
+	}
+
+	int length = 0;
+	glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+	if (length <= 0)
+	{
+		return;
+	}
+
+	std::vector<char> binary(length);
+
+	Header header = { { 'P', 'G', 'M', 'B' }, 0, 0, 0 };
+	glGetProgramBinary(program, length, &length, &header.format, binary.data());
+	header.length = static_cast<uint32_t>(length);
+
+	std::ofstream file(GetPath(key), std::ios::binary | std::ios::trunc);
+	file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+	file.write(binary.data(), length);
+
+	if (!file)
+	{
+		std::cout << "error: shader cache " << GetPath(key) << " cannot be written" << std::endl;
+	}
+}
+
+//==============================================================================
@@ -0,0 +1,48 @@
+
+#pragma once
+
+//==============================================================================
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//==============================================================================
+
+// linked program binaries on disk, one file per program; the key covers the
+// sources and the driver, so a driver update or an edited shader only misses
+class ShaderCache
+{
+private:
+	struct Header
+	{
+		char magic[4];
+		uint32_t format;
+		uint32_t length;
+		uint32_t reserved;
+	};
+
+	std::string directory;
+	std::string driver;
+	std::vector<int> formats;
+
+private:
+	static uint64_t Hash(const std::string &text, uint64_t hash) noexcept;
+
+	std::string GetPath(uint64_t key) const noexcept;
+
+public:
+	ShaderCache(const std::string &directory) noexcept;
+
+	bool IsSupported() const noexcept;
+
+	// the complete sources, i.e. with any defines already prepended
+	uint64_t GetKey(const std::string &vcode, const std::string &gcode, const std::string &fcode) const noexcept;
+
+	// false when there is no binary or the driver rejects it; the program is
+	// left unlinked then and can be compiled from source as usual
+	bool Load (uint64_t key, unsigned int program) const noexcept;
+	void Store(uint64_t key, unsigned int program) const noexcept;
+};
+
+//==============================================================================
@@ -0,0 +1,278 @@
+
+#include "Sky.h"
+
+#include "Cubemap.h"
+#include "Environment.h"
+#include "Scene.h"
+#include "Shader.h"
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+
+//==============================================================================
+
+void Sky::UpdateModel() noexcept
+{
+	const auto PI = 3.14159265359f;
+
+	// the model is only defined for a sun above the horizon
+	const auto theta_s = std::min(std::acos(glm::clamp(sun_direction.y, -1.0f, 1.0f)), 0.5f * PI - 0.01f);
+	const auto T = turbidity;
+
+	perez[0] = glm::vec3( 0.1787f * T - 1.4630f, -0.0193f * T - 0.2592f, -0.0167f * T - 0.2608f);
+	perez[1] = glm::vec3(-0.3554f * T + 0.4275f, -0.0665f * T + 0.0008f, -0.0950f * T + 0.0092f);
+	perez[2] = glm::vec3(-0.0227f * T + 5.3251f, -0.0004f * T + 0.2125f, -0.0079f * T + 0.2102f);
+	perez[3] = glm::vec3( 0.1206f * T - 2.5771f, -0.0641f * T - 0.8989f, -0.0441f * T - 1.6537f);
+	perez[4] = glm::vec3(-0.0670f * T + 0.3703f, -0.0033f * T + 0.0452f, -0.0109f * T + 0.0529f);
+
+	const auto chi = (4.0f / 9.0f - T / 120.0f) * (PI - 2.0f * theta_s);
+
+	const auto t1 = theta_s;
+	const auto t2 = t1 * theta_s;
+	const auto t3 = t2 * theta_s;
+
+	const auto Y = (4.0453f * T - 4.9710f) * std::tan(chi) - 0.2155f * T + 2.4192f;
+
+	const auto x =
+		T * T * ( 0.00166f * t3 - 0.00375f * t2 + 0.00209f * t1) +
+		T     * (-0.02903f * t3 + 0.06377f * t2 - 0.03202f * t1 + 0.00394f) +
+		        ( 0.11693f * t3 - 0.21196f * t2 + 0.06052f * t1 + 0.25886f);
+
+	const auto y =
+		T * T * ( 0.00275f * t3 - 0.00610f * t2 + 0.00317f * t1) +
+		T     * (-0.04214f * t3 + 0.08970f * t2 - 0.04153f * t1 + 0.00516f) +
+		        ( 0.15346f * t3 - 0.26756f * t2 + 0.06670f * t1 + 0.26688f);
+
+	// divided by the zenith's own Perez term so that Evaluate() is one ratio
+	zenith = glm::vec3(Y, x, y) / Perez(1.0f, theta_s);
+}
+
+//==============================================================================
+
+void Sky::ProjectSH() noexcept
+{
+	const auto PI = 3.14159265359f;
+	const auto golden_angle = PI * (3.0f - std::sqrt(5.0f));
+
+	for (unsigned int i = 0; i < 9; i++)
+	{
+		sh[i] = glm::vec3(0.0f);
+		radiance_sh[i] = glm::vec3(0.0f);
+	}
+
+	// evenly spread Fibonacci directions, each covering the same solid angle
+	const auto solid_angle = 4.0f * PI / SH_SAMPLES;
+
+	for (unsigned int i = 0; i < SH_SAMPLES; i++)
+	{
+		const auto y = 1.0f - 2.0f * (static_cast<float>(i) + 0.5f) / SH_SAMPLES;
+		const auto r = std::sqrt(1.0f - y * y);
+		const auto phi = golden_angle * i;
+
+		const glm::vec3 dir(r * std::cos(phi), y, r * std::sin(phi));
+		Environment::AddSH(radiance_sh, dir, Evaluate(dir) * solid_angle);
+	}
+
+	std::copy(radiance_sh, radiance_sh + 9, sh);
+	Environment::ConvolveSH(sh);
+}
+
+//==============================================================================
+
+glm::vec3 Sky::Perez(float cos_theta, float gamma) const noexcept
+{
+	const auto cos_gamma = std::cos(gamma);
+
+	glm::vec3 result;
+	for (int i = 0; i < 3; i++)
+	{
+		result[i] =
+			(1.0f + perez[0][i] * std::exp(perez[1][i] / cos_theta)) *
+			(1.0f + perez[2][i] * std::exp(perez[3][i] * gamma) + perez[4][i] * cos_gamma * cos_gamma);
+	}
+
+	return result;
+}
+
+//==============================================================================
+
+glm::vec3 Sky::Evaluate(const glm::vec3 &dir) const noexcept
+{
+	// same as sky.fs
+	const auto cos_theta = std::max(dir.y, 0.001f);
+	const auto gamma = std::acos(glm::clamp(glm::dot(dir, sun_direction), -1.0f, 1.0f));
+
+	const auto Yxy = zenith * Perez(cos_theta, gamma);
+	const auto X = Yxy.y * Yxy.x / Yxy.z;
+	const auto Z = (1.0f - Yxy.y - Yxy.z) * Yxy.x / Yxy.z;
+
+	const glm::vec3 rgb(
+		 3.2406f * X - 1.5372f * Yxy.x - 0.4986f * Z,
+		-0.9689f * X + 1.8758f * Yxy.x + 0.0415f * Z,
+		 0.0557f * X - 0.2040f * Yxy.x + 1.0570f * Z);
+
+	const auto ground = dir.y < 0.0f ? 0.3f : 1.0f;
+	return glm::max(rgb, glm::vec3(0.0f)) * intensity * ground;
+}
+
+//==============================================================================
+
+Sky::Sky(const IBLQuality &quality) noexcept :
+	sun_direction(glm::normalize(glm::vec3(0.5f, 0.5f, -0.5f))),
+	turbidity(2.5f),
+	intensity(0.1f),
+	quality(quality),
+	step(0),
+	dirty(true),
+	ready(false),
+	sky_cubemap(nullptr),
+	prefilter_map(nullptr)
+{
+	for (unsigned int i = 0; i < 9; i++)
+	{
+		sh[i] = glm::vec3(0.0f);
+		radiance_sh[i] = glm::vec3(0.0f);
+	}
+
+	const auto format = GetRenderableFormat(quality.format);
+
+	sky_cubemap = new Cubemap(SIZE, SIZE, true, format);
+	sky_cubemap->GenerateMipmap();
+
+	prefilter_map = new Cubemap(SIZE, 0, quality.prefilter_mips - 1, format);
+
+	UpdateModel();
+}
+
+//==============================================================================
+
+Sky::~Sky() noexcept
+{
+	delete sky_cubemap;
+	delete prefilter_map;
+}
+
+//==============================================================================
+
+void Sky::SetSunDirection(const glm::vec3 &direction) noexcept
+{
+	sun_direction = glm::normalize(direction);
+	UpdateModel();
+	dirty = true;
+}
+
+//==============================================================================
+
+void Sky::SetTurbidity(float turbidity) noexcept
+{
+	this->turbidity = turbidity;
+	UpdateModel();
+	dirty = true;
+}
+
+//==============================================================================
+
+void Sky::SetIntensity(float intensity) noexcept
+{
+	this->intensity = intensity;
+	dirty = true;
+}
+
+//==============================================================================
+
+const glm::vec3 &Sky::GetSunDirection() const noexcept
+{
+	return sun_direction;
+}
+
+//==============================================================================
+
+bool Sky::IsReady() const noexcept
+{
+	return ready;
+}
+
+//==============================================================================
+
+const glm::vec3 *Sky::GetSH() const noexcept
+{
+	return sh;
+}
+
+//==============================================================================
+
+const glm::vec3 *Sky::GetRadianceSH() const noexcept
+{
+	return radiance_sh;
+}
+
+//==============================================================================
+
+const Cubemap *Sky::GetEnvironmentMap() const noexcept
+{
+	return sky_cubemap;
+}
+
+//==============================================================================
+
+const Cubemap *Sky::GetPrefilterMap() const noexcept
+{
+	return ready ? prefilter_map : nullptr;
+}
+
+//==============================================================================
+
+unsigned int Sky::GetSize() const noexcept
+{
+	return SIZE;
+}
+
+//==============================================================================
+
+void Sky::Bind(const Shader *shader) const noexcept
+{
+	// the model is evaluated per pixel, uniforms only
+	shader->SetVec3("sun_direction", sun_direction);
+	shader->SetVec3("zenith", zenith);
+	shader->SetFloat("intensity", intensity);
+
+	for (unsigned int i = 0; i < 5; i++)
+	{
+		shader->SetVec3("perez[" + std::to_string(i) + "]", perez[i]);
+	}
+}
+
+//==============================================================================
+
+void Sky::Update(const Scene &scene) noexcept
+{
+	// a refresh cycle: sky cubemap and SH, then one prefilter mip per frame
+	if (step == 0)
+	{
+		if (!dirty)
+		{
+			return;
+		}
+
+		dirty = false;
+
+		ProjectSH();
+
+		scene.RenderSky(this, sky_cubemap, SIZE);
+		sky_cubemap->GenerateMipmap();
+	}
+	else
+	{
+		const auto mip = step - 1;
+		scene.PrefilterEnvironmentMap(sky_cubemap, SIZE, prefilter_map, SIZE, mip, quality.prefilter_mips, PREFILTER_SAMPLES);
+	}
+
+	if (++step > quality.prefilter_mips)
+	{
+		step  = 0;
+		ready = true;
+	}
+}
+
+//==============================================================================
@@ -0,0 +1,78 @@
+
+#pragma once
+
+//==============================================================================
+
+#include <glm/glm.hpp>
+
+#include "IBLQuality.h"
+
+//==============================================================================
+
+class Cubemap;
+class Scene;
+class Shader;
+
+//==============================================================================
+
+// Preetham analytic daylight, an alternative to an .hdr environment
+class Sky
+{
+private:
+	static const unsigned int SIZE = 64;
+	static const unsigned int SH_SAMPLES = 256;
+	static const unsigned int PREFILTER_SAMPLES = 64;
+
+	glm::vec3 sun_direction;
+	float turbidity;
+	float intensity;
+
+	// Perez coefficients A-E and the normalized zenith value, per Yxy channel
+	glm::vec3 perez[5];
+	glm::vec3 zenith;
+
+	glm::vec3 sh[9];
+	glm::vec3 radiance_sh[9];
+
+	IBLQuality quality;
+
+	unsigned int step;
+	bool dirty;
+	bool ready;
+
+	Cubemap *sky_cubemap;
+	Cubemap *prefilter_map;
+
+private:
+	void UpdateModel() noexcept;
+	void ProjectSH()   noexcept;
+
+	glm::vec3 Perez(float cos_theta, float gamma) const noexcept;
+	glm::vec3 Evaluate(const glm::vec3 &dir)      const noexcept;
+
+public:
+	Sky(const IBLQuality &quality) noexcept;
+	~Sky() noexcept;
+
+	void SetSunDirection(const glm::vec3 &direction) noexcept;
+	void SetTurbidity(float turbidity)               noexcept;
+	void SetIntensity(float intensity)               noexcept;
+
+	const glm::vec3 &GetSunDirection() const noexcept;
+
+	bool IsReady() const noexcept;
+
+	const glm::vec3 *GetSH()         const noexcept;
+	const glm::vec3 *GetRadianceSH() const noexcept;
+
+	const Cubemap *GetEnvironmentMap() const noexcept;
+	const Cubemap *GetPrefilterMap()   const noexcept;
+
+	unsigned int GetSize() const noexcept;
+
+	void Bind(const Shader *shader) const noexcept;
+
+	void Update(const Scene &scene) noexcept;
+};
+
+//==============================================================================
@@ -1,74 +1,62 @@
 
 #include "Skybox.h"
 
+#include <vector>
+
 #include "GLAD/glad.h"
 
 //==============================================================================
 
 Skybox::Skybox() noexcept
 {
-    float vertices[] =
-    {
-        //  x      y      z      nx     ny     nz      tx    ty
-        // back face
-        -1.0f, -1.0f, -1.0f,   0.0f,  0.0f, -1.0f,   0.0f, 0.0f,  // bottom-left
-         1.0f,  1.0f, -1.0f,   0.0f,  0.0f, -1.0f,   1.0f, 1.0f,  // top-right
-         1.0f, -1.0f, -1.0f,   0.0f,  0.0f, -1.0f,   1.0f, 0.0f,  // bottom-right         
-         1.0f,  1.0f, -1.0f,   0.0f,  0.0f, -1.0f,   1.0f, 1.0f,  // top-right
-        -1.0f, -1.0f, -1.0f,   0.0f,  0.0f, -1.0f,   0.0f, 0.0f,  // bottom-left
-        -1.0f,  1.0f, -1.0f,   0.0f,  0.0f, -1.0f,   0.0f, 1.0f,  // top-left
-        // front face
-        -1.0f, -1.0f,  1.0f,   0.0f,  0.0f,  1.0f,   0.0f, 0.0f,  // bottom-left
-         1.0f, -1.0f,  1.0f,   0.0f,  0.0f,  1.0f,   1.0f, 0.0f,  // bottom-right
-         1.0f,  1.0f,  1.0f,   0.0f,  0.0f,  1.0f,   1.0f, 1.0f,  // top-right
-         1.0f,  1.0f,  1.0f,   0.0f,  0.0f,  1.0f,   1.0f, 1.0f,  // top-right
-        -1.0f,  1.0f,  1.0f,   0.0f,  0.0f,  1.0f,   0.0f, 1.0f,  // top-left
-        -1.0f, -1.0f,  1.0f,   0.0f,  0.0f,  1.0f,   0.0f, 0.0f,  // bottom-left
-        // left face
-        -1.0f,  1.0f,  1.0f,  -1.0f,  0.0f,  0.0f,   1.0f, 0.0f,  // top-right
-        -1.0f,  1.0f, -1.0f,  -1.0f,  0.0f,  0.0f,   1.0f, 1.0f,  // top-left
-        -1.0f, -1.0f, -1.0f,  -1.0f,  0.0f,  0.0f,   0.0f, 1.0f,  // bottom-left
-        -1.0f, -1.0f, -1.0f,  -1.0f,  0.0f,  0.0f,   0.0f, 1.0f,  // bottom-left
-        -1.0f, -1.0f,  1.0f,  -1.0f,  0.0f,  0.0f,   0.0f, 0.0f,  // bottom-right
-        -1.0f,  1.0f,  1.0f,  -1.0f,  0.0f,  0.0f,   1.0f, 0.0f,  // top-right
-        // right face
-         1.0f,  1.0f,  1.0f,   1.0f,  0.0f,  0.0f,   1.0f, 0.0f,  // top-left
-         1.0f, -1.0f, -1.0f,   1.0f,  0.0f,  0.0f,   0.0f, 1.0f,  // bottom-right
-         1.0f,  1.0f, -1.0f,   1.0f,  0.0f,  0.0f,   1.0f, 1.0f,  // top-right         
-         1.0f, -1.0f, -1.0f,   1.0f,  0.0f,  0.0f,   0.0f, 1.0f,  // bottom-right
-         1.0f,  1.0f,  1.0f,   1.0f,  0.0f,  0.0f,   1.0f, 0.0f,  // top-left
-         1.0f, -1.0f,  1.0f,   1.0f,  0.0f,  0.0f,   0.0f, 0.0f,  // bottom-left     
-         // bottom face
-        -1.0f, -1.0f, -1.0f,   0.0f, -1.0f,  0.0f,   0.0f, 1.0f,  // top-right
-         1.0f, -1.0f, -1.0f,   0.0f, -1.0f,  0.0f,   1.0f, 1.0f,  // top-left
-         1.0f, -1.0f,  1.0f,   0.0f, -1.0f,  0.0f,   1.0f, 0.0f,  // bottom-left
-         1.0f, -1.0f,  1.0f,   0.0f, -1.0f,  0.0f,   1.0f, 0.0f,  // bottom-left
-        -1.0f, -1.0f,  1.0f,   0.0f, -1.0f,  0.0f,   0.0f, 0.0f,  // bottom-right
-        -1.0f, -1.0f, -1.0f,   0.0f, -1.0f,  0.0f,   0.0f, 1.0f,  // top-right
-        // top face
-        -1.0f,  1.0f, -1.0f,   0.0f,  1.0f,  0.0f,   0.0f, 1.0f,  // top-left
-         1.0f,  1.0f , 1.0f,   0.0f,  1.0f,  0.0f,   1.0f, 0.0f,  // bottom-right
-         1.0f,  1.0f, -1.0f,   0.0f,  1.0f,  0.0f,   1.0f, 1.0f,  // top-right     
-         1.0f,  1.0f,  1.0f,   0.0f,  1.0f,  0.0f,   1.0f, 0.0f,  // bottom-right
-        -1.0f,  1.0f, -1.0f,   0.0f,  1.0f,  0.0f,   0.0f, 1.0f,  // top-left
-        -1.0f,  1.0f,  1.0f,   0.0f,  1.0f,  0.0f,   0.0f, 0.0f   // bottom-left
-    };
-	
-	glBindVertexArray(VAO);
-	glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), &vertices[0], GL_STATIC_DRAW);
-
-    const auto stride = static_cast<unsigned int>((3 + 3 + 2) * sizeof(float));
+	// background.vs and cubemap.vs only read positions, 8 bytes a vertex
+	const std::vector<glm::vec3> positions =
+	{
+		// back face
+		{ -1.0f, -1.0f, -1.0f },  // bottom-left
+		{  1.0f,  1.0f, -1.0f },  // top-right
+		{  1.0f, -1.0f, -1.0f },  // bottom-right
+		{  1.0f,  1.0f, -1.0f },  // top-right
+		{ -1.0f, -1.0f, -1.0f },  // bottom-left
+		{ -1.0f,  1.0f, -1.0f },  // top-left
+		// front face
+		{ -1.0f, -1.0f,  1.0f },  // bottom-left
+		{  1.0f, -1.0f,  1.0f },  // bottom-right
+		{  1.0f,  1.0f,  1.0f },  // top-right
+		{  1.0f,  1.0f,  1.0f },  // top-right
+		{ -1.0f,  1.0f,  1.0f },  // top-left
+		{ -1.0f, -1.0f,  1.0f },  // bottom-left
+		// left face
+		{ -1.0f,  1.0f,  1.0f },  // top-right
+		{ -1.0f,  1.0f, -1.0f },  // top-left
+		{ -1.0f, -1.0f, -1.0f },  // bottom-left
+		{ -1.0f, -1.0f, -1.0f },  // bottom-left
+		{ -1.0f, -1.0f,  1.0f },  // bottom-right
+		{ -1.0f,  1.0f,  1.0f },  // top-right
+		// right face
+		{  1.0f,  1.0f,  1.0f },  // top-left
+		{  1.0f, -1.0f, -1.0f },  // bottom-right
+		{  1.0f,  1.0f, -1.0f },  // top-right
+		{  1.0f, -1.0f, -1.0f },  // bottom-right
+		{  1.0f,  1.0f,  1.0f },  // top-left
+		{  1.0f, -1.0f,  1.0f },  // bottom-left
+		// bottom face
+		{ -1.0f, -1.0f, -1.0f },  // top-right
+		{  1.0f, -1.0f, -1.0f },  // top-left
+		{  1.0f, -1.0f,  1.0f },  // bottom-left
+		{  1.0f, -1.0f,  1.0f },  // bottom-left
+		{ -1.0f, -1.0f,  1.0f },  // bottom-right
+		{ -1.0f, -1.0f, -1.0f },  // top-right
+		// top face
+		{ -1.0f,  1.0f, -1.0f },  // top-left
+		{  1.0f,  1.0f,  1.0f },  // bottom-right
+		{  1.0f,  1.0f, -1.0f },  // top-right
+		{  1.0f,  1.0f,  1.0f },  // bottom-right
+		{ -1.0f,  1.0f, -1.0f },  // top-left
+		{ -1.0f,  1.0f,  1.0f }   // bottom-left
+	};
 
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (void*)0);
-    glEnableVertexAttribArray(1);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, stride, (void*)(3 * sizeof(float)));
-    glEnableVertexAttribArray(2);
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, stride, (void*)(6 * sizeof(float)));
-
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
+	SetVertices(positions, {}, {}, {}, VertexFormat::Position::SNORM16);
 }
 
 //==============================================================================
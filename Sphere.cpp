@@ -1,6 +1,8 @@
 
 #include "Sphere.h"
 
+#include "MeshOptimizer.h"
+
 #include <cmath>
 #include <vector>
 
@@ -10,17 +12,15 @@
 
 //==============================================================================
 
-Sphere::Sphere() noexcept :
-	EBO(0),
-	indices_count(0)
+Sphere::Sphere(unsigned int segments, bool optimize) noexcept
 {
 	std::vector<glm::vec3> positions;
 	std::vector<glm::vec2> uvs;
 	std::vector<glm::vec3> normals;
-	std::vector<unsigned int> indices;
+	std::vector<glm::vec4> tangents;
 
-	const unsigned int i_segments = 64;
-	const unsigned int j_segments = 64;
+	const auto i_segments = segments;
+	const auto j_segments = segments;
 	const auto PI = 3.14159265359f;
 
 	for (unsigned int i = 0; i <= i_segments; ++i)
@@ -37,80 +37,93 @@ Sphere::Sphere() noexcept :
 			positions.emplace_back(x, y, z);
 			uvs.emplace_back(tx, ty);
 			normals.emplace_back(x, y, z);
+
+			// along the parallel, v runs from the north pole down, so the
+			// bitangent of the image's up is -cross(normal, tangent)
+			tangents.emplace_back(-sin(tx * 2.0f * PI), 0.0f, cos(tx * 2.0f * PI), -1.0f);
 		}
 	}
 
-	auto even_row = true;
+	// the widest quad of a level spans 2 pi step / segments around the
+	// equator, its chord is that far inside the unit sphere
+	std::vector<std::vector<unsigned int>> levels;
+	std::vector<float> errors;
+	for (unsigned int step = 1; levels.size() < MAX_LEVELS && (step == 1 || segments / step >= MIN_SEGMENTS); step *= 2)
+	{
+		std::vector<unsigned int> lines;
+		for (unsigned int i = 0; i < segments; i += step)
+		{
+			lines.push_back(i);
+		}
+		lines.push_back(segments);
+
+		levels.push_back(GetStrip(lines, segments));
+		errors.push_back(step == 1 ? 0.0f : 1.0f - cos(step * PI / segments));
+	}
 
-	for (unsigned int j = 0; j < j_segments; ++j)
+	auto mode = GL_TRIANGLE_STRIP;
+	if (optimize)
 	{
-		if (even_row)
+		for (auto &level_indices : levels)
 		{
-			for (unsigned int i = 0; i <= i_segments; ++i)
-			{
-				indices.emplace_back(j * (i_segments + 1) + i);
-				indices.emplace_back((j + 1) * (i_segments + 1) + i);
-			}
+			level_indices = MeshOptimizer::StripToList(level_indices);
 		}
-		else
+
+		// the coarser levels follow the finest one's vertex order
+		const auto remap = MeshOptimizer::Optimize(levels[0], positions, normals, uvs);
+		MeshOptimizer::Remap(tangents, remap);
+		for (size_t i = 1; i < levels.size(); i++)
 		{
-			for (int i = i_segments; i >= 0; --i)
+			for (auto &index : levels[i])
 			{
-				indices.emplace_back((j + 1) * (i_segments + 1) + i);
-				indices.emplace_back(j * (i_segments + 1) + i);
+				index = remap[index];
 			}
+			MeshOptimizer::OptimizeVertexCache(levels[i], positions.size());
 		}
-		even_row = !even_row;
+		mode = GL_TRIANGLES;
 	}
 
-	indices_count = static_cast<unsigned int>(indices.size());
+	// 20 bytes a vertex instead of 48
+	SetVertices(positions, normals, uvs, tangents, VertexFormat::Position::SNORM16);
+	SetLevels(levels, errors, mode, positions.size());
+}
+
+//==============================================================================
 
-	std::vector<float> data;
-	for (unsigned int i = 0; i < positions.size(); ++i)
+std::vector<unsigned int> Sphere::GetStrip(const std::vector<unsigned int> &lines, unsigned int segments) noexcept
+{
+	std::vector<unsigned int> indices;
+
+	auto even_row = true;
+
+	for (size_t j = 0; j + 1 < lines.size(); ++j)
 	{
-		data.emplace_back(positions[i].x);
-		data.emplace_back(positions[i].y);
-		data.emplace_back(positions[i].z);
-		if (!normals.empty())
+		if (even_row)
 		{
-			data.emplace_back(normals[i].x);
-			data.emplace_back(normals[i].y);
-			data.emplace_back(normals[i].z);
+			for (size_t i = 0; i < lines.size(); ++i)
+			{
+				indices.emplace_back(lines[j] * (segments + 1) + lines[i]);
+				indices.emplace_back(lines[j + 1] * (segments + 1) + lines[i]);
+			}
 		}
-		if (!uvs.empty())
+		else
 		{
-			data.emplace_back(uvs[i].x);
-			data.emplace_back(uvs[i].y);
+			for (auto i = lines.size(); i-- > 0;)
+			{
+				indices.emplace_back(lines[j + 1] * (segments + 1) + lines[i]);
+				indices.emplace_back(lines[j] * (segments + 1) + lines[i]);
+			}
 		}
+		even_row = !even_row;
 	}
 
-	glGenBuffers(1, &EBO);
-
-	glBindVertexArray(VAO);
-	glBindBuffer(GL_ARRAY_BUFFER, VBO);
-	glBufferData(GL_ARRAY_BUFFER, data.size() * sizeof(float), &data[0], GL_STATIC_DRAW);
-
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), &indices[0], GL_STATIC_DRAW);
-
-	const auto stride = static_cast<unsigned int>((3 + 3 + 2) * sizeof(float));
-
-	glEnableVertexAttribArray(0);
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (void*)0);
-	glEnableVertexAttribArray(1);
-	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, stride, (void*)(3 * sizeof(float)));
-	glEnableVertexAttribArray(2);
-	glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, stride, (void*)(6 * sizeof(float)));
-
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
-	glBindVertexArray(0);
+	return indices;
 }
 
 //==============================================================================
 
 Sphere::~Sphere() noexcept
 {
-	glDeleteBuffers(1, &EBO);
 }
 
 //==============================================================================
@@ -120,9 +133,7 @@ void Sphere::Draw() const noexcept
 	glEnable(GL_CULL_FACE);
 	glCullFace(GL_BACK);
 
-	glBindVertexArray(VAO);
-	glDrawElements(GL_TRIANGLE_STRIP, indices_count, GL_UNSIGNED_INT, 0);
-	glBindVertexArray(0);
+	DrawElements();
 
 	glDisable(GL_CULL_FACE);
 }
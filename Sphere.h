@@ -3,6 +3,8 @@
 
 //==============================================================================
 
+#include <vector>
+
 #include "Drawable.h"
 
 //==============================================================================
@@ -10,11 +12,20 @@
 class Sphere : public Drawable
 {
 private:
-	unsigned EBO;
-	unsigned int indices_count;
+	// the coarsest level, 32 triangles
+	static const unsigned int MIN_SEGMENTS = 4;
+
+private:
+	// the rows between consecutive lines of the grid, each row back and forth
+	static std::vector<unsigned int> GetStrip(const std::vector<unsigned int> &lines, unsigned int segments) noexcept;
 
 public:
-	Sphere()  noexcept;
+	// a unit sphere of segments x segments quads; without optimize it is one
+	// triangle strip in generation order, e.g. as a benchmark baseline
+	//
+	// the coarser levels of detail halve the segments down to MIN_SEGMENTS, on
+	// every other line of the same vertices
+	Sphere(unsigned int segments = 64, bool optimize = true) noexcept;
 	~Sphere() noexcept;
 	
 	void Draw() const noexcept override;
@@ -0,0 +1,71 @@
+
+#include "SphereImpostors.h"
+
+#include <algorithm>
+
+#include "GLAD/glad.h"
+
+//==============================================================================
+
+SphereImpostors::SphereImpostors(const std::vector<glm::vec4> &spheres) noexcept :
+	count(0)
+{
+	SetSpheres(spheres);
+}
+
+//==============================================================================
+
+SphereImpostors::~SphereImpostors() noexcept
+{
+}
+
+//==============================================================================
+
+void SphereImpostors::SetSpheres(const std::vector<glm::vec4> &spheres) noexcept
+{
+	count = static_cast<unsigned int>(spheres.size());
+
+	glBindVertexArray(VAO);
+	glBindBuffer(GL_ARRAY_BUFFER, VBO);
+	glBufferData(GL_ARRAY_BUFFER, spheres.size() * sizeof(glm::vec4), spheres.data(), GL_DYNAMIC_DRAW);
+
+	// one sphere per instance in place of the position, the corners come from gl_VertexID
+	glEnableVertexAttribArray(VertexFormat::POSITION);
+	glVertexAttribPointer(VertexFormat::POSITION, 4, GL_FLOAT, GL_FALSE, sizeof(glm::vec4), (void*)0);
+	glVertexAttribDivisor(VertexFormat::POSITION, 1);
+
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glBindVertexArray(0);
+
+	vertex_memory = spheres.size() * sizeof(glm::vec4);
+
+	// around the model origin, like the bounds of the meshes
+	radius = 0.0f;
+	for (const auto &sphere : spheres)
+	{
+		radius = std::max(radius, glm::length(glm::vec3(sphere)) + sphere.w);
+	}
+}
+
+//==============================================================================
+
+unsigned int SphereImpostors::GetCount() const noexcept
+{
+	return count;
+}
+
+//==============================================================================
+
+void SphereImpostors::Draw() const noexcept
+{
+	if (count == 0)
+	{
+		return;
+	}
+
+	glBindVertexArray(VAO);
+	glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, count);
+	glBindVertexArray(0);
+}
+
+//==============================================================================
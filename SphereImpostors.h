@@ -0,0 +1,38 @@
+
+#pragma once
+
+//==============================================================================
+
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "Drawable.h"
+
+//==============================================================================
+
+// many spheres of one material as a single instanced draw: each instance is a
+// quad facing the camera that impostor.vs fits around the sphere's outline, and
+// pbr.fs (IMPOSTOR) intersects the view ray with the exact sphere, so a sphere
+// costs four vertices and 16 bytes instead of a tessellated mesh
+//
+// the shading, depth and texture coordinates match a Sphere of the same center
+// and radius; a sphere the camera is inside of is not drawn
+class SphereImpostors : public Drawable
+{
+private:
+	unsigned int count;
+
+public:
+	// xyz the center, w the radius, both before the model
+	SphereImpostors(const std::vector<glm::vec4> &spheres) noexcept;
+	~SphereImpostors() noexcept;
+
+	// replaces every sphere, e.g. once per frame for moving particles
+	void SetSpheres(const std::vector<glm::vec4> &spheres) noexcept;
+	unsigned int GetCount() const noexcept;
+
+	void Draw() const noexcept override;
+};
+
+//==============================================================================
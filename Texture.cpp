@@ -1,6 +1,9 @@
 
 #include "Texture.h"
 
+#include "HDRImage.h"
+
+#include <algorithm>
 #include <iostream>
 
 #define STB_IMAGE_IMPLEMENTATION
@@ -34,6 +37,22 @@ void Texture::Init(const unsigned char *data) noexcept
 
 	glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
 
+	// value range of the first channel, e.g. for roughness maps, and the mean color
+	const auto pixels = static_cast<size_t>(width) * height;
+
+	auto low  = data[0];
+	auto high = data[0];
+	glm::dvec3 sum(0.0);
+	for (size_t i = 0; i < pixels; i++)
+	{
+		const auto texel = &data[i * components];
+		low  = std::min(low,  texel[0]);
+		high = std::max(high, texel[0]);
+		sum += components < 3 ? glm::dvec3(texel[0]) : glm::dvec3(texel[0], texel[1], texel[2]);
+	}
+	range   = glm::vec2(low, high) / 255.0f;
+	average = glm::vec3(sum / (255.0 * pixels));
+
 	SetParameters();
 
 	glGenerateMipmap(GL_TEXTURE_2D);
@@ -43,11 +62,15 @@ void Texture::Init(const unsigned char *data) noexcept
 
 //==============================================================================
 
-void Texture::Init(const float *data) noexcept
+void Texture::Init(const unsigned short *data, HDRFormat format, int row_length) noexcept
 {
 	glBindTexture(GL_TEXTURE_2D, texture);
 
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB16F, width, height, 0, GL_RGB, GL_FLOAT, data);
+	// half floats upload to RGB16F as is, the driver repacks them for the other formats
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	glPixelStorei(GL_UNPACK_ROW_LENGTH, row_length);
+	glTexImage2D(GL_TEXTURE_2D, 0, GetInternalFormat(format), width, height, 0, GL_RGB, GL_HALF_FLOAT, data);
+	glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
 
 	SetParametersHDR();
 
@@ -82,7 +105,9 @@ Texture::Texture() noexcept :
 	texture(0),
 	width(0),
 	height(0),
-	components(0)
+	components(0),
+	range(0.0f, 1.0f),
+	average(0.5f)
 {
 	glGenTextures(1, &texture);
 }
@@ -103,6 +128,20 @@ unsigned int Texture::GetID() const noexcept
 
 //==============================================================================
 
+const glm::vec2 &Texture::GetRange() const noexcept
+{
+	return range;
+}
+
+//==============================================================================
+
+const glm::vec3 &Texture::GetAverage() const noexcept
+{
+	return average;
+}
+
+//==============================================================================
+
 void Texture::Load(const std::string &path, bool flip) noexcept
 {
 	stbi_set_flip_vertically_on_load(flip);
@@ -119,18 +158,111 @@ void Texture::Load(const std::string &path, bool flip) noexcept
 
 //==============================================================================
 
-void Texture::LoadHDR(const std::string &path, bool flip) noexcept
+void Texture::Load(const unsigned char *data, int width, int height, int components) noexcept
 {
-	stbi_set_flip_vertically_on_load(flip);
-	const auto data = stbi_loadf(path.c_str(), &width, &height, &components, 0);
-	if (data)
+	this->width      = width;
+	this->height     = height;
+	this->components = components;
+
+	Init(data);
+}
+
+//==============================================================================
+
+void Texture::Load(const AssetPack::Entry &entry, const unsigned char *data) noexcept
+{
+	width  = static_cast<int>(entry.width);
+	height = static_cast<int>(entry.height);
+
+	// the cooker stores the statistics Init() would otherwise compute
+	range   = glm::vec2(entry.range[0], entry.range[1]);
+	average = glm::vec3(entry.average[0], entry.average[1], entry.average[2]);
+
+	glBindTexture(GL_TEXTURE_2D, texture);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+	if (entry.type == AssetPack::Type::HDR_TEXTURE)
 	{
-		Init(data);
-		stbi_image_free(data);
+		components = 3;
+		glTexImage2D(GL_TEXTURE_2D, 0, GetInternalFormat(HDRFormat::RGB16F), width, height, 0, GL_RGB, GL_HALF_FLOAT, data);
+
+		SetParametersHDR();
+		glBindTexture(GL_TEXTURE_2D, 0);
 		return;
 	}
 
-	std::cout << "error: texture " << path << " is not found" << std::endl;
+	unsigned int format{GL_RGB};
+	switch (entry.format)
+	{
+	case AssetPack::Format::R8:    format = GL_RED;  components = 1; break;
+	case AssetPack::Format::RG8:   format = GL_RG;   components = 2; break;
+	case AssetPack::Format::RGBA8: format = GL_RGBA; components = 4; break;
+	case AssetPack::Format::RGTC1: format = GL_COMPRESSED_RED_RGTC1; components = 1; break;
+	case AssetPack::Format::RGTC2: format = GL_COMPRESSED_RG_RGTC2;  components = 2; break;
+	default:                       format = GL_RGB;  components = 3; break;
+	}
+
+	// every level is stored, mips are only generated for packs cooked without them
+	auto level_data = data;
+	for (unsigned int mip = 0; mip < entry.mips; mip++)
+	{
+		const auto w = std::max(width  >> mip, 1);
+		const auto h = std::max(height >> mip, 1);
+		const auto size = AssetPack::GetLevelSize(entry.format, w, h);
+
+		if (AssetPack::IsCompressed(entry.format))
+		{
+			glCompressedTexImage2D(GL_TEXTURE_2D, mip, format, w, h, 0, static_cast<int>(size), level_data);
+		}
+		else
+		{
+			glTexImage2D(GL_TEXTURE_2D, mip, format, w, h, 0, format, GL_UNSIGNED_BYTE, level_data);
+		}
+
+		level_data += size;
+	}
+
+	SetParameters();
+
+	// the cooker keeps one channel of grey maps, sampled as grey again
+	if (components == 1)
+	{
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_G, GL_RED);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_B, GL_RED);
+	}
+
+	if (entry.mips <= 1 && !AssetPack::IsCompressed(entry.format))
+	{
+		glGenerateMipmap(GL_TEXTURE_2D);
+	}
+	else
+	{
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, std::max(static_cast<int>(entry.mips) - 1, 0));
+	}
+
+	glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+//==============================================================================
+
+void Texture::LoadHDR(const std::string &path, bool flip, HDRFormat format) noexcept
+{
+	HDRImage image;
+	if (image.Load(path, flip))
+	{
+		LoadHDR(image.GetPixels(), image.GetWidth(), image.GetHeight(), format);
+	}
+}
+
+//==============================================================================
+
+void Texture::LoadHDR(const unsigned short *data, int width, int height, HDRFormat format, int row_length) noexcept
+{
+	this->width      = width;
+	this->height     = height;
+	this->components = 3;
+
+	Init(data, format, row_length);
 }
 
 //==============================================================================
@@ -5,6 +5,11 @@
 
 #include <string>
 
+#include <glm/glm.hpp>
+
+#include "AssetPack.h"
+#include "HDRFormat.h"
+
 //==============================================================================
 
 class Texture
@@ -14,10 +19,12 @@ private:
 	int width;
 	int height;
 	int components;
+	glm::vec2 range;
+	glm::vec3 average;
 
 private:
 	void Init(const unsigned char *data) noexcept;
-	void Init(const float *data)         noexcept;
+	void Init(const unsigned short *data, HDRFormat format, int row_length) noexcept;
 
 public:
 	void SetParameters()    noexcept;
@@ -29,8 +36,20 @@ public:
 
 	unsigned int GetID() const noexcept;
 
+	const glm::vec2 &GetRange()   const noexcept;
+	const glm::vec3 &GetAverage() const noexcept;
+
 	void Load    (const std::string &path, bool flip = true) noexcept;
-	void LoadHDR (const std::string &path, bool flip = true) noexcept;
+
+	// 8 bit texels decoded elsewhere, e.g. on a worker thread; the first row is v = 0
+	void Load    (const unsigned char *data, int width, int height, int components) noexcept;
+
+	// a cooked texture, uploaded from the pack's mapped pages
+	void Load    (const AssetPack::Entry &entry, const unsigned char *data) noexcept;
+	void LoadHDR (const std::string &path, bool flip = true, HDRFormat format = HDRFormat::RGB16F) noexcept;
+	// three half floats per texel, as HDRImage decodes them; row_length
+	// selects a tile of a wider image
+	void LoadHDR (const unsigned short *data, int width, int height, HDRFormat format = HDRFormat::RGB16F, int row_length = 0) noexcept;
 
 	void Bind(unsigned int texture_unit = 0) const noexcept;
 	static void Unbind() noexcept;
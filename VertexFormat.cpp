@@ -0,0 +1,50 @@
+
+#include "VertexFormat.h"
+
+#include <cmath>
+
+#include <glm/gtc/packing.hpp>
+
+//==============================================================================
+
+unsigned int VertexFormat::GetPositionSize(Position format) noexcept
+{
+	return format == Position::SNORM16 ? 8 : 12;
+}
+
+//==============================================================================
+
+uint64_t VertexFormat::EncodePosition(const glm::vec3 &position) noexcept
+{
+	return glm::packSnorm4x16(glm::vec4(position, 0.0f));
+}
+
+//==============================================================================
+
+uint32_t VertexFormat::EncodeNormal(const glm::vec3 &normal) noexcept
+{
+	// onto the octahedron, then the lower half folded over the upper one
+	auto n = glm::vec2(normal) / (std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z));
+	if (normal.z < 0.0f)
+	{
+		n = (1.0f - glm::abs(glm::vec2(n.y, n.x))) * glm::vec2(n.x >= 0.0f ? 1.0f : -1.0f, n.y >= 0.0f ? 1.0f : -1.0f);
+	}
+
+	return glm::packSnorm2x16(n);
+}
+
+//==============================================================================
+
+uint32_t VertexFormat::EncodeTexCoord(const glm::vec2 &uv) noexcept
+{
+	return glm::packHalf2x16(uv);
+}
+
+//==============================================================================
+
+uint32_t VertexFormat::EncodeTangent(const glm::vec4 &tangent) noexcept
+{
+	return glm::packSnorm3x10_1x2(glm::vec4(glm::vec3(tangent), tangent.w < 0.0f ? -1.0f : 1.0f));
+}
+
+//==============================================================================
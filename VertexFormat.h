@@ -0,0 +1,49 @@
+
+#pragma once
+
+//==============================================================================
+
+#include <cstdint>
+
+#include <glm/glm.hpp>
+
+//==============================================================================
+
+// quantized vertex attributes; Drawable::SetVertices keeps each attribute in a
+// stream of its own, so a program that reads only positions fetches only those
+class VertexFormat
+{
+public:
+	enum class Position
+	{
+		FLOAT,   // 12 bytes, as given
+		SNORM16  // 8 bytes, relative to the mesh bounds, see Drawable::GetPositionDecode()
+	};
+
+	// attribute locations every vertex shader agrees on
+	static const unsigned int POSITION = 0;
+	static const unsigned int NORMAL   = 1;
+	static const unsigned int TEXCOORD = 2;
+	static const unsigned int TANGENT  = 3;
+
+	static const unsigned int NORMAL_SIZE   = 4;
+	static const unsigned int TEXCOORD_SIZE = 4;
+	static const unsigned int TANGENT_SIZE  = 4;
+
+public:
+	static unsigned int GetPositionSize(Position format) noexcept;
+
+	// xyz in [-1, 1] as 4 x 16 bit snorm, w is padding
+	static uint64_t EncodePosition(const glm::vec3 &position) noexcept;
+
+	// octahedral in 2 x 16 bit snorm, the inverse of OctDecode() in pbr.vs
+	static uint32_t EncodeNormal(const glm::vec3 &normal) noexcept;
+
+	// 2 x half
+	static uint32_t EncodeTexCoord(const glm::vec2 &uv) noexcept;
+
+	// xyz as 3 x 10 bit snorm, the sign of the bitangent w as 2 bit snorm
+	static uint32_t EncodeTangent(const glm::vec4 &tangent) noexcept;
+};
+
+//==============================================================================
@@ -3,14 +3,24 @@ out vec4 FragColor;
 in vec3 FragPos;
 
 uniform samplerCube environment_map;
+uniform samplerCube fade_environment_map;
+uniform float fade; // weight of the outgoing environment
+uniform bool tonemap;
 
 void main()
 {
 	vec3 color = textureLod(environment_map, FragPos, 0.0).rgb;
+	if (fade > 0.0)
+	{
+		color = mix(color, textureLod(fade_environment_map, FragPos, 0.0).rgb, fade);
+	}
 	
-	// HDR tonemap and gamma correct
-	color = color / (color + vec3(1.0));
-	color = pow(color, vec3(1.0/2.2)); 
+	if (tonemap)
+	{
+		// HDR tonemap and gamma correct
+		color = color / (color + vec3(1.0));
+		color = pow(color, vec3(1.0/2.2));
+	}
 	
 	FragColor = vec4(color, 1.0);
 }
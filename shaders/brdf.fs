@@ -2,13 +2,10 @@
 out vec2 FragColor;
 in vec2 TexCoords;
 
-const float PI = 3.14159265359;
+uniform int sample_count;
+
+#include "brdf.glsl"
 
-float RadicalInverse_VdC(uint bits);
-vec2 Hammersley(uint i, uint N);
-vec3 ImportanceSampleGGX(vec2 Xi, vec3 N, float roughness);
-float GeometrySchlickGGX(float NdotV, float roughness);
-float GeometrySmith(vec3 N, vec3 V, vec3 L, float roughness);
 vec2 IntegrateBRDF(float NdotV, float roughness);
 
 void main() 
@@ -17,66 +14,6 @@ void main()
 	FragColor = integratedBRDF;
 }
 
-float RadicalInverse_VdC(uint bits) 
-{
-	bits = (bits << 16u) | (bits >> 16u);
-	bits = ((bits & 0x55555555u) << 1u) | ((bits & 0xAAAAAAAAu) >> 1u);
-	bits = ((bits & 0x33333333u) << 2u) | ((bits & 0xCCCCCCCCu) >> 2u);
-	bits = ((bits & 0x0F0F0F0Fu) << 4u) | ((bits & 0xF0F0F0F0u) >> 4u);
-	bits = ((bits & 0x00FF00FFu) << 8u) | ((bits & 0xFF00FF00u) >> 8u);
-	return float(bits) * 2.3283064365386963e-10; // / 0x100000000
-}
-
-vec2 Hammersley(uint i, uint N)
-{
-	return vec2(float(i)/float(N), RadicalInverse_VdC(i));
-}
-
-vec3 ImportanceSampleGGX(vec2 Xi, vec3 N, float roughness)
-{
-	float a = roughness*roughness;
-	
-	float phi = 2.0 * PI * Xi.x;
-	float cosTheta = sqrt((1.0 - Xi.y) / (1.0 + (a*a - 1.0) * Xi.y));
-	float sinTheta = sqrt(1.0 - cosTheta*cosTheta);
-	
-	// from spherical coordinates to cartesian coordinates - halfway vector
-	vec3 H;
-	H.x = cos(phi) * sinTheta;
-	H.y = sin(phi) * sinTheta;
-	H.z = cosTheta;
-	
-	// from tangent-space H vector to world-space sample vector
-	vec3 up          = abs(N.z) < 0.999 ? vec3(0.0, 0.0, 1.0) : vec3(1.0, 0.0, 0.0);
-	vec3 tangent   = normalize(cross(up, N));
-	vec3 bitangent = cross(N, tangent);
-	
-	vec3 sampleVec = tangent * H.x + bitangent * H.y + N * H.z;
-	return normalize(sampleVec);
-}
-
-float GeometrySchlickGGX(float NdotV, float roughness)
-{
-	// note that we use a different k for IBL
-	float a = roughness;
-	float k = (a * a) / 2.0;
-	
-	float nom   = NdotV;
-	float denom = NdotV * (1.0 - k) + k;
-	
-	return nom / denom;
-}
-
-float GeometrySmith(vec3 N, vec3 V, vec3 L, float roughness)
-{
-	float NdotV = max(dot(N, V), 0.0);
-	float NdotL = max(dot(N, L), 0.0);
-	float ggx2 = GeometrySchlickGGX(NdotV, roughness);
-	float ggx1 = GeometrySchlickGGX(NdotL, roughness);
-	
-	return ggx1 * ggx2;
-}
-
 vec2 IntegrateBRDF(float NdotV, float roughness)
 {
 	vec3 V;
@@ -89,7 +26,7 @@ vec2 IntegrateBRDF(float NdotV, float roughness)
 	
 	vec3 N = vec3(0.0, 0.0, 1.0);
 	
-	const uint SAMPLE_COUNT = 1024u;
+	uint SAMPLE_COUNT = uint(sample_count);
 	for(uint i = 0u; i < SAMPLE_COUNT; ++i)
 	{
 		// generates a sample vector that's biased towards the
@@ -104,7 +41,8 @@ vec2 IntegrateBRDF(float NdotV, float roughness)
 		
 		if(NdotL > 0.0)
 		{
-			float G = GeometrySmith(N, V, L, roughness);
+			// note that we use a different k for IBL
+			float G = GeometrySmith(N, V, L, (roughness * roughness) / 2.0);
 			float G_Vis = (G * VdotH) / (NdotH * NdotV);
 			float Fc = pow(1.0 - VdotH, 5.0);
 			
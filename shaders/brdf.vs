@@ -1,11 +1,10 @@
 #version 330 core
 layout (location = 0) in vec3 aPos;
-layout (location = 1) in vec2 aTexCoords;
 
 out vec2 TexCoords;
 
 void main()
 {
-	TexCoords = aTexCoords;
+	TexCoords = aPos.xy * 0.5 + 0.5;
 	gl_Position = vec4(aPos, 1.0);
 }
@@ -0,0 +1,24 @@
+#version 400 core
+layout (triangles, invocations = 6) in;
+layout (triangle_strip, max_vertices = 3) out;
+
+out vec3 FragPos;
+
+layout (std140) uniform Capture
+{
+	mat4 capture_projection;
+	mat4 capture_views[6];
+};
+
+void main()
+{
+	// one invocation per cubemap face, routed to its layer
+	for (int i = 0; i < 3; i++)
+	{
+		FragPos = gl_in[i].gl_Position.xyz;
+		gl_Position = capture_projection * capture_views[gl_InvocationID] * vec4(FragPos, 1.0);
+		gl_Layer = gl_InvocationID;
+		EmitVertex();
+	}
+	EndPrimitive();
+}
@@ -0,0 +1,150 @@
+#version 430 core
+// one meshlet per invocation; the visible ones are appended to the command
+// buffer of the pass, see ClusterCuller
+layout (local_size_x = 64) in;
+
+struct Meshlet
+{
+	vec4 sphere;
+	vec4 cone;
+	uint first;
+	uint count;
+	uint padding[2];
+};
+
+// DrawElementsIndirectCommand
+struct Command
+{
+	uint count;
+	uint instance_count;
+	uint first;
+	int base_vertex;
+	uint base_instance;
+};
+
+layout (std430, binding = 0) readonly buffer Meshlets { Meshlet meshlets[]; };
+layout (std430, binding = 1) buffer Visibility { uint visibility[]; };
+layout (std430, binding = 2) writeonly buffer Commands { Command commands[]; };
+layout (std430, binding = 3) buffer Counters { uint counters[]; };
+
+uniform int meshlet_count;
+uniform int counter;
+
+// the early pass draws what was visible last frame, the late pass what the
+// pyramid of the early one shows and the early pass did not draw
+uniform bool late;
+uniform bool cone_culling;
+
+uniform mat4 model;
+uniform float model_scale;
+uniform vec3 object_camera;
+uniform vec4 planes[6];
+
+uniform mat4 view;
+uniform mat4 projection;
+uniform sampler2D pyramid;
+uniform int pyramid_levels;
+
+const float HALF_PI = 1.57079632679;
+
+bool IsInFrustum(vec3 center, float radius)
+{
+	for (int i = 0; i < 6; i++)
+	{
+		if (dot(planes[i].xyz, center) + planes[i].w < -radius)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+// every triangle faces away when every direction from the camera into the
+// sphere is within the cone's complement around the mean normal
+bool IsBackFacing(vec4 sphere, vec4 cone)
+{
+	vec3 offset = sphere.xyz - object_camera;
+	float distance = length(offset);
+	if (!cone_culling || cone.w >= HALF_PI || distance <= sphere.w)
+	{
+		return false;
+	}
+
+	float angle = acos(clamp(dot(offset / distance, cone.xyz), -1.0, 1.0));
+	return angle + asin(sphere.w / distance) + cone.w <= HALF_PI;
+}
+
+// the range of x / depth over a circle at depth d in front of the camera
+vec2 ProjectCircle(float x, float d, float radius)
+{
+	float t = sqrt(x * x + d * d - radius * radius);
+	return vec2((x * t - radius * d) / (d * t + radius * x), (x * t + radius * d) / (d * t - radius * x));
+}
+
+bool IsOccluded(vec3 center, float radius)
+{
+	vec3 c = (view * vec4(center, 1.0)).xyz;
+	float d = -c.z;
+
+	// nothing to compare with when it reaches past the near plane
+	float near = projection[3][2] / (projection[2][2] - 1.0);
+	if (d - radius <= near)
+	{
+		return false;
+	}
+
+	vec2 x = ProjectCircle(c.x, d, radius) * projection[0][0];
+	vec2 y = ProjectCircle(c.y, d, radius) * projection[1][1];
+	vec4 box = clamp(vec4(x.x, y.x, x.y, y.y) * 0.5 + 0.5, 0.0, 1.0);
+
+	// the level where the box spans at most two texels each way; its size is
+	// derived, a level that differs per invocation is not reliable everywhere
+	ivec2 base_size = textureSize(pyramid, 0);
+	vec2 extent = (box.zw - box.xy) * vec2(base_size);
+	int level = clamp(int(ceil(log2(max(max(extent.x, extent.y), 1.0)))), 0, pyramid_levels - 1);
+
+	ivec2 size = max(base_size >> level, ivec2(1));
+	ivec2 low  = clamp(ivec2(box.xy * vec2(size)), ivec2(0), size - 1);
+	ivec2 high = clamp(ivec2(box.zw * vec2(size)), ivec2(0), size - 1);
+
+	float farthest = max(max(texelFetch(pyramid, low, level).r, texelFetch(pyramid, ivec2(high.x, low.y), level).r),
+		max(texelFetch(pyramid, ivec2(low.x, high.y), level).r, texelFetch(pyramid, high, level).r));
+
+	float z = c.z + radius;
+	float depth = 0.5 * (projection[2][2] * z + projection[3][2]) / -z + 0.5;
+	return depth > farthest;
+}
+
+void main()
+{
+	int i = int(gl_GlobalInvocationID.x);
+	if (i >= meshlet_count)
+	{
+		return;
+	}
+
+	Meshlet meshlet = meshlets[i];
+	vec3 center = (model * vec4(meshlet.sphere.xyz, 1.0)).xyz;
+	float radius = meshlet.sphere.w * model_scale;
+
+	bool visible = IsInFrustum(center, radius) && !IsBackFacing(meshlet.sphere, meshlet.cone);
+	bool drawn_early = visibility[i] != 0u;
+
+	bool draw;
+	if (late)
+	{
+		visible = visible && !IsOccluded(center, radius);
+		visibility[i] = visible ? 1u : 0u;
+		draw = visible && !drawn_early;
+	}
+	else
+	{
+		draw = visible && drawn_early;
+	}
+
+	if (draw)
+	{
+		uint slot = atomicAdd(counters[counter], 1u);
+		commands[slot] = Command(meshlet.count, 1u, meshlet.first, 0, 0u);
+	}
+}
@@ -0,0 +1,36 @@
+#version 430 core
+// one level of the farthest depth pyramid from the level above it, or from the
+// depth buffer for the first one, see ClusterCuller::BuildDepthPyramid()
+layout (local_size_x = 8, local_size_y = 8) in;
+
+layout (r32f, binding = 0) uniform writeonly image2D target;
+
+uniform sampler2D source;
+uniform int source_level;
+
+void main()
+{
+	ivec2 size = imageSize(target);
+	ivec2 texel = ivec2(gl_GlobalInvocationID.xy);
+	if (any(greaterThanEqual(texel, size)))
+	{
+		return;
+	}
+
+	// every source texel the target texel touches, up to three each way below
+	// the depth buffer since the first level is a power of two
+	ivec2 source_size = textureSize(source, source_level);
+	ivec2 low  = texel * source_size / size;
+	ivec2 high = min(((texel + 1) * source_size + size - 1) / size, source_size);
+
+	float depth = 0.0;
+	for (int y = low.y; y < high.y; y++)
+	{
+		for (int x = low.x; x < high.x; x++)
+		{
+			depth = max(depth, texelFetch(source, ivec2(x, y), source_level).r);
+		}
+	}
+
+	imageStore(target, texel, vec4(depth));
+}
@@ -0,0 +1,43 @@
+#version 330 core
+// a quad around one sphere per instance, see SphereImpostors; pbr.fs (IMPOSTOR)
+// finds the surface behind each of its fragments
+layout (location = 0) in vec4 aSphere; // center and radius
+
+out vec3 QuadPos;
+flat out vec4 Sphere; // world space
+
+uniform mat4 model;
+uniform mat4 view;
+uniform mat4 projection;
+uniform vec3 camera;
+
+void main()
+{
+	float scale = max(length(model[0].xyz), max(length(model[1].xyz), length(model[2].xyz)));
+	vec3 center = vec3(model * vec4(aSphere.xyz, 1.0));
+	float radius = aSphere.w * scale;
+	Sphere = vec4(center, radius);
+
+	vec3 offset = center - camera;
+	float distance2 = dot(offset, offset);
+	if (distance2 <= radius * radius)
+	{
+		// every corner in the same place, outside the clip volume
+		QuadPos = center;
+		gl_Position = vec4(2.0, 2.0, 2.0, 1.0);
+		return;
+	}
+
+	// facing the camera, upright on screen; the cone of rays touching the
+	// sphere is this wide in the plane through its center
+	vec3 forward = offset * inversesqrt(distance2);
+	vec3 right = normalize(cross(forward, vec3(view[0][1], view[1][1], view[2][1])));
+	vec3 up = cross(right, forward);
+	float extent = radius * sqrt(distance2 / (distance2 - radius * radius));
+
+	// a strip over the corners 0, 1, 2, 3 = (-1, -1), (1, -1), (-1, 1), (1, 1)
+	vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1) * 2.0 - 1.0;
+	QuadPos = center + extent * (corner.x * right + corner.y * up);
+
+	gl_Position = projection * view * vec4(QuadPos, 1.0);
+}
@@ -0,0 +1,53 @@
+#version 330 core
+// the material of one view into the three atlases of OctahedralImpostor
+layout (location = 0) out vec4 Albedo;      // as the albedo map stores it, a the coverage
+layout (location = 1) out vec4 NormalDepth; // object space, w along the view
+layout (location = 2) out vec4 ORM;
+
+in vec3 FragPos;
+in vec3 Normal;
+in vec2 TexCoords;
+in vec4 Tangent;
+
+uniform sampler2D albedo_map;
+uniform sampler2D normal_map;
+uniform sampler2D orm_map;
+uniform sampler2D metallic_map;
+uniform sampler2D roughness_map;
+uniform sampler2D ao_map;
+uniform bool use_normal_map;
+uniform bool use_orm_map;
+
+// towards the camera of the view, and the radius of the bounds
+uniform vec3 direction;
+uniform float radius;
+
+// as GetNormalFromMap() in pbr.fs
+vec3 GetNormalFromMap()
+{
+	vec3 tangentNormal = texture(normal_map, TexCoords).xyz * 2.0 - 1.0;
+
+	vec3 N   = normalize(Normal);
+	vec3 T   = Tangent.xyz;
+	vec3 B   = Tangent.w * cross(N, T);
+	mat3 TBN = mat3(T, B, N);
+
+	return normalize(TBN * tangentNormal);
+}
+
+void main()
+{
+	Albedo = vec4(texture(albedo_map, TexCoords).rgb, 1.0);
+
+	vec3 N = use_normal_map ? GetNormalFromMap() : normalize(Normal);
+	NormalDepth = vec4(N, dot(FragPos, direction) / radius);
+
+	if (use_orm_map)
+	{
+		ORM = vec4(texture(orm_map, TexCoords).rgb, 1.0);
+	}
+	else
+	{
+		ORM = vec4(texture(ao_map, TexCoords).r, texture(roughness_map, TexCoords).r, texture(metallic_map, TexCoords).r, 1.0);
+	}
+}
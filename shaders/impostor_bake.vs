@@ -0,0 +1,36 @@
+#version 330 core
+// the source object from one view of an octahedral impostor, see
+// OctahedralImpostor::Bake(); everything stays in the object's own space
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec2 aNormal; // octahedral, see VertexFormat::EncodeNormal()
+layout (location = 2) in vec2 aTexCoords;
+layout (location = 3) in vec4 aTangent; // w the sign of the bitangent, see VertexFormat::EncodeTangent()
+
+out vec3 FragPos;
+out vec3 Normal;
+out vec2 TexCoords;
+out vec4 Tangent;
+
+uniform mat4 model; // the position decode of the source
+uniform mat4 view;
+uniform mat4 projection;
+
+vec3 OctDecode(vec2 e)
+{
+	vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+	if (n.z < 0.0)
+	{
+		n.xy = (1.0 - abs(n.yx)) * vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+	}
+	return normalize(n);
+}
+
+void main()
+{
+	FragPos = vec3(model * vec4(aPos, 1.0));
+	Normal = OctDecode(aNormal);
+	TexCoords = aTexCoords;
+	Tangent = aTangent;
+
+	gl_Position = projection * view * vec4(FragPos, 1.0);
+}
@@ -0,0 +1,35 @@
+// the views of an octahedral impostor, shared by octahedral_impostor.vs and
+// pbr.fs; OctahedralImpostor::Bake() renders them with the same directions and
+// bases
+
+// views per side of the atlas, OctahedralImpostor::FRAMES
+const int FRAMES = 8;
+
+// the upper hemisphere onto [-1, 1]^2: the upper half of the octahedral map
+// is a diamond, turned by 45 degrees here to fill the square, so the horizon
+// runs along its border
+vec2 HemiOctEncode(vec3 dir)
+{
+	vec2 p = dir.xz / (abs(dir.x) + abs(dir.y) + abs(dir.z));
+	return vec2(p.x + p.y, p.x - p.y);
+}
+
+vec3 HemiOctDecode(vec2 e)
+{
+	vec2 p = vec2(e.x + e.y, e.x - e.y) * 0.5;
+	return normalize(vec3(p.x, 1.0 - abs(p.x) - abs(p.y), p.y));
+}
+
+// towards the camera that rendered the frame
+vec3 FrameDirection(ivec2 frame)
+{
+	return HemiOctDecode((vec2(frame) + 0.5) / float(FRAMES) * 2.0 - 1.0);
+}
+
+// the screen axes of that camera, as glm::lookAt() builds them
+void FrameBasis(vec3 direction, out vec3 right, out vec3 up)
+{
+	vec3 reference = abs(direction.y) < 0.999 ? vec3(0.0, 1.0, 0.0) : vec3(0.0, 0.0, 1.0);
+	right = normalize(cross(-direction, reference));
+	up = cross(right, -direction);
+}
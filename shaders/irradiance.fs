@@ -3,6 +3,7 @@ out vec4 FragColor;
 in vec3 FragPos;
 
 uniform samplerCube environment_map;
+uniform float sample_delta;
 
 const float PI = 3.14159265359;
 
@@ -17,7 +18,7 @@ void main()
     vec3 right = normalize(cross(up, N));
     up         = normalize(cross(N, right));
        
-    float sampleDelta = 0.025;
+    float sampleDelta = sample_delta;
     float nrSamples = 0.0f;
     for(float phi = 0.0; phi < 2.0 * PI; phi += sampleDelta)
     {
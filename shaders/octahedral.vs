@@ -0,0 +1,24 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+
+out vec3 FragPos;
+
+// inverse of OctEncode() in pbr.fs, without the normalization: within each
+// triangle of the unfolded octahedron the point on its surface is linear in
+// the position, so FragPos interpolates exactly and the fragment shaders
+// that bake cubemaps only normalize it
+vec3 OctDecode(vec2 p)
+{
+	vec3 n = vec3(p, 1.0 - abs(p.x) - abs(p.y));
+	if (n.z < 0.0)
+	{
+		n.xy = (1.0 - abs(n.yx)) * vec2(p.x >= 0.0 ? 1.0 : -1.0, p.y >= 0.0 ? 1.0 : -1.0);
+	}
+	return n;
+}
+
+void main()
+{
+	FragPos = OctDecode(aPos.xy);
+	gl_Position = vec4(aPos.xy, 0.0, 1.0);
+}
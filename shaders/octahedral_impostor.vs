@@ -0,0 +1,70 @@
+#version 330 core
+// a quad around one instance, see OctahedralImpostor; pbr.fs
+// (OCTAHEDRAL_IMPOSTOR) blends the three baked views nearest to the camera's
+layout (location = 0) in vec4 aInstance; // position and scale
+
+// instance space, where the bounds of the baked object are the unit sphere
+out vec3 QuadPos;
+flat out vec3 RayOrigin;
+flat out vec4 Instance;
+
+flat out ivec2 Frames[3];
+flat out vec3 FrameWeights;
+
+uniform mat4 model;
+uniform mat4 view;
+uniform mat4 projection;
+uniform vec3 camera;
+
+#include "impostor_frames.glsl"
+
+void main()
+{
+	Instance = aInstance;
+
+	mat3 inverse_axes = inverse(mat3(model));
+	RayOrigin = (inverse_axes * (camera - vec3(model[3])) - aInstance.xyz) / aInstance.w;
+
+	float distance2 = dot(RayOrigin, RayOrigin);
+	if (distance2 <= 1.0)
+	{
+		// every corner in the same place, outside the clip volume
+		QuadPos = vec3(0.0);
+		gl_Position = vec4(2.0, 2.0, 2.0, 1.0);
+		return;
+	}
+
+	// facing the camera, upright on screen, around the outline of the bounds
+	vec3 forward = -RayOrigin * inversesqrt(distance2);
+	vec3 right = normalize(cross(forward, inverse_axes * vec3(view[0][1], view[1][1], view[2][1])));
+	vec3 up = cross(right, forward);
+	float extent = sqrt(distance2 / (distance2 - 1.0));
+
+	// a strip over the corners 0, 1, 2, 3 = (-1, -1), (1, -1), (-1, 1), (1, 1)
+	vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1) * 2.0 - 1.0;
+	QuadPos = extent * (corner.x * right + corner.y * up);
+
+	// the views from below the horizon take the one above them
+	vec3 direction = -forward;
+	direction.y = max(direction.y, 1e-4);
+	vec2 frame = (HemiOctEncode(direction) * 0.5 + 0.5) * float(FRAMES) - 0.5;
+	frame = clamp(frame, vec2(0.0), vec2(FRAMES - 1));
+
+	// the triangle of frame centers around the view, with its barycentrics
+	ivec2 base = min(ivec2(frame), ivec2(FRAMES - 2));
+	vec2 f = frame - vec2(base);
+	Frames[0] = base;
+	Frames[2] = base + ivec2(1, 1);
+	if (f.x > f.y)
+	{
+		Frames[1] = base + ivec2(1, 0);
+		FrameWeights = vec3(1.0 - f.x, f.x - f.y, f.y);
+	}
+	else
+	{
+		Frames[1] = base + ivec2(0, 1);
+		FrameWeights = vec3(1.0 - f.y, f.y - f.x, f.x);
+	}
+
+	gl_Position = projection * view * model * vec4(aInstance.xyz + aInstance.w * QuadPos, 1.0);
+}
@@ -1,17 +1,73 @@
-#version 330 core
+#version 400 core
 out vec4 FragColor;
 
+// variants, defined by Scene::GetPBRShader():
+// LIGHT_COUNT - point lights in lights[]
+// NORMAL_MAP  - perturbed by material.normal, the interpolated normal otherwise
+// ORM_MAP     - occlusion, roughness and metallic packed into material.orm
+// IBL         - ambient light from the environment, probes and volume
+// TONEMAP     - tonemapped and gamma corrected output, linear HDR otherwise
+// IMPOSTOR    - a sphere ray cast through the quads of impostor.vs, see SphereImpostors
+// OCT_IMPOSTOR - baked views blended on the quads of octahedral_impostor.vs, see
+//               OctahedralImpostor; material.albedo, normal and orm are its atlases
+// OCTAHEDRAL  - the global irradiance and prefilter maps are octahedral, see OctEncode()
+// FADE_OCTAHEDRAL - so are the outgoing ones while crossfading
+#ifndef LIGHT_COUNT
+#define LIGHT_COUNT 4
+#endif
+#ifndef MAX_PROBES
+#define MAX_PROBES 64 // LocalProbes::MAX_PROBES
+#endif
+
+#ifdef IMPOSTOR
+in vec3 QuadPos;
+flat in vec4 Sphere;
+
+uniform mat4 model;
+uniform mat4 view;
+uniform mat4 projection;
+
+// where the ray hits the sphere, see IntersectSphere()
+vec3 Normal;
+vec3 FragPos;
+vec2 TexCoords;
+vec4 Tangent;
+#elif defined(OCT_IMPOSTOR)
+in vec3 QuadPos;
+flat in vec3 RayOrigin;
+flat in vec4 Instance;
+
+flat in ivec2 Frames[3];
+flat in vec3 FrameWeights;
+
+uniform mat4 model;
+uniform mat4 view;
+uniform mat4 projection;
+
+// where the ray meets the blended views, see BlendFrames()
+vec3 FragPos;
+vec2 FrameUVs[3];
+vec3 FrameCoverage;
+#else
 in vec3 Normal;
 in vec3 FragPos;
 in vec2 TexCoords;
+in vec4 Tangent;
+#endif
 
 struct Material
 {
 	sampler2D albedo;
+#ifdef NORMAL_MAP
 	sampler2D normal;
+#endif
+#ifdef ORM_MAP
+	sampler2D orm; // r - ambient occlusion, g - roughness, b - metallic
+#else
 	sampler2D metallic;
 	sampler2D roughness;
 	sampler2D ao;
+#endif
 };
 
 struct Light
@@ -20,39 +76,132 @@ struct Light
 	vec3 color;
 };
 
-//IBL
+struct Probe
+{
+	vec4 position; // w: shape, 0 - box, 1 - sphere
+	vec4 extents;  // w: blend distance
+};
+
+#ifdef IBL
+// the octahedral maps take the units of the cubemaps they replace, which keeps
+// a variant within the 16 texture units GL guarantees
+#ifdef OCTAHEDRAL
+uniform sampler2D irradiance_map;
+uniform sampler2D prefilter_map;
+#else
 uniform samplerCube irradiance_map;
 uniform samplerCube prefilter_map;
+#endif
 uniform sampler2D brdfLUT;
+uniform float max_reflection_lod;
+uniform vec2 prefilter_lod_range; // mips present in prefilter_map, lod is relative to the first
+
+// outgoing environment while crossfading
+#ifdef FADE_OCTAHEDRAL
+uniform sampler2D fade_irradiance_map;
+uniform sampler2D fade_prefilter_map;
+#else
+uniform samplerCube fade_irradiance_map;
+uniform samplerCube fade_prefilter_map;
+#endif
+uniform vec2 fade_lod_range;
+uniform float fade; // weight of the outgoing environment
+
+// fallbacks while the IBL is still baking
+uniform vec3 sh[9]; // cosine convolved irradiance / PI
+uniform samplerCube environment_map;
+uniform float environment_lod;
+uniform bool use_irradiance_map;
+uniform int specular_source; // 0 - SH, 1 - environment map mips, 2 - prefiltered map
+uniform bool use_brdfLUT;
 
-// lights
-uniform Light lights[4];
+// baked SH9 grid, 27 coefficients in 7 RGBA blocks stacked along z
+uniform sampler3D irradiance_volume;
+uniform bool use_irradiance_volume;
+uniform vec3 volume_min;
+uniform vec3 volume_max;
+uniform ivec3 volume_resolution;
+
+// local probes
+layout (std140) uniform Probes
+{
+	Probe probes[MAX_PROBES];
+};
+
+uniform samplerCubeArray probe_irradiance;
+uniform samplerCubeArray probe_prefilter;
+uniform ivec4 probe_indices;
+uniform int probe_count;
+#endif
+
+#if LIGHT_COUNT > 0
+uniform Light lights[LIGHT_COUNT];
+#endif
 
 uniform Material material;
-//uniform Light light;
 uniform vec3 camera;
 
-const float PI = 3.14159265359;
+#include "brdf.glsl"
 
+#ifdef OCT_IMPOSTOR
+#include "impostor_frames.glsl"
+#endif
+
+vec4 SampleMaterial(sampler2D map);
 vec3 GetNormalFromMap();
-float DistributionGGX(vec3 N, vec3 H, float roughness);
-float GeometrySchlickGGX(float NdotV, float roughness);
-float GeometrySmith(vec3 N, vec3 V, vec3 L, float roughness);
-vec3 FresnelSchlick(float cosTheta, vec3 F0);
-vec3 FresnelSchlickRoughness(float cosTheta, vec3 F0, float roughness);
+#ifdef IMPOSTOR
+bool IntersectSphere();
+#endif
+#ifdef OCT_IMPOSTOR
+bool BlendFrames();
+#endif
+#ifdef IBL
+float ProbeWeight(Probe probe, vec3 position);
+vec3 ParallaxCorrect(Probe probe, vec3 position, vec3 R);
+vec3 EvaluateSH(vec3 c[9], vec3 N);
+vec3 IrradianceSH(vec3 N);
+vec3 IrradianceVolume(vec3 position, vec3 N);
+vec2 OctEncode(vec3 dir);
+vec3 GlobalIrradiance(vec3 N);
+vec3 GlobalSpecular(vec3 R, float roughness, float lod);
+vec2 EnvBRDFApprox(float NdotV, float roughness);
+#endif
 
 void main()
 {
+#ifdef IMPOSTOR
+	if (!IntersectSphere())
+	{
+		discard;
+	}
+#endif
+#ifdef OCT_IMPOSTOR
+	if (!BlendFrames())
+	{
+		discard;
+	}
+#endif
+	
 	// material properties
-	vec3 albedo = pow(texture(material.albedo, TexCoords).rgb, vec3(2.2));
-	float metallic = texture(material.metallic, TexCoords).r;
-	float roughness = texture(material.roughness, TexCoords).r;
-	float ao = texture(material.ao, TexCoords).r;
+	vec3 albedo = pow(SampleMaterial(material.albedo).rgb, vec3(2.2));
+#ifdef ORM_MAP
+	vec3 orm = SampleMaterial(material.orm).rgb;
+	float metallic = orm.b;
+	float roughness = orm.g;
+	float ao = orm.r;
+#else
+	float metallic = SampleMaterial(material.metallic).r;
+	float roughness = SampleMaterial(material.roughness).r;
+	float ao = SampleMaterial(material.ao).r;
+#endif
 	
 	// light properties
+#ifdef NORMAL_MAP
 	vec3 N = GetNormalFromMap();
+#else
+	vec3 N = normalize(Normal);
+#endif
 	vec3 V = normalize(camera - FragPos);
-	vec3 R = reflect(-V, N);
 	
 	// reflectance at normal incidence
 	vec3 F0 = vec3(0.04); 
@@ -60,7 +209,11 @@ void main()
 	
 	// reflectance equation
 	vec3 Lo = vec3(0.0);
-	for (int i = 0; i < 4; i++)
+#if LIGHT_COUNT > 0
+	// Schlick-GGX k for analytic lights
+	float k = (roughness + 1.0) * (roughness + 1.0) / 8.0;
+	
+	for (int i = 0; i < LIGHT_COUNT; i++)
 	{
 		// light radiance
 		vec3 L = normalize(lights[i].position - FragPos);
@@ -71,7 +224,7 @@ void main()
 		
 		// cook-torrance brdf
 		float NDF = DistributionGGX(N, H, roughness);   
-		float G   = GeometrySmith(N, V, L, roughness);    
+		float G   = GeometrySmith(N, V, L, k);
 		vec3 F    = FresnelSchlick(max(dot(H, V), 0.0), F0);
 		
 		vec3 numerator    = NDF * G * F;
@@ -86,8 +239,11 @@ void main()
 		
 		Lo += (kD * albedo / PI + specular) * radiance * NdotL;
 	}
+#endif
 	
+#ifdef IBL
 	// ambient light (IBL)
+	vec3 R = reflect(-V, N);
 	
 	vec3 F = FresnelSchlickRoughness(max(dot(N, V), 0.0), F0, roughness);
 	
@@ -95,86 +251,347 @@ void main()
 	vec3 kD = 1.0 - kS;
 	kD *= 1.0 - metallic;
 	
+	float lod = roughness * max_reflection_lod;
+	
+	// local probes, smallest first, the global maps fill the remaining weight
+	vec3 irradiance = vec3(0.0);
+	vec3 prefilteredColor = vec3(0.0);
+	float weight = 0.0;
+	for (int i = 0; i < probe_count && weight < 1.0; i++)
+	{
+		int index = probe_indices[i];
+		float w = min(ProbeWeight(probes[index], FragPos), 1.0 - weight);
+		if (w > 0.0)
+		{
+			vec3 dir = ParallaxCorrect(probes[index], FragPos, R);
+			irradiance       += w * texture(probe_irradiance, vec4(N, index)).rgb;
+			prefilteredColor += w * textureLod(probe_prefilter, vec4(dir, index), lod).rgb;
+			weight += w;
+		}
+	}
+	if (weight < 1.0)
+	{
+		irradiance       += (1.0 - weight) * GlobalIrradiance(N);
+		prefilteredColor += (1.0 - weight) * GlobalSpecular(R, roughness, lod);
+	}
+	
 	// IBL diffuse part
-	vec3 irradiance = texture(irradiance_map, N).rgb;
-	vec3 diffuse    = irradiance * albedo;
+	vec3 diffuse = irradiance * albedo;
 	
 	// IBL specular part
-	const float MAX_REFLECTION_LOD = 4.0;
-	vec3 prefilteredColor = textureLod(prefilter_map, R, roughness * MAX_REFLECTION_LOD).rgb;
-	vec2 brdf = texture(brdfLUT, vec2(max(dot(N, V), 0.0), roughness)).rg;
+	vec2 brdf = use_brdfLUT ?
+		texture(brdfLUT, vec2(max(dot(N, V), 0.0), roughness)).rg :
+		EnvBRDFApprox(max(dot(N, V), 0.0), roughness);
 	vec3 specular = prefilteredColor * (F * brdf.x + brdf.y);
 	
 	vec3 ambient = (kD * diffuse + specular) * ao;
 	
 	vec3 color = ambient + Lo;
+#else
+	vec3 color = Lo;
+#endif
 	
+#ifdef TONEMAP
 	// HDR tonemapping
 	color = color / (color + vec3(1.0));
 	// gamma correct
 	color = pow(color, vec3(1.0/2.2)); 
+#endif
 	
 	FragColor = vec4(color , 1.0);
 }
 
+#ifdef OCT_IMPOSTOR
+vec4 SampleMaterial(sampler2D map)
+{
+	return FrameCoverage.x * texture(map, FrameUVs[0]) + FrameCoverage.y * texture(map, FrameUVs[1]) + FrameCoverage.z * texture(map, FrameUVs[2]);
+}
+#else
+vec4 SampleMaterial(sampler2D map)
+{
+	return texture(map, TexCoords);
+}
+#endif
+
+#if defined(NORMAL_MAP) && defined(OCT_IMPOSTOR)
+// the atlas holds the normal in the object's space
 vec3 GetNormalFromMap()
 {
-	vec3 tangentNormal = texture(material.normal, TexCoords).xyz * 2.0 - 1.0;
-	
-	vec3 Q1  = dFdx(FragPos);
-	vec3 Q2  = dFdy(FragPos);
-	vec2 st1 = dFdx(TexCoords);
-	vec2 st2 = dFdy(TexCoords);
+	return normalize(mat3(model) * SampleMaterial(material.normal).xyz);
+}
+#elif defined(NORMAL_MAP)
+// the interpolated frame of the vertices, the bitangent rebuilt with the sign
+// they carry; the same as MikkTSpace's bake, so no per fragment derivatives
+vec3 GetNormalFromMap()
+{
+	vec3 tangentNormal = SampleMaterial(material.normal).xyz * 2.0 - 1.0;
 	
-	vec3 N   =  normalize(Normal);
-	vec3 T   =  normalize(Q1*st2.t - Q2*st1.t);
-	vec3 B   = -normalize(cross(N, T));
-	mat3 TBN =  mat3(T, B, N);
+	vec3 N   = normalize(Normal);
+	vec3 T   = Tangent.xyz;
+	vec3 B   = Tangent.w * cross(N, T);
+	mat3 TBN = mat3(T, B, N);
 	
 	return normalize(TBN * tangentNormal);
 }
+#endif
 
-float DistributionGGX(vec3 N, vec3 H, float roughness)
+#ifdef IMPOSTOR
+// the nearer hit of the ray from the camera through the quad; a miss still
+// takes the outline, so the derivatives next to the edge stay smooth
+bool IntersectSphere()
 {
-	float a = roughness * roughness;
-	float a2 = a * a;
-	float NdotH = max(dot(N, H), 0.0);
-	float NdotH2 = NdotH * NdotH;
+	vec3 direction = normalize(QuadPos - camera);
+	vec3 offset = camera - Sphere.xyz;
+	float b = dot(offset, direction);
+	float h = b * b - dot(offset, offset) + Sphere.w * Sphere.w;
+	
+	FragPos = camera + (-b - sqrt(max(h, 0.0))) * direction;
+	Normal = (FragPos - Sphere.xyz) / Sphere.w;
 	
-	float nom   = a2;
-	float denom = (NdotH2 * (a2 - 1.0) + 1.0);
-	denom = PI * denom * denom;
+	// the coordinates Sphere generates, in the sphere's own orientation; u has
+	// its seam at 0 or at 0.5, whichever keeps the derivatives small here
+	vec3 local = normalize(transpose(mat3(model)) * Normal);
+	float u = atan(local.z, local.x) / (2.0 * PI);
+	float u0 = fract(u);
+	float u1 = fract(u + 0.5) - 0.5;
+	TexCoords = vec2(fwidth(u0) <= fwidth(u1) ? u0 : u1, acos(clamp(local.y, -1.0, 1.0)) / PI);
 	
-	return nom / denom;
+	// along the parallel as Sphere's tangents, any direction at the poles
+	vec2 parallel = vec2(-local.z, local.x);
+	float length2 = dot(parallel, parallel);
+	parallel = length2 > 1e-12 ? parallel * inversesqrt(length2) : vec2(0.0, 1.0);
+	Tangent = vec4(normalize(mat3(model) * vec3(parallel.x, 0.0, parallel.y)), -1.0);
+	
+	vec4 clip = projection * view * vec4(FragPos, 1.0);
+	gl_FragDepth = 0.5 * clip.z / clip.w + 0.5;
+	
+	return h >= 0.0;
 }
+#endif
 
-float GeometrySchlickGGX(float NdotV, float roughness)
+#ifdef OCT_IMPOSTOR
+// each view is looked up where the ray crosses its plane through the center,
+// then once more where the ray reaches the depth found there, which follows
+// the surface instead of the plane; the views are weighted by their coverage
+// and the surface is put back on the ray at the blended depth
+bool BlendFrames()
 {
-	float r = (roughness + 1.0);
-	float k = (r * r) / 8.0;
+	vec3 direction = normalize(QuadPos - RayOrigin);
 	
-	float nom   = NdotV;
-	float denom = NdotV * (1.0 - k) + k;
+	float coverage = 0.0;
+	float distance = 0.0;
+	for (int i = 0; i < 3; i++)
+	{
+		vec3 axis = FrameDirection(Frames[i]);
+		vec3 right, up;
+		FrameBasis(axis, right, up);
+		
+		float cosine = min(dot(direction, axis), -1e-4);
+		float height = dot(RayOrigin, axis);
+		
+		float t = -height / cosine;
+		vec2 uv = vec2(0.0);
+		for (int step = 0; step < 2; step++)
+		{
+			vec3 p = RayOrigin + t * direction;
+			uv = vec2(dot(p, right), dot(p, up)) * 0.5 + 0.5;
+			FrameUVs[i] = (vec2(Frames[i]) + clamp(uv, 0.0, 1.0)) / float(FRAMES);
+			t = (texture(material.normal, FrameUVs[i]).w - height) / cosine;
+		}
+		
+		float inside = uv == clamp(uv, 0.0, 1.0) ? 1.0 : 0.0;
+		float weight = FrameWeights[i] * inside * texture(material.albedo, FrameUVs[i]).a;
+		
+		FrameCoverage[i] = weight;
+		distance += weight * t;
+		coverage += weight;
+	}
+	
+	FrameCoverage /= max(coverage, 1e-4);
+	distance /= max(coverage, 1e-4);
+	
+	FragPos = vec3(model * vec4(Instance.xyz + Instance.w * (RayOrigin + distance * direction), 1.0));
 	
-	return nom / denom;
+	vec4 clip = projection * view * vec4(FragPos, 1.0);
+	gl_FragDepth = 0.5 * clip.z / clip.w + 0.5;
+	
+	return coverage >= 0.5;
 }
+#endif
+
+#ifdef IBL
 
-float GeometrySmith(vec3 N, vec3 V, vec3 L, float roughness)
+float ProbeWeight(Probe probe, vec3 position)
 {
-	float NdotV = max(dot(N, V), 0.0);
-	float NdotL = max(dot(N, L), 0.0);
-	float ggx2 = GeometrySchlickGGX(NdotV, roughness);
-	float ggx1 = GeometrySchlickGGX(NdotL, roughness);
+	// 1 deeper than the blend distance inside the volume, 0 on its border
+	vec3 local = position - probe.position.xyz;
+	float distance = probe.position.w < 0.5 ?
+		max(max(abs(local.x) - probe.extents.x, abs(local.y) - probe.extents.y), abs(local.z) - probe.extents.z) :
+		length(local) - probe.extents.x;
+	
+	return clamp(-distance / max(probe.extents.w, 0.0001), 0.0, 1.0);
+}
 
-    return ggx1 * ggx2;
+vec3 ParallaxCorrect(Probe probe, vec3 position, vec3 R)
+{
+	// intersect the reflection ray with the influence volume
+	vec3 local = position - probe.position.xyz;
+	if (probe.position.w < 0.5)
+	{
+		vec3 first  = ( probe.extents.xyz - local) / R;
+		vec3 second = (-probe.extents.xyz - local) / R;
+		vec3 furthest = max(first, second);
+		float t = min(min(furthest.x, furthest.y), furthest.z);
+		return local + t * R;
+	}
+	
+	float b = dot(local, R);
+	float c = dot(local, local) - probe.extents.x * probe.extents.x;
+	float t = -b + sqrt(max(b * b - c, 0.0));
+	return local + t * R;
 }
 
-vec3 FresnelSchlick(float cosTheta, vec3 F0)
+vec3 EvaluateSH(vec3 c[9], vec3 N)
 {
-    return F0 + (1.0 - F0) * pow(clamp(1.0 - cosTheta, 0.0, 1.0), 5.0);
+	return max(
+		c[0] * 0.282095 +
+		c[1] * 0.488603 * N.y +
+		c[2] * 0.488603 * N.z +
+		c[3] * 0.488603 * N.x +
+		c[4] * 1.092548 * N.x * N.y +
+		c[5] * 1.092548 * N.y * N.z +
+		c[6] * 0.315392 * (3.0 * N.z * N.z - 1.0) +
+		c[7] * 1.092548 * N.x * N.z +
+		c[8] * 0.546274 * (N.x * N.x - N.y * N.y), vec3(0.0));
 }
 
-vec3 FresnelSchlickRoughness(float cosTheta, vec3 F0, float roughness)
+vec3 IrradianceSH(vec3 N)
 {
-    return F0 + (max(vec3(1.0 - roughness), F0) - F0) * pow(clamp(1.0 - cosTheta, 0.0, 1.0), 5.0);
+	return EvaluateSH(sh, N);
 }
+
+vec3 IrradianceVolume(vec3 position, vec3 N)
+{
+	// trilinear between probe centers, clamped inside each block
+	vec3 size = vec3(volume_resolution);
+	
+	// offset along the normal against probes that see the surface itself
+	vec3 cell = (volume_max - volume_min) / max(size - 1.0, 1.0);
+	position += N * 0.5 * min(cell.x, min(cell.y, cell.z));
+	
+	vec3 texel = clamp((position - volume_min) / (volume_max - volume_min), 0.0, 1.0) * (size - 1.0) + 0.5;
+	
+	float scalars[28];
+	for (int block = 0; block < 7; block++)
+	{
+		vec3 uvw = vec3(texel.xy / size.xy, (texel.z + float(block) * size.z) / (7.0 * size.z));
+		vec4 value = texture(irradiance_volume, uvw);
+		scalars[4 * block + 0] = value.x;
+		scalars[4 * block + 1] = value.y;
+		scalars[4 * block + 2] = value.z;
+		scalars[4 * block + 3] = value.w;
+	}
+	
+	vec3 c[9];
+	for (int i = 0; i < 9; i++)
+	{
+		c[i] = vec3(scalars[3 * i], scalars[3 * i + 1], scalars[3 * i + 2]);
+	}
+	
+	return EvaluateSH(c, N);
+}
+
+vec3 GlobalIrradiance(vec3 N)
+{
+	bool inside = all(greaterThanEqual(FragPos, volume_min)) && all(lessThanEqual(FragPos, volume_max));
+	if (use_irradiance_volume && inside)
+	{
+		return IrradianceVolume(FragPos, N);
+	}
+	
+	vec3 irradiance;
+	if (use_irradiance_map)
+	{
+#ifdef OCTAHEDRAL
+		irradiance = textureLod(irradiance_map, OctEncode(N), 0.0).rgb;
+#else
+		irradiance = texture(irradiance_map, N).rgb;
+#endif
+	}
+	else
+	{
+		irradiance = IrradianceSH(N);
+	}
+	
+	if (fade > 0.0)
+	{
+#ifdef FADE_OCTAHEDRAL
+		vec3 outgoing = textureLod(fade_irradiance_map, OctEncode(N), 0.0).rgb;
+#else
+		vec3 outgoing = texture(fade_irradiance_map, N).rgb;
+#endif
+		irradiance = mix(irradiance, outgoing, fade);
+	}
+	
+	return irradiance;
+}
+
+vec3 GlobalSpecular(vec3 R, float roughness, float lod)
+{
+	vec3 specular;
+	if (specular_source == 2)
+	{
+		float level = clamp(lod, prefilter_lod_range.x, prefilter_lod_range.y) - prefilter_lod_range.x;
+#ifdef OCTAHEDRAL
+		specular = textureLod(prefilter_map, OctEncode(R), level).rgb;
+#else
+		specular = textureLod(prefilter_map, R, level).rgb;
+#endif
+	}
+	else
+	if (specular_source == 1)
+	{
+		specular = textureLod(environment_map, R, roughness * environment_lod).rgb;
+	}
+	else
+	{
+		specular = IrradianceSH(R);
+	}
+	
+	if (fade > 0.0)
+	{
+		float level = clamp(lod, fade_lod_range.x, fade_lod_range.y) - fade_lod_range.x;
+#ifdef FADE_OCTAHEDRAL
+		vec3 outgoing = textureLod(fade_prefilter_map, OctEncode(R), level).rgb;
+#else
+		vec3 outgoing = textureLod(fade_prefilter_map, R, level).rgb;
+#endif
+		specular = mix(specular, outgoing, fade);
+	}
+	
+	return specular;
+}
+
+vec2 OctEncode(vec3 dir)
+{
+	// folds the lower half of the octahedron over the upper one,
+	// the inverse of OctDecode() in octahedral.vs
+	vec3 n = dir / (abs(dir.x) + abs(dir.y) + abs(dir.z));
+	if (n.z < 0.0)
+	{
+		n.xy = (1.0 - abs(n.yx)) * vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+	}
+	return n.xy * 0.5 + 0.5;
+}
+
+vec2 EnvBRDFApprox(float NdotV, float roughness)
+{
+	// analytic fit of the split-sum LUT (Karis)
+	const vec4 c0 = vec4(-1.0, -0.0275, -0.572, 0.022);
+	const vec4 c1 = vec4(1.0, 0.0425, 1.04, -0.04);
+	vec4 r = roughness * c0 + c1;
+	float a004 = min(r.x * r.x, exp2(-9.28 * NdotV)) * r.x + r.y;
+	return vec2(-1.04, 1.04) * a004 + r.zw;
+}
+
+#endif
@@ -4,6 +4,12 @@ in vec3 FragPos;
 
 uniform sampler2D rectangular_map;
 
+// set when the map is converted in tiles: the tile's x, y, width and height
+// and the texels it owns (min x, min y, max x, max y), in texels of the map
+uniform vec4 tile;
+uniform vec4 tile_bounds;
+uniform vec2 map_size;
+
 const vec2 inv_atan = vec2(0.1591, 0.3183);
 
 vec2 SampleSphericalMap(vec3 v);
@@ -11,6 +17,17 @@ vec2 SampleSphericalMap(vec3 v);
 void main()
 {
 	vec2 uv = SampleSphericalMap(normalize(FragPos));
+
+	if (tile.z > 0.0)
+	{
+		vec2 texel = uv * map_size;
+		if (any(lessThan(texel, tile_bounds.xy)) || any(greaterThanEqual(texel, tile_bounds.zw)))
+		{
+			discard;
+		}
+
+		uv = (texel - tile.xy) / tile.zw;
+	}
 	vec3 color = texture(rectangular_map, uv).rgb;
 	
 	FragColor = vec4(color, 1.0);
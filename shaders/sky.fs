@@ -0,0 +1,45 @@
+#version 330 core
+out vec4 FragColor;
+in vec3 FragPos;
+
+// Preetham daylight, coefficients from Sky::UpdateModel
+uniform vec3 sun_direction;
+uniform vec3 perez[5]; // A-E for Y, x, y
+uniform vec3 zenith;   // divided by the zenith's Perez term
+uniform float intensity;
+uniform bool tonemap;
+
+vec3 Perez(float cosTheta, float gamma)
+{
+	float cosGamma = cos(gamma);
+	return (1.0 + perez[0] * exp(perez[1] / cosTheta)) *
+		(1.0 + perez[2] * exp(perez[3] * gamma) + perez[4] * cosGamma * cosGamma);
+}
+
+void main()
+{
+	vec3 dir = normalize(FragPos);
+
+	float cosTheta = max(dir.y, 0.001);
+	float gamma = acos(clamp(dot(dir, sun_direction), -1.0, 1.0));
+
+	// Yxy to XYZ to linear sRGB
+	vec3 Yxy = zenith * Perez(cosTheta, gamma);
+	vec3 XYZ = vec3(Yxy.y * Yxy.x / Yxy.z, Yxy.x, (1.0 - Yxy.y - Yxy.z) * Yxy.x / Yxy.z);
+	vec3 color = mat3(
+		 3.2406, -0.9689,  0.0557,
+		-1.5372,  1.8758, -0.2040,
+		-0.4986,  0.0415,  1.0570) * XYZ;
+
+	float ground = dir.y < 0.0 ? 0.3 : 1.0;
+	color = max(color, vec3(0.0)) * intensity * ground;
+
+	if (tonemap)
+	{
+		// HDR tonemap and gamma correct
+		color = color / (color + vec3(1.0));
+		color = pow(color, vec3(1.0/2.2));
+	}
+
+	FragColor = vec4(color, 1.0);
+}